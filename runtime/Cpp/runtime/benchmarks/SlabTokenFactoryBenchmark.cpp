@@ -0,0 +1,114 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+// Compares the token storage options of the lexer on a generated input of the expression grammar used
+// by the tests: heap allocated CommonTokens, tokens from a SlabTokenFactory and a TokenBuffer. Built with
+// -DANTLR_BUILD_CPP_BENCHMARKS=ON, best in a Release build.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+#include "ANTLRInputStream.h"
+#include "CommonTokenStream.h"
+#include "ExprGrammar.h"
+#include "SlabTokenFactory.h"
+#include "TokenBuffer.h"
+
+using namespace antlr4;
+using test::ExprGrammar;
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  ++allocations;
+  void *p = std::malloc(size != 0 ? size : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, size_t /*size*/) noexcept {
+  std::free(p);
+}
+
+static std::string createText(size_t functions) {
+  std::mt19937 random(1);
+  std::string text;
+  for (size_t f = 0; f < functions; ++f) {
+    text += "def f" + std::to_string(f) + "(a, b) {\n";
+    for (size_t s = 1 + random() % 5; s > 0; --s) {
+      switch (random() % 3) {
+        case 0: text += "  x = a + b * (c - 1) / 2;\n"; break;
+        case 1: text += "  return a*b+c;\n"; break;
+        default: text += "  y + 42 - z;\n"; break;
+      }
+    }
+    text += "}\n";
+  }
+  return text;
+}
+
+/// Run {@code tokenize} three times and print the best time, with the token count and allocations.
+template<typename Function>
+static void run(const char *name, Function tokenize) {
+  double best = 1e9;
+  size_t tokens = 0;
+  size_t allocated = 0;
+  for (int i = 0; i < 3; ++i) {
+    allocations = 0;
+    auto start = std::chrono::steady_clock::now();
+    tokens = tokenize();
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    allocated = allocations;
+    best = std::min(best, time.count());
+  }
+  std::printf("%-28s %9zu tokens %8.3f s %10zu allocations\n", name, tokens, best, allocated);
+}
+
+int main() {
+  std::string text = createText(300000);
+  std::printf("input: %zu bytes\n", text.size());
+  std::unique_ptr<atn::ATN> atn = ExprGrammar::deserializeLexerATN();
+  ANTLRInputStream input(text);
+
+  run("CommonTokenStream", [&] {
+    input.reset();
+    auto lexer = ExprGrammar::createLexer(*atn, &input);
+    CommonTokenStream tokens(lexer.get());
+    tokens.fill();
+    return tokens.size();
+  });
+
+  run("CommonTokenStream + slabs", [&] {
+    input.reset();
+    SlabTokenFactory factory;
+    auto lexer = ExprGrammar::createLexer(*atn, &input);
+    lexer->setTokenFactory(&factory);
+    CommonTokenStream tokens(lexer.get());
+    tokens.fill();
+    return tokens.size();
+  });
+
+  run("Lexer::tokenizeAll", [&] {
+    input.reset();
+    auto lexer = ExprGrammar::createLexer(*atn, &input);
+    TokenBuffer buffer;
+    buffer.setTokenSource(lexer.get());
+    lexer->tokenizeAll(buffer);
+    return buffer.size();
+  });
+
+  return 0;
+}
@@ -128,11 +128,8 @@ void ANTLRInputStream::seek(size_t index) {
     p = index; // just jump; don't update stream state (line, ...)
     return;
   }
-  // seek forward, consume until p hits index or n (whichever comes first)
-  index = std::min(index, _data.size());
-  while (p < index) {
-    consume();
-  }
+  // seek forward until p hits index or n (whichever comes first)
+  p = std::min(index, _data.size());
 }
 
 std::string ANTLRInputStream::getText(const Interval &interval) {
@@ -175,6 +172,10 @@ std::string ANTLRInputStream::toString() const {
   return std::move(maybeUtf8).value();
 }
 
+std::u32string_view ANTLRInputStream::getCodePoints() const {
+  return _data;
+}
+
 void ANTLRInputStream::InitializeInstanceFields() {
   p = 0;
 }
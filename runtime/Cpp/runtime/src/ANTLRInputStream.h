@@ -72,6 +72,9 @@ namespace antlr4 {
     virtual std::string getSourceName() const override;
     virtual std::string toString() const override;
 
+    /// The decoded input, for lexers which read it directly. Valid until the stream is loaded again.
+    std::u32string_view getCodePoints() const;
+
   private:
     void InitializeInstanceFields();
   };
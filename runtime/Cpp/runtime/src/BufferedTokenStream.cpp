@@ -94,6 +94,10 @@ size_t BufferedTokenStream::fetch(size_t n) {
   size_t i = 0;
   while (i < n) {
     std::unique_ptr<Token> t(_tokenSource->nextToken());
+    if (t == nullptr) {
+      // The token source is waiting for more input, see Lexer::nextToken().
+      throw InputStarvedException("token source needs more input");
+    }
 
     if (is<WritableToken *>(t.get())) {
       (static_cast<WritableToken *>(t.get()))->setTokenIndex(_tokens.size());
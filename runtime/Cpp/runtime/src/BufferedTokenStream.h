@@ -149,6 +149,8 @@ namespace antlr4 {
     /// Add {@code n} elements to buffer.
     /// </summary>
     /// <returns> The actual number of elements added to the buffer. </returns>
+    /// <exception cref="InputStarvedException"> if the token source returns no token because it
+    ///    needs more input. Tokens fetched so far stay in the buffer. </exception>
     virtual size_t fetch(size_t n);
 
     virtual Token* LB(size_t k);
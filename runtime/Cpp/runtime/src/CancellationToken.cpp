@@ -0,0 +1,47 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "Exceptions.h"
+
+#include "CancellationToken.h"
+
+using namespace antlr4;
+
+CancellationToken::CancellationToken() : _cancelled(false), _deadline(Clock::time_point::max().time_since_epoch().count()) {
+}
+
+CancellationToken::CancellationToken(Clock::duration timeout) : CancellationToken() {
+  setDeadline(Clock::now() + timeout);
+}
+
+void CancellationToken::cancel() {
+  _cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool CancellationToken::isCancelled() const {
+  return _cancelled.load(std::memory_order_relaxed);
+}
+
+void CancellationToken::setDeadline(Clock::time_point deadline) {
+  _deadline.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+CancellationToken::Clock::time_point CancellationToken::getDeadline() const {
+  return Clock::time_point(Clock::duration(_deadline.load(std::memory_order_relaxed)));
+}
+
+bool CancellationToken::isDeadlineExceeded() const {
+  Clock::time_point deadline = getDeadline();
+  return deadline != Clock::time_point::max() && Clock::now() >= deadline;
+}
+
+void CancellationToken::throwIfCancelled() const {
+  if (isCancelled()) {
+    throw OperationCancelledException("operation cancelled");
+  }
+  if (isDeadlineExceeded()) {
+    throw DeadlineExceededException("deadline exceeded");
+  }
+}
@@ -0,0 +1,59 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+
+  /// Lets a lexer or parser be stopped from outside, either explicitly or when a deadline passed.
+  ///
+  /// A token is attached to a recognizer with <seealso cref="Recognizer#setCancellationToken"/>. The
+  /// recognizer checks it once per token in the lexer loop and every
+  /// <seealso cref="atn::LexerATNSimulator#CANCELLATION_CHECK_INTERVAL"/> characters within a token,
+  /// at every prediction and during the ATN closure computations of a prediction, and throws <seealso cref="OperationCancelledException"/>
+  /// (or <seealso cref="DeadlineExceededException"/>) when it fires. The shared DFA and prediction
+  /// context caches stay consistent, but the lexer or parser itself must be reset before it is used
+  /// again.
+  ///
+  /// One token can be shared by several recognizers, and cancel() can be called from any thread.
+  class ANTLR4CPP_PUBLIC CancellationToken {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// A token without deadline.
+    CancellationToken();
+
+    /// A token whose deadline is {@code timeout} from now.
+    explicit CancellationToken(Clock::duration timeout);
+
+    CancellationToken(const CancellationToken &other) = delete;
+    CancellationToken& operator = (const CancellationToken &other) = delete;
+
+    void cancel();
+
+    bool isCancelled() const;
+
+    void setDeadline(Clock::time_point deadline);
+
+    /// Clock::time_point::max() if there is no deadline.
+    Clock::time_point getDeadline() const;
+
+    bool isDeadlineExceeded() const;
+
+    /// Throws an OperationCancelledException if cancel() was called, or a DeadlineExceededException
+    /// if the deadline has passed.
+    void throwIfCancelled() const;
+
+  private:
+    std::atomic<bool> _cancelled;
+    std::atomic<Clock::rep> _deadline;
+  };
+
+} // namespace antlr4
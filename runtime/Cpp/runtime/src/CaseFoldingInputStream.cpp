@@ -0,0 +1,94 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "Exceptions.h"
+#include "misc/Interval.h"
+
+#include "support/Unicode.h"
+#include "support/Utf8.h"
+
+#include "CaseFoldingInputStream.h"
+
+using namespace antlr4;
+using namespace antlrcpp;
+
+using misc::Interval;
+
+CaseFoldingInputStream::CaseFoldingInputStream(Case targetCase) : _targetCase(targetCase) {
+}
+
+CaseFoldingInputStream::CaseFoldingInputStream(std::string_view input, Case targetCase)
+  : CaseFoldingInputStream(targetCase) {
+  load(input.data(), input.length(), false);
+}
+
+CaseFoldingInputStream::CaseFoldingInputStream(std::u32string_view input, Case targetCase)
+  : CaseFoldingInputStream(targetCase) {
+  load(input);
+}
+
+CaseFoldingInputStream::CaseFoldingInputStream(std::istream &stream, Case targetCase)
+  : CaseFoldingInputStream(targetCase) {
+  load(stream, false);
+}
+
+void CaseFoldingInputStream::load(const char *data, size_t length, bool lenient) {
+  ANTLRInputStream::load(data, length, lenient);
+  _original = _data;
+  fold();
+}
+
+void CaseFoldingInputStream::load(std::u32string_view input) {
+  _original = input;
+  _data = _original;
+  p = 0;
+  fold();
+}
+
+CaseFoldingInputStream::Case CaseFoldingInputStream::getTargetCase() const {
+  return _targetCase;
+}
+
+std::string CaseFoldingInputStream::getText(const Interval &interval) {
+  if (interval.a < 0 || interval.b < 0) {
+    return "";
+  }
+
+  size_t start = static_cast<size_t>(interval.a);
+  size_t stop = static_cast<size_t>(interval.b);
+  if (start >= _original.size()) {
+    return "";
+  }
+  if (stop >= _original.size()) {
+    stop = _original.size() - 1;
+  }
+
+  auto maybeUtf8 = Utf8::strictEncode(std::u32string_view(_original).substr(start, stop - start + 1));
+  if (!maybeUtf8.has_value()) {
+    throw IllegalArgumentException("Input stream contains invalid Unicode code points");
+  }
+  return std::move(maybeUtf8).value();
+}
+
+std::string CaseFoldingInputStream::toString() const {
+  auto maybeUtf8 = Utf8::strictEncode(_original);
+  if (!maybeUtf8.has_value()) {
+    throw IllegalArgumentException("Input stream contains invalid Unicode code points");
+  }
+  return std::move(maybeUtf8).value();
+}
+
+void CaseFoldingInputStream::fold() {
+  // Most input is ASCII, which is mapped without any table lookup.
+  if (_targetCase == Case::FOLD) {
+    for (char32_t &c : _data) {
+      c = c < 0x80 ? (c >= U'A' && c <= U'Z' ? c + 0x20 : c) : Unicode::foldCase(c);
+    }
+  } else {
+    for (char32_t &c : _data) {
+      c = c < 0x80 ? (c >= U'a' && c <= U'z' ? c - 0x20 : c) : Unicode::toUpper(c);
+    }
+  }
+}
@@ -0,0 +1,62 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <string_view>
+
+#include "ANTLRInputStream.h"
+
+namespace antlr4 {
+
+  /// An input stream for case-insensitive lexing: the lexer sees every character case folded (or
+  /// uppercased), while the token text and all other text taken from the stream keep the original case.
+  /// This allows writing the lexer rules of a case-insensitive language in a single case, without
+  /// the {@code caseInsensitive} option turning every letter into a set like {@code [aA]}.
+  ///
+  /// The input is folded once when it is loaded, using the simple case folding of the Unicode
+  /// character database (see <seealso cref="antlrcpp::Unicode#foldCase"/>), so reading a character
+  /// costs exactly the same as with an <seealso cref="ANTLRInputStream"/> and the lexer uses its
+  /// specialized loop for this stream too. The price is a second copy of the input.
+  class ANTLR4CPP_PUBLIC CaseFoldingInputStream : public ANTLRInputStream {
+  public:
+    enum class Case {
+      /// Case fold all characters, which mostly means converting them to lowercase. The lexer rules
+      /// must be written in lowercase.
+      FOLD,
+
+      /// Convert all characters to uppercase. The lexer rules must be written in uppercase.
+      UPPER,
+    };
+
+    explicit CaseFoldingInputStream(Case targetCase = Case::FOLD);
+    CaseFoldingInputStream(std::string_view input, Case targetCase = Case::FOLD);
+    CaseFoldingInputStream(std::u32string_view input, Case targetCase = Case::FOLD);
+    CaseFoldingInputStream(std::istream &stream, Case targetCase = Case::FOLD);
+
+    using ANTLRInputStream::load;
+    virtual void load(const char *data, size_t length, bool lenient) override;
+
+    /// Load already decoded code points.
+    virtual void load(std::u32string_view input);
+
+    Case getTargetCase() const;
+
+    /// Returns the text of the interval in its original case.
+    virtual std::string getText(const misc::Interval &interval) override;
+
+    /// Returns the complete input in its original case.
+    virtual std::string toString() const override;
+
+  private:
+    const Case _targetCase;
+
+    /// The input as loaded, while _data holds the folded text the lexer reads.
+    std::u32string _original;
+
+    void fold();
+  };
+
+} // namespace antlr4
@@ -0,0 +1,100 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <algorithm>
+
+#include "Exceptions.h"
+#include "misc/Interval.h"
+
+#include "support/Utf8.h"
+
+#include "CodePointStream.h"
+
+using namespace antlr4;
+using namespace antlrcpp;
+
+using misc::Interval;
+
+CodePointStream::CodePointStream(std::u32string_view data, size_t index, CharStream *textSource)
+  : _data(data), p(std::min(index, data.size())), _textSource(textSource) {
+}
+
+void CodePointStream::consume() {
+  if (p >= _data.size()) {
+    throw IllegalStateException("cannot consume EOF");
+  }
+  p++;
+}
+
+size_t CodePointStream::LA(ssize_t i) {
+  if (i == 0) {
+    return 0; // undefined
+  }
+
+  ssize_t position = static_cast<ssize_t>(p) + (i < 0 ? i : i - 1);
+  if (position < 0 || position >= static_cast<ssize_t>(_data.size())) {
+    return IntStream::EOF;
+  }
+  return _data[static_cast<size_t>(position)];
+}
+
+ssize_t CodePointStream::mark() {
+  return -1;
+}
+
+void CodePointStream::release(ssize_t /* marker */) {
+}
+
+size_t CodePointStream::index() {
+  return p;
+}
+
+void CodePointStream::seek(size_t index) {
+  p = std::min(index, _data.size());
+}
+
+size_t CodePointStream::size() {
+  return _data.size();
+}
+
+std::string CodePointStream::getText(const Interval &interval) {
+  if (interval.a < 0 || interval.b < interval.a) {
+    return "";
+  }
+
+  size_t start = static_cast<size_t>(interval.a);
+  if (start >= _data.size()) {
+    return "";
+  }
+  size_t stop = std::min(static_cast<size_t>(interval.b), _data.size() - 1);
+  if (_textSource != nullptr) {
+    return _textSource->getText(Interval(start, stop));
+  }
+
+  auto maybeUtf8 = Utf8::strictEncode(_data.substr(start, stop - start + 1));
+  if (!maybeUtf8.has_value()) {
+    throw IllegalArgumentException("Input stream contains invalid Unicode code points");
+  }
+  return std::move(maybeUtf8).value();
+}
+
+std::string CodePointStream::getSourceName() const {
+  if (name.empty()) {
+    return IntStream::UNKNOWN_SOURCE_NAME;
+  }
+  return name;
+}
+
+std::string CodePointStream::toString() const {
+  auto maybeUtf8 = Utf8::strictEncode(_data);
+  if (!maybeUtf8.has_value()) {
+    throw IllegalArgumentException("Input stream contains invalid Unicode code points");
+  }
+  return std::move(maybeUtf8).value();
+}
+
+std::u32string_view CodePointStream::getCodePoints() const {
+  return _data;
+}
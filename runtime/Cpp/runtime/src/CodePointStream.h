@@ -0,0 +1,55 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <string_view>
+
+#include "CharStream.h"
+
+namespace antlr4 {
+
+  /// A char stream over UTF-32 text it does not own, e.g. the text of an <seealso cref="ANTLRInputStream"/>.
+  /// The text must outlive the stream. Any number of these streams can read the same text at the same
+  /// time, each from its own position, which is what <seealso cref="ParallelTokenizer"/> uses it for.
+  /// The lexer reads it directly, like an ANTLRInputStream.
+  class ANTLR4CPP_PUBLIC CodePointStream : public CharStream {
+  public:
+    /// The name or source of this char stream.
+    std::string name;
+
+    /// If {@code textSource} is given, getText() returns its text for the same interval instead of the
+    /// text of {@code data}, e.g. the original text of a CaseFoldingInputStream whose folded data this
+    /// stream reads. It must be safe to call getText() on it from other threads.
+    explicit CodePointStream(std::u32string_view data, size_t index = 0, CharStream *textSource = nullptr);
+
+    void consume() override;
+    size_t LA(ssize_t i) override;
+
+    /// mark/release do nothing, all text is available.
+    ssize_t mark() override;
+    void release(ssize_t marker) override;
+    size_t index() override;
+    void seek(size_t index) override;
+    size_t size() override;
+
+    std::string getText(const misc::Interval &interval) override;
+    std::string getSourceName() const override;
+    std::string toString() const override;
+
+    /// The text this stream reads.
+    std::u32string_view getCodePoints() const;
+
+  protected:
+    std::u32string_view _data;
+
+    /// Index of the next character.
+    size_t p;
+
+  private:
+    CharStream *_textSource;
+  };
+
+} // namespace antlr4
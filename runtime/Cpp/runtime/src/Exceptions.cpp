@@ -53,6 +53,11 @@ UnsupportedOperationException::~UnsupportedOperationException() {
 EmptyStackException::~EmptyStackException() {
 }
 
+//------------------ InputStarvedException -----------------------------------------------------------------------------
+
+InputStarvedException::~InputStarvedException() {
+}
+
 //------------------ CancellationException -----------------------------------------------------------------------------
 
 CancellationException::~CancellationException() {
@@ -62,3 +67,13 @@ CancellationException::~CancellationException() {
 
 ParseCancellationException::~ParseCancellationException() {
 }
+
+//------------------ OperationCancelledException -----------------------------------------------------------------------
+
+OperationCancelledException::~OperationCancelledException() {
+}
+
+//------------------ DeadlineExceededException -------------------------------------------------------------------------
+
+DeadlineExceededException::~DeadlineExceededException() {
+}
@@ -68,6 +68,16 @@ namespace antlr4 {
     EmptyStackException& operator=(EmptyStackException const&) = default;
   };
 
+  /// Thrown by a token stream when its token source cannot deliver the next token yet, because
+  /// the underlying input is pushed incrementally and is not complete (see PushCharStream).
+  class ANTLR4CPP_PUBLIC InputStarvedException : public RuntimeException {
+  public:
+    InputStarvedException(const std::string &msg = "") : RuntimeException(msg) {}
+    InputStarvedException(InputStarvedException const&) = default;
+    ~InputStarvedException();
+    InputStarvedException& operator=(InputStarvedException const&) = default;
+  };
+
   // IOException is not a runtime exception (in the java hierarchy).
   // Hence we have to duplicate the RuntimeException implementation.
   class ANTLR4CPP_PUBLIC IOException : public std::exception {
@@ -96,4 +106,22 @@ namespace antlr4 {
     ParseCancellationException& operator=(ParseCancellationException const&) = default;
   };
 
+  /// Thrown by a lexer or parser when its CancellationToken was cancelled.
+  class ANTLR4CPP_PUBLIC OperationCancelledException : public CancellationException {
+  public:
+    OperationCancelledException(const std::string &msg = "") : CancellationException(msg) {}
+    OperationCancelledException(OperationCancelledException const&) = default;
+    ~OperationCancelledException();
+    OperationCancelledException& operator=(OperationCancelledException const&) = default;
+  };
+
+  /// Thrown by a lexer or parser when the deadline of its CancellationToken has passed.
+  class ANTLR4CPP_PUBLIC DeadlineExceededException : public OperationCancelledException {
+  public:
+    DeadlineExceededException(const std::string &msg = "") : OperationCancelledException(msg) {}
+    DeadlineExceededException(DeadlineExceededException const&) = default;
+    ~DeadlineExceededException();
+    DeadlineExceededException& operator=(DeadlineExceededException const&) = default;
+  };
+
 } // namespace antlr4
@@ -0,0 +1,194 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <algorithm>
+
+#include "CodePointStream.h"
+#include "Exceptions.h"
+#include "Lexer.h"
+#include "support/Utf8.h"
+
+#include "IncrementalLexer.h"
+
+using namespace antlr4;
+using namespace antlrcpp;
+
+namespace {
+
+  std::u32string decode(std::string_view text) {
+    auto maybeUtf32 = Utf8::strictDecode(text);
+    if (!maybeUtf32.has_value()) {
+      throw IllegalArgumentException("UTF-8 string contains an illegal byte sequence");
+    }
+    return std::move(maybeUtf32).value();
+  }
+
+}
+
+/// Records the furthest character the lexer looked at. Since it is not a CodePointStream, the lexer
+/// reads it through LA() instead of directly.
+class IncrementalLexer::TrackingStream final : public CodePointStream {
+public:
+  size_t lookahead = 0;
+
+  using CodePointStream::CodePointStream;
+
+  size_t LA(ssize_t i) override {
+    if (i > 0) {
+      lookahead = std::max(lookahead, std::min(p + static_cast<size_t>(i) - 1, _data.size()));
+    }
+    return CodePointStream::LA(i);
+  }
+};
+
+IncrementalLexer::IncrementalLexer(Lexer &lexer, std::string_view text) : IncrementalLexer(lexer, decode(text)) {
+}
+
+IncrementalLexer::IncrementalLexer(Lexer &lexer, std::u32string_view text) : _lexer(lexer), _text(text) {
+  _modeStacks.push_back({ Lexer::DEFAULT_MODE });
+  _modeStackIndexes[_modeStacks.back()] = 0;
+
+  attachInput();
+  lex(_tokens, _records, std::numeric_limits<size_t>::max(), 0, 0);
+}
+
+IncrementalLexer::~IncrementalLexer() {
+  _lexer._input = nullptr;
+}
+
+IncrementalLexer::Change IncrementalLexer::edit(size_t offset, size_t removedLength, std::string_view insertedText) {
+  return edit(offset, removedLength, decode(insertedText));
+}
+
+IncrementalLexer::Change IncrementalLexer::edit(size_t offset, size_t removedLength, std::u32string_view insertedText) {
+  if (offset > _text.size() || removedLength > _text.size() - offset) {
+    throw IndexOutOfBoundsException("the edit is outside of the text");
+  }
+
+  // The first token whose lexer looked at a removed character, or at the one the text is inserted before.
+  // The EOF token always qualifies.
+  size_t first = static_cast<size_t>(std::lower_bound(_records.lookaheads.begin(), _records.lookaheads.end(),
+    offset) - _records.lookaheads.begin());
+  ssize_t delta = static_cast<ssize_t>(insertedText.size()) - static_cast<ssize_t>(removedLength);
+
+  _text.replace(offset, removedLength, insertedText);
+  attachInput();
+
+  // Continue where the lexer started to look for that token.
+  _input->seek(_records.starts[first]);
+  _lexer.setLine(_records.lines[first]);
+  _lexer.setCharPositionInLine(_records.columns[first]);
+  const std::vector<size_t> &modeStack = _modeStacks[_records.modeStacks[first]];
+  _lexer.modeStack.assign(modeStack.begin(), modeStack.end() - 1);
+  _lexer.mode = modeStack.back();
+
+  TokenBuffer tokens;
+  tokens.setTokenSource(&_lexer);
+  Records records;
+  size_t next = lex(tokens, records, offset + insertedText.size(), delta, first > 0 ? _records.lookaheads[first - 1] : 0);
+
+  // The tokens from next on are the same, only moved.
+  if (next < _tokens.size()) {
+    size_t line = _records.lines[next];
+    ssize_t lineDelta = static_cast<ssize_t>(_lexer.getLine()) - static_cast<ssize_t>(line);
+    ssize_t columnDelta = static_cast<ssize_t>(_lexer.getCharPositionInLine()) - static_cast<ssize_t>(_records.columns[next]);
+    size_t lookahead = records.lookaheads.empty() ? 0 : records.lookaheads.back();
+
+    // The columns are shifted directly, this runs over all following tokens on every edit.
+    auto shift = [&](std::vector<uint32_t> &column, ssize_t amount) {
+      for (size_t i = next; i < column.size(); ++i) {
+        column[i] = static_cast<uint32_t>(column[i] + amount);
+      }
+    };
+    auto shiftLines = [&](std::vector<uint32_t> &lines, std::vector<uint32_t> &columns) {
+      for (size_t i = next; i < lines.size() && lines[i] == line; ++i) {
+        columns[i] = static_cast<uint32_t>(columns[i] + columnDelta);
+      }
+      shift(lines, lineDelta);
+    };
+
+    _tokens.shift(next, delta, line, lineDelta, columnDelta);
+    shift(_records.starts, delta);
+    shiftLines(_records.lines, _records.columns);
+    for (size_t i = next; i < _records.lookaheads.size(); ++i) {
+      _records.lookaheads[i] = static_cast<uint32_t>(std::max(lookahead, static_cast<size_t>(_records.lookaheads[i] + delta)));
+    }
+  }
+
+  _tokens.replace(first, next, tokens);
+  auto replace = [&](std::vector<uint32_t> &column, const std::vector<uint32_t> &source) {
+    if (next - first > source.size()) {
+      column.erase(column.begin() + first + source.size(), column.begin() + next);
+    } else {
+      column.insert(column.begin() + next, source.size() - (next - first), 0);
+    }
+    std::copy(source.begin(), source.end(), column.begin() + first);
+  };
+  replace(_records.starts, records.starts);
+  replace(_records.lines, records.lines);
+  replace(_records.columns, records.columns);
+  replace(_records.modeStacks, records.modeStacks);
+  replace(_records.lookaheads, records.lookaheads);
+
+  return { first, next - first, tokens.size() };
+}
+
+const TokenBuffer& IncrementalLexer::getTokens() const {
+  return _tokens;
+}
+
+const std::u32string& IncrementalLexer::getText() const {
+  return _text;
+}
+
+uint32_t IncrementalLexer::getModeStackIndex() {
+  if (_lexer.mode == Lexer::DEFAULT_MODE && _lexer.modeStack.empty()) {
+    return 0;
+  }
+
+  std::vector<size_t> modeStack = _lexer.modeStack;
+  modeStack.push_back(_lexer.mode);
+  auto [iterator, inserted] = _modeStackIndexes.try_emplace(modeStack, static_cast<uint32_t>(_modeStacks.size()));
+  if (inserted) {
+    _modeStacks.push_back(std::move(modeStack));
+  }
+  return iterator->second;
+}
+
+size_t IncrementalLexer::lex(TokenBuffer &tokens, Records &records, size_t syncStart, ssize_t delta,
+                             size_t lookahead) {
+  while (tokens.size() == 0 || tokens.getType(tokens.size() - 1) != Token::EOF) {
+    size_t start = _input->index();
+    uint32_t modeStack = getModeStackIndex();
+
+    if (start >= syncStart) {
+      auto iterator = std::lower_bound(_records.starts.begin(), _records.starts.end(), start - delta);
+      if (iterator != _records.starts.end() && *iterator == start - delta) {
+        size_t index = static_cast<size_t>(iterator - _records.starts.begin());
+        if (_records.modeStacks[index] == modeStack) {
+          return index;
+        }
+      }
+    }
+
+    records.starts.push_back(static_cast<uint32_t>(start));
+    records.lines.push_back(static_cast<uint32_t>(_lexer.getLine()));
+    records.columns.push_back(static_cast<uint32_t>(_lexer.getCharPositionInLine()));
+    records.modeStacks.push_back(modeStack);
+
+    _input->lookahead = start;
+    _lexer.appendNextToken(tokens);
+    lookahead = std::max(lookahead, _input->lookahead);
+    records.lookaheads.push_back(static_cast<uint32_t>(lookahead));
+  }
+  return _records.starts.size();
+}
+
+void IncrementalLexer::attachInput() {
+  _input = std::make_unique<TrackingStream>(_text);
+  _lexer._input = _input.get();
+  _lexer.reset();
+  _tokens.setTokenSource(&_lexer);
+}
@@ -0,0 +1,101 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <map>
+#include <string_view>
+
+#include "TokenBuffer.h"
+
+namespace antlr4 {
+
+  /// Keeps the tokens of a text up to date while the text is edited, e.g. in an editor, by lexing
+  /// only the part of the text which an edit can have changed.
+  ///
+  /// For every token the lexer's mode stack at the point where the lexer started to look for the token
+  /// and the furthest character the lexer looked at to find it are recorded. After an edit lexing starts
+  /// again at the first token whose lexer looked at an edited character, in the mode stack recorded for
+  /// it. It stops as soon as the lexer starts a token behind the edit in the same mode stack at the same
+  /// (shifted) position as before the edit, since all following tokens are the same. Their character
+  /// indexes, lines and columns are shifted. The tokens are always the same as if the whole new text was
+  /// lexed, provided that lexer actions depend on no state except the mode stack.
+  ///
+  /// Offsets and lengths count code points, like the character indexes of tokens.
+  ///
+  /// <code>
+  ///   MyLexer lexer(nullptr);
+  ///   IncrementalLexer incremental(lexer, text);
+  ///   // On every change in the editor:
+  ///   IncrementalLexer::Change change = incremental.edit(offset, removedLength, insertedText);
+  ///   const TokenBuffer &tokens = incremental.getTokens();
+  /// </code>
+  class ANTLR4CPP_PUBLIC IncrementalLexer {
+  public:
+    /// The tokens replaced by an edit: the tokens {@code begin} up to {@code begin + removedTokens} of
+    /// the old tokens were replaced by the tokens {@code begin} up to {@code begin + insertedTokens}.
+    /// The tokens following them only moved.
+    struct Change {
+      size_t begin;
+      size_t removedTokens;
+      size_t insertedTokens;
+    };
+
+    /// Lex {@code text}, which is UTF-8 encoded, with {@code lexer}. The lexer reads from an input stream
+    /// owned by this object from now on, and must not be used for anything else.
+    IncrementalLexer(Lexer &lexer, std::string_view text);
+    IncrementalLexer(Lexer &lexer, std::u32string_view text);
+    IncrementalLexer(const IncrementalLexer &other) = delete;
+    virtual ~IncrementalLexer();
+
+    IncrementalLexer& operator = (const IncrementalLexer &other) = delete;
+
+    /// Replace {@code removedLength} characters at {@code offset} by {@code insertedText}, which is UTF-8
+    /// encoded, and update the tokens.
+    Change edit(size_t offset, size_t removedLength, std::string_view insertedText);
+    Change edit(size_t offset, size_t removedLength, std::u32string_view insertedText);
+
+    /// The tokens of the current text, including EOF. Their token source is the lexer.
+    const TokenBuffer& getTokens() const;
+
+    const std::u32string& getText() const;
+
+  private:
+    class TrackingStream;
+
+    Lexer &_lexer;
+    std::u32string _text;
+    std::unique_ptr<TrackingStream> _input;
+    TokenBuffer _tokens;
+
+    /// For every token: where the lexer started to look for it, the line and column there, the mode
+    /// stack there (see _modeStacks) and the furthest character the lexer looked at for this token or
+    /// any token before it.
+    struct Records {
+      std::vector<uint32_t> starts;
+      std::vector<uint32_t> lines;
+      std::vector<uint32_t> columns;
+      std::vector<uint32_t> modeStacks;
+      std::vector<uint32_t> lookaheads;
+    };
+    Records _records;
+
+    /// Every mode stack seen so far, with the current mode last, and its index in _modeStackIndexes.
+    std::vector<std::vector<size_t>> _modeStacks;
+    std::map<std::vector<size_t>, uint32_t> _modeStackIndexes;
+
+    uint32_t getModeStackIndex();
+
+    /// Lex tokens from the lexer's current position into {@code tokens} and {@code records}, until EOF or
+    /// until the lexer starts a token at or behind {@code syncStart} where it did before the edit
+    /// (with positions shifted by {@code delta}). {@code lookahead} is the furthest character looked at
+    /// for the tokens before. Returns the index of that old token, or the number of old tokens if there is none.
+    size_t lex(TokenBuffer &tokens, Records &records, size_t syncStart, ssize_t delta, size_t lookahead);
+
+    /// Let the lexer read the current text, from its start.
+    void attachInput();
+  };
+
+} // namespace antlr4
@@ -0,0 +1,332 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <algorithm>
+
+#include "ANTLRErrorStrategy.h"
+#include "BaseErrorListener.h"
+#include "Parser.h"
+#include "ParserRuleContext.h"
+#include "support/CPPUtils.h"
+#include "tree/ParseTreeListener.h"
+#include "tree/TerminalNodeImpl.h"
+
+#include "IncrementalParse.h"
+
+using namespace antlr4;
+using namespace antlrcpp;
+
+namespace {
+
+  constexpr size_t TAINTED = std::numeric_limits<size_t>::max();
+
+}
+
+/// Forwards to the token stream of the current parse and records the furthest token looked at.
+class IncrementalParse::TrackingStream final : public TokenStream {
+public:
+  TokenStream *tokens = nullptr;
+  size_t lookahead = 0;
+
+  Token* LT(ssize_t k) override {
+    Token *token = tokens->LT(k);
+    if (k > 0 && token != nullptr) {
+      lookahead = std::max(lookahead, token->getTokenIndex());
+    }
+    return token;
+  }
+
+  size_t LA(ssize_t i) override {
+    if (i > 0) {
+      return LT(i)->getType();
+    }
+    return tokens->LA(i);
+  }
+
+  Token* get(size_t index) const override {
+    return tokens->get(index);
+  }
+
+  TokenSource* getTokenSource() const override {
+    return tokens->getTokenSource();
+  }
+
+  std::string getText(const misc::Interval &interval) override {
+    return tokens->getText(interval);
+  }
+
+  std::string getText() override {
+    return tokens->getText();
+  }
+
+  std::string getText(RuleContext *ctx) override {
+    return tokens->getText(ctx);
+  }
+
+  std::string getText(Token *start, Token *stop) override {
+    return tokens->getText(start, stop);
+  }
+
+  void consume() override {
+    tokens->consume();
+  }
+
+  ssize_t mark() override {
+    return tokens->mark();
+  }
+
+  void release(ssize_t marker) override {
+    tokens->release(marker);
+  }
+
+  size_t index() override {
+    return tokens->index();
+  }
+
+  void seek(size_t index) override {
+    tokens->seek(index);
+  }
+
+  size_t size() override {
+    return tokens->size();
+  }
+
+  std::string getSourceName() const override {
+    return tokens->getSourceName();
+  }
+};
+
+/// Records the lookahead of every rule context when it is exited.
+class IncrementalParse::RuleRecorder final : public tree::ParseTreeListener {
+public:
+  explicit RuleRecorder(IncrementalParse &owner) : _owner(owner) {
+  }
+
+  void enterEveryRule(ParserRuleContext * /*ctx*/) override {
+    if (_owner._parser.getErrorHandler()->inErrorRecoveryMode(&_owner._parser)) {
+      _owner.taint();
+    }
+  }
+
+  void exitEveryRule(ParserRuleContext *ctx) override {
+    size_t start = ctx->start->getTokenIndex();
+    _owner._lookaheads.emplace(ctx, std::max(_owner._tokens->lookahead, start) - start);
+  }
+
+  void visitTerminal(tree::TerminalNode * /*node*/) override {
+  }
+
+  void visitErrorNode(tree::ErrorNode * /*node*/) override {
+  }
+
+private:
+  IncrementalParse &_owner;
+};
+
+/// Marks the rules active at a syntax error or a full context prediction as not reusable.
+class IncrementalParse::ErrorRecorder final : public BaseErrorListener {
+public:
+  explicit ErrorRecorder(IncrementalParse &owner) : _owner(owner) {
+  }
+
+  void syntaxError(Recognizer * /*recognizer*/, Token * /*offendingSymbol*/, size_t /*line*/,
+                   size_t /*charPositionInLine*/, const std::string &/*msg*/, std::exception_ptr /*e*/) override {
+    _owner.taint();
+  }
+
+  void reportAttemptingFullContext(Parser * /*recognizer*/, const dfa::DFA &/*dfa*/, size_t /*startIndex*/,
+    size_t /*stopIndex*/, const antlrcpp::BitSet &/*conflictingAlts*/, atn::ATNConfigSet * /*configs*/) override {
+    _owner.taint();
+  }
+
+private:
+  IncrementalParse &_owner;
+};
+
+IncrementalParse::IncrementalParse(Parser &parser, std::function<ParserRuleContext *()> startRule)
+  : _parser(parser), _startRule(std::move(startRule)), _tokens(std::make_unique<TrackingStream>()),
+    _ruleRecorder(std::make_unique<RuleRecorder>(*this)), _errorRecorder(std::make_unique<ErrorRecorder>(*this)),
+    _result(nullptr), _nextEntry(0), _change{ 0, 0, 0 }, _reusedNodeCount(0) {
+  _parser.setBuildParseTree(true);
+  _parser.addParseListener(_ruleRecorder.get());
+  _parser.addErrorListener(_errorRecorder.get());
+  _parser._incrementalParse = this;
+}
+
+IncrementalParse::~IncrementalParse() {
+  _parser._incrementalParse = nullptr;
+  _parser.removeParseListener(_ruleRecorder.get());
+  _parser.removeErrorListener(_errorRecorder.get());
+  if (_parser._input == _tokens.get()) {
+    // Keep the tree, but stop reading through this object.
+    _parser._input = _tokens->tokens;
+  }
+}
+
+ParserRuleContext* IncrementalParse::parse(TokenStream *tokens) {
+  _entries.clear();
+  _change = { 0, 0, 0 };
+  return run(tokens);
+}
+
+ParserRuleContext* IncrementalParse::reparse(TokenStream *tokens, const IncrementalLexer::Change &change) {
+  _change = change;
+  return run(tokens);
+}
+
+ParserRuleContext* IncrementalParse::getResult() const {
+  return _result;
+}
+
+size_t IncrementalParse::getReusedNodeCount() const {
+  return _reusedNodeCount;
+}
+
+ParserRuleContext* IncrementalParse::run(TokenStream *tokens) {
+  // The previous tree stays alive until the parse is done, the nodes not taken over are deleted then.
+  std::vector<tree::ParseTree *> previous = _parser._tracker.release();
+  _tokens->tokens = tokens;
+  _tokens->lookahead = 0;
+  _parser.setTokenStream(_tokens.get());
+  tokens->seek(0);
+  _result = nullptr;
+  _nextEntry = 0;
+
+  auto onExit = finally([this, &previous] {
+    _reusedNodeCount = _reused.size();
+    for (tree::ParseTree *node : previous) {
+      if (_reused.count(node) != 0) {
+        _parser._tracker.adopt(node);
+      } else {
+        _lookaheads.erase(node);
+        delete node;
+      }
+    }
+    _reused.clear();
+
+    // Index the rule contexts of the new tree by their start token.
+    _entries.clear();
+    std::vector<std::pair<tree::ParseTree *, size_t>> pending;
+    if (_result != nullptr) {
+      pending.push_back({ _result, 0 });
+    }
+    while (!pending.empty()) {
+      auto [node, entry] = pending.back();
+      pending.pop_back();
+      if (node == nullptr) {
+        _entries[entry].end = _entries.size();
+      } else if (RuleContext::is(node)) {
+        ParserRuleContext *ctx = static_cast<ParserRuleContext *>(node);
+        pending.push_back({ nullptr, _entries.size() });
+        _entries.push_back({ ctx->start->getTokenIndex(), 0, ctx });
+        for (auto child = ctx->children.rbegin(); child != ctx->children.rend(); ++child) {
+          pending.push_back({ *child, 0 });
+        }
+      }
+    }
+  });
+
+  _result = _startRule();
+  return _result;
+}
+
+ParserRuleContext* IncrementalParse::reuse(size_t ruleIndex) {
+  if (_nextEntry == _entries.size() || _parser.getErrorHandler()->inErrorRecoveryMode(&_parser)) {
+    return nullptr;
+  }
+
+  // Map the current token to the token of the previous parse.
+  TokenStream *tokens = _tokens->tokens;
+  size_t index = tokens->LT(1)->getTokenIndex();
+  size_t old;
+  if (index < _change.begin) {
+    old = index;
+  } else if (index >= _change.begin + _change.insertedTokens) {
+    old = index - _change.insertedTokens + _change.removedTokens;
+  } else {
+    return nullptr;
+  }
+
+  // Rules are entered at increasing tokens, so the entries in front of the last lookup are not needed anymore.
+  auto entry = std::lower_bound(_entries.begin() + static_cast<ssize_t>(_nextEntry), _entries.end(), old,
+    [](const Entry &e, size_t start) { return e.start < start; });
+  _nextEntry = static_cast<size_t>(entry - _entries.begin());
+
+  for (; entry != _entries.end() && entry->start == old; ++entry) {
+    ParserRuleContext *ctx = entry->ctx;
+    if (ctx->getRuleIndex() != ruleIndex) {
+      continue;
+    }
+    auto lookahead = _lookaheads.find(ctx);
+    if (lookahead == _lookaheads.end() || lookahead->second == TAINTED ||
+        (old < _change.begin && old + lookahead->second >= _change.begin)) {
+      continue;
+    }
+
+    // Continue behind the subtree, where the parser would be after parsing it.
+    _nextEntry = entry->end;
+    ssize_t shift = static_cast<ssize_t>(index) - static_cast<ssize_t>(old);
+    Token *before = tokens->LT(-1);
+    if (ctx->stop != nullptr && ctx->stop->getTokenIndex() >= old) {
+      size_t stop = static_cast<size_t>(static_cast<ssize_t>(ctx->stop->getTokenIndex()) + shift);
+      if (ctx->stop->getType() == Token::EOF) {
+        tokens->seek(stop);
+        _parser._matchedEOF = true;
+      } else {
+        tokens->seek(stop + 1);
+      }
+    }
+    rebind(ctx, shift, before);
+    _tokens->lookahead = std::max(_tokens->lookahead, index + lookahead->second);
+
+    ctx->parent = _parser._ctx;
+    ctx->invokingState = _parser.getState();
+    _parser._ctx->addChild(ctx);
+    return ctx;
+  }
+  return nullptr;
+}
+
+void IncrementalParse::taint() {
+  for (ParserRuleContext *ctx = _parser._ctx; ctx != nullptr; ctx = static_cast<ParserRuleContext *>(ctx->parent)) {
+    size_t &lookahead = _lookaheads[ctx];
+    if (lookahead == TAINTED) {
+      break;
+    }
+    lookahead = TAINTED;
+  }
+}
+
+void IncrementalParse::rebind(ParserRuleContext *tree, ssize_t shift, Token *before) {
+  TokenStream *tokens = _tokens->tokens;
+  size_t first = tree->start->getTokenIndex();
+  auto map = [tokens, shift, before, first](Token *token) -> Token* {
+    if (token == nullptr) {
+      return nullptr;
+    }
+    // Only the stop token of an empty rule context can be in front of the subtree.
+    if (token->getTokenIndex() < first) {
+      return before;
+    }
+    return tokens->get(static_cast<size_t>(static_cast<ssize_t>(token->getTokenIndex()) + shift));
+  };
+
+  std::vector<tree::ParseTree *> pending = { tree };
+  while (!pending.empty()) {
+    tree::ParseTree *node = pending.back();
+    pending.pop_back();
+    _reused.insert(node);
+    if (RuleContext::is(node)) {
+      ParserRuleContext *ctx = static_cast<ParserRuleContext *>(node);
+      ctx->start = map(ctx->start);
+      ctx->stop = map(ctx->stop);
+      ctx->rebindTokens(map);
+      pending.insert(pending.end(), ctx->children.begin(), ctx->children.end());
+    } else {
+      tree::TerminalNodeImpl *terminal = static_cast<tree::TerminalNodeImpl *>(node);
+      terminal->symbol = map(terminal->symbol);
+    }
+  }
+}
@@ -0,0 +1,108 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "FlatHashMap.h"
+#include "FlatHashSet.h"
+#include "IncrementalLexer.h"
+
+namespace antlr4 {
+
+  /// Parses a token stream again after an edit, e.g. in an editor, taking over the subtrees of the
+  /// previous parse tree which the edit cannot have changed.
+  ///
+  /// For every rule context the furthest token the parser looked at until the rule was exited
+  /// (including all predictions) is recorded. When the parser is about to enter a rule at a token
+  /// which was not edited, and the previous tree has a context of that rule starting at the same
+  /// (shifted) token whose lookahead did not reach the edit, that context is taken over with its
+  /// subtree, and the parser continues behind it. Contexts during whose parse a syntax error was
+  /// reported or a full context prediction was made, or which were entered in error recovery mode,
+  /// depend on the rules around them and are never taken over. The result is therefore the same as
+  /// that of a new parse, provided that semantic predicates only depend on the tokens.
+  ///
+  /// Only rules without arguments and which are not left recursive are taken over. No actions are
+  /// executed and no parse listener events are triggered for the subtrees taken over.
+  ///
+  /// <code>
+  ///   MyParser parser(nullptr);
+  ///   IncrementalParse parse(parser, [&parser] { return parser.file(); });
+  ///   parse.parse(&tokens);
+  ///   // On every change in the editor, with the tokens of the previous parse still alive:
+  ///   IncrementalLexer::Change change = ...;
+  ///   parse.reparse(&newTokens, change);
+  /// </code>
+  class ANTLR4CPP_PUBLIC IncrementalParse {
+  public:
+    /// {@code startRule} invokes the start rule of {@code parser}. The parser must not be used for
+    /// anything else while this object exists.
+    IncrementalParse(Parser &parser, std::function<ParserRuleContext *()> startRule);
+    IncrementalParse(const IncrementalParse &other) = delete;
+    virtual ~IncrementalParse();
+
+    IncrementalParse& operator = (const IncrementalParse &other) = delete;
+
+    /// Parse {@code tokens} from scratch.
+    ParserRuleContext* parse(TokenStream *tokens);
+
+    /// Parse {@code tokens}, which are the tokens of the previous parse except for the tokens replaced
+    /// as described by {@code change} (see <seealso cref="IncrementalLexer#edit"/>). The token stream
+    /// of the previous parse must still be alive, since its tokens are replaced by those of
+    /// {@code tokens} in the subtrees taken over. Token labels are switched over through
+    /// <seealso cref="ParserRuleContext#rebindTokens"/>, so contexts of a custom context class which hold
+    /// tokens have to override it.
+    ParserRuleContext* reparse(TokenStream *tokens, const IncrementalLexer::Change &change);
+
+    /// The tree returned by the start rule, owned by the parser. It is deleted by the next parse.
+    ParserRuleContext* getResult() const;
+
+    /// The number of tree nodes the last parse took over from the previous tree.
+    size_t getReusedNodeCount() const;
+
+    /// Called by <seealso cref="Parser#reuseRuleContext"/>.
+    ParserRuleContext* reuse(size_t ruleIndex);
+
+  private:
+    class TrackingStream;
+    class RuleRecorder;
+    class ErrorRecorder;
+
+    /// A rule context of the previous tree, in preorder. {@code end} is the index of the first entry
+    /// behind its subtree.
+    struct Entry {
+      size_t start;
+      size_t end;
+      ParserRuleContext *ctx;
+    };
+
+    Parser &_parser;
+    std::function<ParserRuleContext *()> _startRule;
+    std::unique_ptr<TrackingStream> _tokens;
+    std::unique_ptr<RuleRecorder> _ruleRecorder;
+    std::unique_ptr<ErrorRecorder> _errorRecorder;
+    ParserRuleContext *_result;
+
+    /// For every rule context, the furthest token looked at relative to its start token, or TAINTED.
+    FlatHashMap<const tree::ParseTree *, size_t> _lookaheads;
+
+    std::vector<Entry> _entries;
+    size_t _nextEntry;
+    IncrementalLexer::Change _change;
+    FlatHashSet<const tree::ParseTree *> _reused;
+    size_t _reusedNodeCount;
+
+    ParserRuleContext* run(TokenStream *tokens);
+
+    /// Mark the current rule context and all contexts it was invoked from as not reusable.
+    void taint();
+
+    /// Switch {@code tree} over to the tokens of the current parse, {@code shift} token indexes behind
+    /// its old ones. {@code before} replaces tokens in front of the subtree.
+    void rebind(ParserRuleContext *tree, ssize_t shift, Token *before);
+  };
+
+} // namespace antlr4
@@ -0,0 +1,204 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <algorithm>
+
+#include "Exceptions.h"
+#include "Vocabulary.h"
+
+#include "KeywordTable.h"
+
+using namespace antlr4;
+
+namespace {
+
+  /// Tries per bucket before the table is made larger.
+  constexpr uint32_t MAX_DISPLACEMENT = 1 << 16;
+
+  template <typename CharT>
+  inline uint32_t fold(CharT c, bool caseInsensitive) {
+    uint32_t value = static_cast<uint32_t>(static_cast<std::make_unsigned_t<CharT>>(c));
+    if (caseInsensitive && value >= 'A' && value <= 'Z') {
+      value += 'a' - 'A';
+    }
+    return value;
+  }
+
+  inline uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+  }
+
+  inline size_t getSlot(uint64_t hash, uint32_t displacement, size_t mask) {
+    return static_cast<size_t>(mix(hash + (displacement + 1) * 0x9E3779B97F4A7C15ULL)) & mask;
+  }
+
+  size_t roundUpToPowerOf2(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+}
+
+KeywordTable::KeywordTable(const std::vector<std::pair<std::string, size_t>> &keywords, bool caseInsensitive)
+  : _caseInsensitive(caseInsensitive) {
+  std::vector<std::pair<std::string, size_t>> unique;
+  for (const auto &[keyword, tokenType] : keywords) {
+    if (keyword.empty()) {
+      throw IllegalArgumentException("a keyword cannot be empty");
+    }
+    std::string folded;
+    for (char c : keyword) {
+      if (static_cast<unsigned char>(c) >= 128) {
+        throw IllegalArgumentException("the keyword " + keyword + " is not ASCII");
+      }
+      folded.push_back(static_cast<char>(fold(c, caseInsensitive)));
+    }
+
+    auto existing = std::find_if(unique.begin(), unique.end(), [&folded](const auto &entry) {
+      return entry.first == folded;
+    });
+    if (existing == unique.end()) {
+      unique.emplace_back(std::move(folded), tokenType);
+    } else if (existing->second != tokenType) {
+      throw IllegalArgumentException("the keyword " + keyword + " is defined for two token types");
+    }
+  }
+
+  _size = unique.size();
+  if (_size == 0) {
+    return;
+  }
+  _minLength = std::numeric_limits<size_t>::max();
+  for (const auto &entry : unique) {
+    _minLength = std::min(_minLength, entry.first.size());
+    _maxLength = std::max(_maxLength, entry.first.size());
+  }
+
+  std::vector<uint64_t> hashes;
+  for (const auto &entry : unique) {
+    hashes.push_back(hash(entry.first.data(), entry.first.size()));
+  }
+
+  // Place the buckets with the most keywords first, while most slots are still free.
+  _displacements.assign(roundUpToPowerOf2(std::max<size_t>(_size / 4, 1)), 0);
+  size_t bucketMask = _displacements.size() - 1;
+  std::vector<std::vector<size_t>> buckets(_displacements.size());
+  for (size_t i = 0; i < _size; ++i) {
+    buckets[(hashes[i] >> 32) & bucketMask].push_back(i);
+  }
+  std::vector<size_t> order(buckets.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) {
+    return buckets[lhs].size() > buckets[rhs].size();
+  });
+
+  size_t slotCount = roundUpToPowerOf2(_size + _size / 2);
+  while (true) {
+    size_t mask = slotCount - 1;
+    std::vector<bool> used(slotCount, false);
+    std::vector<size_t> slots;
+    bool placed = true;
+    for (size_t b : order) {
+      uint32_t displacement = 0;
+      for (; displacement < MAX_DISPLACEMENT; ++displacement) {
+        slots.clear();
+        for (size_t i : buckets[b]) {
+          size_t slot = getSlot(hashes[i], displacement, mask);
+          if (used[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+            break;
+          }
+          slots.push_back(slot);
+        }
+        if (slots.size() == buckets[b].size()) {
+          break;
+        }
+      }
+      if (displacement == MAX_DISPLACEMENT) {
+        placed = false;
+        break;
+      }
+      _displacements[b] = displacement;
+      for (size_t slot : slots) {
+        used[slot] = true;
+      }
+    }
+
+    if (placed) {
+      break;
+    }
+    slotCount *= 2;
+  }
+
+  _slots.resize(slotCount);
+  for (size_t i = 0; i < _size; ++i) {
+    uint32_t displacement = _displacements[(hashes[i] >> 32) & bucketMask];
+    Slot &slot = _slots[getSlot(hashes[i], displacement, slotCount - 1)];
+    slot.keyword = std::move(unique[i].first);
+    slot.tokenType = unique[i].second;
+  }
+}
+
+KeywordTable KeywordTable::fromVocabulary(const dfa::Vocabulary &vocabulary, const std::vector<size_t> &tokenTypes,
+                                          bool caseInsensitive) {
+  std::vector<std::pair<std::string, size_t>> keywords;
+  for (size_t tokenType : tokenTypes) {
+    std::string_view name = vocabulary.getLiteralName(tokenType);
+    if (name.size() > 2 && name.front() == '\'' && name.back() == '\'') {
+      name = name.substr(1, name.size() - 2);
+    } else {
+      name = vocabulary.getSymbolicName(tokenType);
+    }
+    if (name.empty()) {
+      throw IllegalArgumentException("token type " + std::to_string(tokenType) + " has no name");
+    }
+    keywords.emplace_back(std::string(name), tokenType);
+  }
+  return KeywordTable(keywords, caseInsensitive);
+}
+
+size_t KeywordTable::lookup(std::string_view text) const {
+  return find(text.data(), text.size());
+}
+
+size_t KeywordTable::lookup(std::u32string_view text) const {
+  return find(text.data(), text.size());
+}
+
+template <typename CharT>
+size_t KeywordTable::find(const CharT *text, size_t length) const {
+  if (_size == 0 || length < _minLength || length > _maxLength) {
+    return Token::INVALID_TYPE;
+  }
+
+  uint64_t h = hash(text, length);
+  uint32_t displacement = _displacements[(h >> 32) & (_displacements.size() - 1)];
+  const Slot &slot = _slots[getSlot(h, displacement, _slots.size() - 1)];
+  if (slot.keyword.size() != length) {
+    return Token::INVALID_TYPE;
+  }
+  for (size_t i = 0; i < length; ++i) {
+    if (fold(text[i], _caseInsensitive) != static_cast<unsigned char>(slot.keyword[i])) {
+      return Token::INVALID_TYPE;
+    }
+  }
+  return slot.tokenType;
+}
+
+template <typename CharT>
+uint64_t KeywordTable::hash(const CharT *text, size_t length) const {
+  // FNV-1a over the folded characters.
+  uint64_t h = 0xCBF29CE484222325ULL;
+  for (size_t i = 0; i < length; ++i) {
+    h = (h ^ fold(text[i], _caseInsensitive)) * 0x100000001B3ULL;
+  }
+  return mix(h);
+}
@@ -0,0 +1,62 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <string_view>
+
+#include "Token.h"
+
+namespace antlr4 {
+
+  /// Maps keywords to token types with a perfect hash, so a lexer can match all identifiers with a
+  /// single rule and look up the keywords afterwards (see <seealso cref="Lexer#setKeywordTable"/>).
+  /// Grammars with hundreds of keywords otherwise need a lexer rule and many DFA states per keyword.
+  ///
+  /// A lookup hashes the text once, finds its slot through the displacement of the hash's bucket and
+  /// compares a single keyword. Keywords consist of ASCII characters. If the table is case
+  /// insensitive, ASCII letters match regardless of their case.
+  class ANTLR4CPP_PUBLIC KeywordTable final {
+  public:
+    /// Throws an IllegalArgumentException if a keyword is empty or not ASCII, or if two keywords
+    /// which are equal (regardless of case, if caseInsensitive) have different token types.
+    KeywordTable(const std::vector<std::pair<std::string, size_t>> &keywords, bool caseInsensitive);
+
+    /// The keywords of the given token types, taken from {@code vocabulary}: the literal name
+    /// without quotes if there is one (e.g. 'select'), else the symbolic name (e.g. SELECT).
+    static KeywordTable fromVocabulary(const dfa::Vocabulary &vocabulary, const std::vector<size_t> &tokenTypes,
+                                       bool caseInsensitive);
+
+    /// The token type of the keyword {@code text}, or Token::INVALID_TYPE if it is not a keyword.
+    size_t lookup(std::string_view text) const;
+    size_t lookup(std::u32string_view text) const;
+
+    size_t size() const { return _size; }
+    size_t getMaxLength() const { return _maxLength; }
+    bool isCaseInsensitive() const { return _caseInsensitive; }
+
+  private:
+    struct Slot {
+      std::string keyword;
+      size_t tokenType = Token::INVALID_TYPE;
+    };
+
+    bool _caseInsensitive;
+    size_t _size = 0;
+    size_t _minLength = 0;
+    size_t _maxLength = 0;
+
+    /// The seed of each bucket, which places all keywords of the bucket in distinct free slots.
+    std::vector<uint32_t> _displacements;
+    std::vector<Slot> _slots;
+
+    template <typename CharT>
+    size_t find(const CharT *text, size_t length) const;
+
+    template <typename CharT>
+    uint64_t hash(const CharT *text, size_t length) const;
+  };
+
+} // namespace antlr4
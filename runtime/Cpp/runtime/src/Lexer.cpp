@@ -5,12 +5,16 @@
 
 #include "atn/LexerATNSimulator.h"
 #include "Exceptions.h"
+#include "KeywordTable.h"
 #include "misc/Interval.h"
+#include "misc/IntervalSet.h"
 #include "CommonTokenFactory.h"
 #include "LexerNoViableAltException.h"
 #include "ANTLRErrorListener.h"
 #include "support/CPPUtils.h"
 #include "CommonToken.h"
+#include "TokenBuffer.h"
+#include "PushCharStream.h"
 
 #include "Lexer.h"
 
@@ -46,13 +50,30 @@ void Lexer::reset() {
   mode = Lexer::DEFAULT_MODE;
   modeStack.clear();
 
+  if (_suspended) {
+    _suspended = false;
+    _input->release(_suspendedMarker);
+  }
+
   getInterpreter<atn::LexerATNSimulator>()->reset();
 }
 
 std::unique_ptr<Token> Lexer::nextToken() {
+  if (!lexNextToken(nullptr)) {
+    return nullptr;
+  }
+  return std::move(token);
+}
+
+bool Lexer::appendNextToken(TokenBuffer &buffer) {
+  return lexNextToken(&buffer);
+}
+
+bool Lexer::lexNextToken(TokenBuffer *buffer) {
   // Mark start location in char stream so unbuffered streams are
-  // guaranteed at least have text of current token
-  ssize_t tokenStartMarker = _input->mark();
+  // guaranteed at least have text of current token. A suspended token
+  // still holds its marker from the previous call.
+  ssize_t tokenStartMarker = _suspended ? _suspendedMarker : _input->mark();
 
   auto onExit = finally([this, tokenStartMarker]{
     // make sure we release marker after match or
@@ -60,19 +81,32 @@ std::unique_ptr<Token> Lexer::nextToken() {
     _input->release(tokenStartMarker);
   });
 
+  // When resuming, the token start and any text collected by MORE are still valid.
+  bool resuming = _suspended;
+  _suspended = false;
+
   while (true) {
   outerContinue:
+    checkCancellation();
     if (hitEOF) {
-      emitEOF();
-      return std::move(token);
+      if (buffer == nullptr) {
+        emitEOF();
+      } else {
+        buffer->add(EOF, Token::DEFAULT_CHANNEL, _input->index(), _input->index() - 1, getLine(),
+                    getCharPositionInLine());
+      }
+      return true;
     }
 
-    token.reset();
-    channel = Token::DEFAULT_CHANNEL;
-    tokenStartCharIndex = _input->index();
-    tokenStartCharPositionInLine = getInterpreter<atn::LexerATNSimulator>()->getCharPositionInLine();
-    tokenStartLine = getInterpreter<atn::LexerATNSimulator>()->getLine();
-    _text = "";
+    if (!resuming) {
+      token.reset();
+      channel = Token::DEFAULT_CHANNEL;
+      tokenStartCharIndex = _input->index();
+      tokenStartCharPositionInLine = getInterpreter<atn::LexerATNSimulator>()->getCharPositionInLine();
+      tokenStartLine = getInterpreter<atn::LexerATNSimulator>()->getLine();
+      _text = "";
+    }
+    resuming = false;
     do {
       type = Token::INVALID_TYPE;
       size_t ttype;
@@ -83,6 +117,14 @@ std::unique_ptr<Token> Lexer::nextToken() {
         recover(e);
         ttype = SKIP;
       }
+      if (ttype == SUSPEND) {
+        // Ran out of pushed input in the middle of a token. Keep the token start marked
+        // until the token is complete.
+        _suspended = true;
+        _suspendedMarker = tokenStartMarker;
+        onExit.disable();
+        return false;
+      }
       if (_input->LA(1) == EOF) {
         hitEOF = true;
       }
@@ -93,10 +135,32 @@ std::unique_ptr<Token> Lexer::nextToken() {
         goto outerContinue;
       }
     } while (type == MORE);
-    if (token == nullptr) {
-      emit();
+
+    if (token == nullptr && _keywordTable != nullptr && type == _keywordIdentifierType) {
+      remapKeyword();
     }
-    return std::move(token);
+
+    // A PushCharStream drops consumed input, so the text cannot be read from it later on.
+    if (token == nullptr && _text.empty() && dynamic_cast<PushCharStream *>(_input) != nullptr) {
+      _text = getText();
+    }
+
+    if (buffer == nullptr) {
+      if (token == nullptr) {
+        emit();
+      }
+    } else if (token != nullptr) {
+      // Emitted by a lexer action.
+      buffer->add(*token);
+      token.reset();
+    } else if (_text.empty()) {
+      buffer->add(type, channel, tokenStartCharIndex, getCharIndex() - 1, tokenStartLine,
+                  tokenStartCharPositionInLine);
+    } else {
+      buffer->add(type, channel, tokenStartCharIndex, getCharIndex() - 1, tokenStartLine,
+                  tokenStartCharPositionInLine, _text);
+    }
+    return true;
   }
 }
 
@@ -108,6 +172,47 @@ void Lexer::more() {
   type = MORE;
 }
 
+void Lexer::setFastSkip(bool enable) {
+  getInterpreter<atn::LexerATNSimulator>()->setFastSkip(enable);
+}
+
+void Lexer::setKeywordTable(const KeywordTable *table, size_t identifierType) {
+  _keywordTable = table;
+  _keywordIdentifierType = identifierType;
+}
+
+const KeywordTable* Lexer::getKeywordTable() const {
+  return _keywordTable;
+}
+
+const misc::IntervalSet& Lexer::getRestartCharacters() const {
+  static const misc::IntervalSet newline = misc::IntervalSet::of('\n');
+  return newline;
+}
+
+void Lexer::remapKeyword() {
+  size_t keywordType;
+  size_t length = getCharIndex() - tokenStartCharIndex;
+  if (_text.empty() && length > _keywordTable->getMaxLength()) {
+    return;
+  }
+
+  char32_t chars[64];
+  if (!_text.empty() || length > sizeof(chars) / sizeof(chars[0])) {
+    keywordType = _keywordTable->lookup(getText());
+  } else {
+    // Read the token's characters back from the input, without converting them to UTF-8.
+    for (size_t i = 0; i < length; ++i) {
+      chars[i] = static_cast<char32_t>(_input->LA(static_cast<ssize_t>(i) - static_cast<ssize_t>(length)));
+    }
+    keywordType = _keywordTable->lookup(std::u32string_view(chars, length));
+  }
+
+  if (keywordType != Token::INVALID_TYPE) {
+    type = keywordType;
+  }
+}
+
 void Lexer::setMode(size_t m) {
   mode = m;
 }
@@ -234,6 +339,31 @@ std::vector<std::unique_ptr<Token>> Lexer::getAllTokens() {
   return tokens;
 }
 
+std::vector<std::unique_ptr<Token>> Lexer::getAvailableTokens() {
+  std::vector<std::unique_ptr<Token>> tokens;
+  std::unique_ptr<Token> t = nextToken();
+  while (t != nullptr && t->getType() != EOF) {
+    tokens.push_back(std::move(t));
+    t = nextToken();
+  }
+  return tokens;
+}
+
+size_t Lexer::tokenizeAll(TokenBuffer &buffer) {
+  size_t count = 0;
+  while (appendNextToken(buffer)) {
+    ++count;
+    if (buffer.getType(buffer.size() - 1) == EOF) {
+      break;
+    }
+  }
+  return count;
+}
+
+bool Lexer::isSuspended() const {
+  return _suspended;
+}
+
 void Lexer::recover(const LexerNoViableAltException &/*e*/) {
   if (_input->LA(1) != EOF) {
     // skip a char and try again
@@ -250,6 +380,11 @@ void Lexer::notifyListeners(const LexerNoViableAltException & /*e*/) {
   listener.syntaxError(this, nullptr, tokenStartLine, tokenStartCharPositionInLine, msg, std::current_exception());
 }
 
+void Lexer::notifySyntaxError(size_t line, size_t charPositionInLine, const std::string &msg, std::exception_ptr e) {
+  ++_syntaxErrors;
+  getErrorListenerDispatch().syntaxError(this, nullptr, line, charPositionInLine, msg, e);
+}
+
 std::string Lexer::getErrorDisplay(const std::string &s) {
   std::stringstream ss;
   for (auto c : s) {
@@ -291,4 +426,8 @@ void Lexer::InitializeInstanceFields() {
   channel = 0;
   type = 0;
   mode = Lexer::DEFAULT_MODE;
+  _suspended = false;
+  _suspendedMarker = 0;
+  _keywordTable = nullptr;
+  _keywordIdentifierType = Token::INVALID_TYPE;
 }
@@ -22,6 +22,10 @@ namespace antlr4 {
     static constexpr size_t MORE = std::numeric_limits<size_t>::max() - 1;
     static constexpr size_t SKIP = std::numeric_limits<size_t>::max() - 2;
 
+    /// Returned by LexerATNSimulator::match() when the input ran out in the middle of a token,
+    /// see <seealso cref="PushCharStream"/>.
+    static constexpr size_t SUSPEND = std::numeric_limits<size_t>::max() - 3;
+
     static constexpr size_t DEFAULT_TOKEN_CHANNEL = Token::DEFAULT_CHANNEL;
     static constexpr size_t HIDDEN = Token::HIDDEN_CHANNEL;
     static constexpr size_t MIN_CHAR_VALUE = 0;
@@ -82,8 +86,18 @@ namespace antlr4 {
     virtual void reset();
 
     /// Return a token from this source; i.e., match a token on the char stream.
+    ///
+    /// If the input is a <seealso cref="PushCharStream"/> which has not yet received enough input to
+    /// complete the next token, this method returns null and the lexer is suspended. The next call,
+    /// usually after more input was appended, continues the pending token where it stopped.
     virtual std::unique_ptr<Token> nextToken() override;
 
+    /// Match the next token like nextToken(), but append it to {@code buffer} instead of creating a token
+    /// object. Only tokens which lexer actions emit explicitly are created (and copied). emit() and emitEOF()
+    /// are not called, so lexers which override them must use nextToken(). Returns false, without
+    /// appending a token, if the lexer got suspended (see nextToken()).
+    virtual bool appendNextToken(TokenBuffer &buffer);
+
     /// Instruct the lexer to skip creating a token for current lexer rule
     /// and look for another token.  nextToken() knows to keep looking when
     /// a lexer rule finishes with token set to SKIP_TOKEN.  Recall that
@@ -91,6 +105,23 @@ namespace antlr4 {
     /// and emits it.
     virtual void skip();
     virtual void more();
+
+    /// Drop tokens of rules whose only command is {@code -> skip} without leaving the lexer's ATN
+    /// simulator. skip() is not called for them. See <seealso cref="atn::LexerATNSimulator#setFastSkip"/>.
+    void setFastSkip(bool enable);
+
+    /// Give tokens of type {@code identifierType} whose text is a keyword of {@code table} the token type
+    /// of the keyword, before they are emitted. The keywords then need no lexer rules of their own. Tokens
+    /// emitted by lexer actions are not changed. The table must outlive the lexer; pass null to stop.
+    void setKeywordTable(const KeywordTable *table, size_t identifierType);
+    const KeywordTable* getKeywordTable() const;
+
+    /// Characters after which lexing can usually start over in the default mode, e.g. a newline outside
+    /// of strings and comments. <seealso cref="ParallelTokenizer"/> starts its chunks after them, but
+    /// verifies that the tokens are the same as if the input was lexed from its beginning. The default
+    /// is '\n', generated lexers return the characters of the {@code restartCharacters} grammar option.
+    virtual const misc::IntervalSet& getRestartCharacters() const;
+
     virtual void setMode(size_t m);
     virtual void pushMode(size_t m);
     virtual size_t popMode();
@@ -164,6 +195,19 @@ namespace antlr4 {
     /// Forces load of all tokens. Does not include EOF token.
     virtual std::vector<std::unique_ptr<Token>> getAllTokens();
 
+    /// Return all tokens which can be completed with the input available so far in a
+    /// <seealso cref="PushCharStream"/>. Does not include EOF token. Check hitEOF to see whether
+    /// the end of the (closed) stream was reached.
+    virtual std::vector<std::unique_ptr<Token>> getAvailableTokens();
+
+    /// Append all remaining tokens, including EOF, to {@code buffer} via appendNextToken(). This is the
+    /// fastest way to tokenize a complete input, without any per-token allocation. Returns the number
+    /// of tokens appended, which stops short of EOF if the lexer got suspended.
+    virtual size_t tokenizeAll(TokenBuffer &buffer);
+
+    /// Returns true if the last call to nextToken() ran out of input in the middle of a token.
+    bool isSuspended() const;
+
     virtual void recover(const LexerNoViableAltException &e);
 
     virtual void notifyListeners(const LexerNoViableAltException &e);
@@ -183,6 +227,10 @@ namespace antlr4 {
     /// <seealso cref= #notifyListeners </seealso>
     virtual size_t getNumberOfSyntaxErrors();
 
+    /// Counts a syntax error in this lexer's input which was found by another lexer, e.g. the lexer of
+    /// a chunk in <seealso cref="ParallelTokenizer"/>, and reports it to the error listeners.
+    void notifySyntaxError(size_t line, size_t charPositionInLine, const std::string &msg, std::exception_ptr e);
+
   protected:
     /// You can set the text for the current token to override what is in
     /// the input char buffer (via setText()).
@@ -190,6 +238,20 @@ namespace antlr4 {
 
   private:
     size_t _syntaxErrors;
+
+    bool _suspended;
+    ssize_t _suspendedMarker;
+
+    const KeywordTable *_keywordTable;
+    size_t _keywordIdentifierType;
+
+    /// The token loop shared by nextToken() and appendNextToken(). Emits the token, or appends it to
+    /// {@code buffer} if that is not null. Returns false if the lexer got suspended.
+    bool lexNextToken(TokenBuffer *buffer);
+
+    /// Look up the text of the current token in _keywordTable and change its type if it is a keyword.
+    void remapKeyword();
+
     void InitializeInstanceFields();
   };
 
@@ -0,0 +1,365 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "ANTLRInputStream.h"
+#include "BaseErrorListener.h"
+#include "CodePointStream.h"
+#include "Lexer.h"
+#include "TokenBuffer.h"
+#include "misc/IntervalSet.h"
+
+#include "ParallelTokenizer.h"
+
+using namespace antlr4;
+
+namespace {
+
+  /// Keeps the errors of a chunk's lexer until it is known which of its tokens are used.
+  class ErrorCollector final : public BaseErrorListener {
+  public:
+    struct Error {
+      /// The index of the token being lexed when the error occurred.
+      size_t tokenIndex;
+      size_t line;
+      size_t charPositionInLine;
+      std::string msg;
+      /// Refers to the chunk's lexer and input, which are destroyed when tokenize() returns.
+      std::exception_ptr e;
+    };
+
+    std::vector<Error> errors;
+
+    explicit ErrorCollector(const TokenBuffer &tokens) : _tokens(tokens) {}
+
+    void syntaxError(Recognizer * /*recognizer*/, Token * /*offendingSymbol*/, size_t line,
+                     size_t charPositionInLine, const std::string &msg, std::exception_ptr e) override {
+      errors.push_back({ _tokens.size(), line, charPositionInLine, msg, e });
+    }
+
+  private:
+    const TokenBuffer &_tokens;
+  };
+
+  bool endsWithEOF(const TokenBuffer &tokens) {
+    return tokens.size() > 0 && tokens.getType(tokens.size() - 1) == Token::EOF;
+  }
+
+  bool isInDefaultMode(const Lexer &lexer) {
+    return lexer.mode == Lexer::DEFAULT_MODE && lexer.modeStack.empty();
+  }
+
+  /// {@code count - 1} threads, started once, which together with the calling thread run the phases
+  /// of a tokenize() call.
+  class Workers final {
+  public:
+    explicit Workers(size_t count) : _failures(count) {
+      _threads.reserve(count - 1);
+      for (size_t i = 1; i < count; ++i) {
+        _threads.emplace_back([this, i] { work(i); });
+      }
+    }
+
+    ~Workers() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+      }
+      _started.notify_all();
+      for (auto &thread : _threads) {
+        thread.join();
+      }
+    }
+
+    /// Calls task(0) to task(count - 1), the first on the calling thread, and returns when all of them
+    /// are done. Rethrows the first exception thrown by any of them.
+    void run(const std::function<void(size_t)> &task) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = &task;
+        _pending = _threads.size();
+        ++_generation;
+      }
+      _started.notify_all();
+
+      call(task, 0);
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _finished.wait(lock, [this] { return _pending == 0; });
+      }
+
+      for (auto &failure : _failures) {
+        if (failure != nullptr) {
+          std::exception_ptr first = failure;
+          std::fill(_failures.begin(), _failures.end(), nullptr);
+          std::rethrow_exception(first);
+        }
+      }
+    }
+
+  private:
+    std::mutex _mutex;
+    std::condition_variable _started;
+    std::condition_variable _finished;
+    const std::function<void(size_t)> *_task = nullptr;
+    size_t _generation = 0;
+    size_t _pending = 0;
+    bool _stopped = false;
+    std::vector<std::exception_ptr> _failures;
+    std::vector<std::thread> _threads;
+
+    void call(const std::function<void(size_t)> &task, size_t i) {
+      try {
+        task(i);
+      } catch (...) {
+        _failures[i] = std::current_exception();
+      }
+    }
+
+    void work(size_t i) {
+      size_t generation = 0;
+      while (true) {
+        const std::function<void(size_t)> *task;
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          _started.wait(lock, [&] { return _stopped || _generation != generation; });
+          if (_stopped) {
+            return;
+          }
+          generation = _generation;
+          task = _task;
+        }
+
+        call(*task, i);
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          if (--_pending == 0) {
+            _finished.notify_one();
+          }
+        }
+      }
+    }
+  };
+
+}
+
+struct ParallelTokenizer::Chunk {
+  size_t start = 0;
+  size_t end = 0;
+
+  /// The number of newlines in the chunk, and the index of the last one.
+  size_t newlines = 0;
+  size_t lastNewline = 0;
+
+  std::unique_ptr<CodePointStream> input;
+  std::unique_ptr<Lexer> ownLexer;
+  Lexer *lexer = nullptr;
+  TokenBuffer tokens;
+  std::unique_ptr<ErrorCollector> errors;
+
+  /// The positions at which this chunk's lexer started a token in the default mode, in ascending
+  /// order, and the indexes of these tokens in {@code tokens}.
+  std::vector<size_t> restartPositions;
+  std::vector<size_t> restartTokens;
+
+  /// The number of tokens lexed after the end of the chunk, to find the point where the tokens of a
+  /// following chunk can be used.
+  size_t extraTokenCount = 0;
+
+  /// That point: the index of the chunk and of its token. The chunk count if the tokens of this chunk
+  /// end with EOF.
+  size_t nextChunk = 0;
+  size_t nextToken = 0;
+};
+
+ParallelTokenizer::ParallelTokenizer(LexerFactory factory, size_t threads)
+  : _factory(std::move(factory)), _threads(threads), _minChunkSize(DEFAULT_MIN_CHUNK_SIZE), _chunkCount(0),
+    _relexedTokenCount(0) {
+  if (_threads == 0) {
+    _threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+}
+
+void ParallelTokenizer::setMinChunkSize(size_t size) {
+  _minChunkSize = std::max<size_t>(size, 1);
+}
+
+size_t ParallelTokenizer::getMinChunkSize() const {
+  return _minChunkSize;
+}
+
+size_t ParallelTokenizer::getChunkCount() const {
+  return _chunkCount;
+}
+
+size_t ParallelTokenizer::getRelexedTokenCount() const {
+  return _relexedTokenCount;
+}
+
+size_t ParallelTokenizer::tokenize(Lexer &lexer, TokenBuffer &buffer) {
+  _chunkCount = 1;
+  _relexedTokenCount = 0;
+
+  CharStream *input = lexer.getInputStream();
+  std::u32string_view data;
+  if (auto *stream = dynamic_cast<ANTLRInputStream *>(input); stream != nullptr) {
+    data = stream->getCodePoints();
+  } else if (auto *stream = dynamic_cast<CodePointStream *>(input); stream != nullptr) {
+    data = stream->getCodePoints();
+  } else {
+    return lexer.tokenizeAll(buffer);
+  }
+
+  std::vector<size_t> starts = splitInput(data, input->index(), lexer.getRestartCharacters());
+  if (starts.size() < 2) {
+    return lexer.tokenizeAll(buffer);
+  }
+  _chunkCount = starts.size();
+
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  for (size_t i = 0; i < starts.size(); ++i) {
+    auto chunk = std::make_unique<Chunk>();
+    chunk->start = starts[i];
+    chunk->end = i + 1 < starts.size() ? starts[i + 1] : data.size();
+    chunks.push_back(std::move(chunk));
+  }
+  Workers workers(chunks.size());
+
+  // Lines and columns at the start of every chunk.
+  workers.run([&](size_t i) {
+    Chunk &chunk = *chunks[i];
+    for (size_t p = chunk.start; p < chunk.end; ++p) {
+      if (data[p] == '\n') {
+        ++chunk.newlines;
+        chunk.lastNewline = p;
+      }
+    }
+  });
+
+  chunks[0]->lexer = &lexer;
+  size_t line = lexer.getLine();
+  size_t charPositionInLine = lexer.getCharPositionInLine() + chunks[0]->end - chunks[0]->start;
+  if (chunks[0]->newlines > 0) {
+    line += chunks[0]->newlines;
+    charPositionInLine = chunks[0]->end - chunks[0]->lastNewline - 1;
+  }
+  for (size_t i = 1; i < chunks.size(); ++i) {
+    Chunk &chunk = *chunks[i];
+    // The text of tokens and error messages comes from the original input, which differs from data
+    // for a CaseFoldingInputStream.
+    chunk.input = std::make_unique<CodePointStream>(data, chunk.start, input);
+    chunk.input->name = input->getSourceName();
+    chunk.ownLexer = _factory(chunk.input.get());
+    chunk.lexer = chunk.ownLexer.get();
+    chunk.errors = std::make_unique<ErrorCollector>(chunk.tokens);
+    chunk.lexer->removeErrorListeners();
+    chunk.lexer->addErrorListener(chunk.errors.get());
+    chunk.lexer->setLine(line);
+    chunk.lexer->setCharPositionInLine(charPositionInLine);
+
+    if (chunk.newlines > 0) {
+      line += chunk.newlines;
+      charPositionInLine = chunk.end - chunk.lastNewline - 1;
+    } else {
+      charPositionInLine += chunk.end - chunk.start;
+    }
+  }
+
+  // Lex every chunk on its own.
+  workers.run([&](size_t i) {
+    Chunk &chunk = *chunks[i];
+    CharStream *chunkInput = chunk.lexer->getInputStream();
+    while (chunkInput->index() < chunk.end && !endsWithEOF(chunk.tokens)) {
+      if (i > 0 && isInDefaultMode(*chunk.lexer)) {
+        chunk.restartPositions.push_back(chunkInput->index());
+        chunk.restartTokens.push_back(chunk.tokens.size());
+      }
+      chunk.lexer->appendNextToken(chunk.tokens);
+    }
+  });
+
+  // Continue lexing each chunk until a following chunk's lexer started a token at the same position.
+  // Both lexers were in the default mode there, so they produce the same tokens from there on.
+  workers.run([&](size_t i) {
+    Chunk &chunk = *chunks[i];
+    CharStream *chunkInput = chunk.lexer->getInputStream();
+    while (!endsWithEOF(chunk.tokens)) {
+      size_t position = chunkInput->index();
+      if (isInDefaultMode(*chunk.lexer)) {
+        size_t next = static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), position) - starts.begin()) - 1;
+        if (next > i) {
+          const Chunk &other = *chunks[next];
+          auto iterator = std::lower_bound(other.restartPositions.begin(), other.restartPositions.end(), position);
+          if (iterator != other.restartPositions.end() && *iterator == position) {
+            chunk.nextChunk = next;
+            chunk.nextToken = other.restartTokens[static_cast<size_t>(iterator - other.restartPositions.begin())];
+            return;
+          }
+        }
+      }
+
+      chunk.lexer->appendNextToken(chunk.tokens);
+      if (!endsWithEOF(chunk.tokens)) {
+        ++chunk.extraTokenCount;
+      }
+    }
+    chunk.nextChunk = chunks.size();
+  });
+
+  // Join the tokens which a single lexer would have produced.
+  size_t count = 0;
+  size_t i = 0;
+  size_t from = 0;
+  while (true) {
+    Chunk &chunk = *chunks[i];
+    buffer.append(chunk.tokens, from, chunk.tokens.size());
+    count += chunk.tokens.size() - from;
+    _relexedTokenCount += chunk.extraTokenCount;
+
+    if (chunk.errors != nullptr) {
+      for (const auto &error : chunk.errors->errors) {
+        if (error.tokenIndex >= from) {
+          lexer.notifySyntaxError(error.line, error.charPositionInLine, error.msg, error.e);
+        }
+      }
+    }
+
+    if (chunk.nextChunk == chunks.size()) {
+      break;
+    }
+    from = chunk.nextToken;
+    i = chunk.nextChunk;
+  }
+
+  return count;
+}
+
+std::vector<size_t> ParallelTokenizer::splitInput(std::u32string_view data, size_t start,
+                                                  const misc::IntervalSet &restart) const {
+  std::vector<size_t> starts = { start };
+  size_t length = data.size() - std::min(start, data.size());
+  size_t count = std::min(_threads, length / _minChunkSize);
+  if (count < 2 || restart.isEmpty()) {
+    return starts;
+  }
+
+  // Each chunk starts after the first restart character following its nominal start.
+  for (size_t k = 1; k < count; ++k) {
+    size_t end = start + length / count * (k + 1);
+    for (size_t p = std::max(start + length / count * k, starts.back()); p < end; ++p) {
+      if (restart.contains(static_cast<size_t>(data[p]))) {
+        if (p + 1 < data.size()) {
+          starts.push_back(p + 1);
+        }
+        break;
+      }
+    }
+  }
+  return starts;
+}
@@ -0,0 +1,80 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+
+  /// Tokenizes a large input on several threads. The input is split into chunks, each starting
+  /// after one of the lexer's restart characters (see <seealso cref="Lexer#getRestartCharacters"/>),
+  /// and every chunk is lexed by its own lexer, starting in the default mode.
+  ///
+  /// A restart character is only a guess, e.g. a newline can also be part of a string or comment.
+  /// Each chunk's lexer therefore continues past the end of its chunk until it starts a token at the
+  /// same position and in the same mode as the lexer of a following chunk. From there on both produce
+  /// the same tokens, so the tokens of the following chunk are used from that point. A wrong guess so
+  /// only costs re-lexing the input up to the next point where the lexers agree, and the result is
+  /// always the same as from lexing the input on one thread: token indexes, character indexes, lines
+  /// and columns included. Lexer actions must not depend on state other than the lexer's mode (stack)
+  /// for this to hold, and token text set by actions requires a TokenBuffer which stores text.
+  ///
+  /// Error listeners see the errors of the tokens actually used only, reported for the given lexer
+  /// after all chunks have been lexed (except for the first chunk, which the given lexer lexes itself).
+  /// The exceptions passed to them for errors in later chunks refer to the lexers and char streams of
+  /// those chunks, which only live until tokenize() returns: listeners must not keep them.
+  ///
+  /// <code>
+  ///   ANTLRInputStream input(text);
+  ///   MyLexer lexer(&input);
+  ///   TokenBuffer buffer;
+  ///   buffer.setTokenSource(&lexer);
+  ///   ParallelTokenizer tokenizer([](CharStream *input) { return std::make_unique<MyLexer>(input); });
+  ///   tokenizer.tokenize(lexer, buffer);
+  /// </code>
+  class ANTLR4CPP_PUBLIC ParallelTokenizer {
+  public:
+    /// Creates a lexer for the same grammar as the lexer passed to tokenize(), reading from {@code input}.
+    using LexerFactory = std::function<std::unique_ptr<Lexer>(CharStream *input)>;
+
+    static constexpr size_t DEFAULT_MIN_CHUNK_SIZE = 1 << 16;
+
+    /// Use up to {@code threads} threads, including the calling one. 0 means one per hardware thread.
+    explicit ParallelTokenizer(LexerFactory factory, size_t threads = 0);
+
+    /// Chunks are at least {@code size} characters long. Smaller inputs are not split.
+    void setMinChunkSize(size_t size);
+    size_t getMinChunkSize() const;
+
+    /// Append all remaining tokens of {@code lexer}, including EOF, to {@code buffer}, like
+    /// Lexer::tokenizeAll(). The lexer's input must be an ANTLRInputStream (or a subclass of it) or a
+    /// CodePointStream, otherwise the tokens are simply appended by Lexer::tokenizeAll(). The lexer
+    /// itself lexes the first chunk, its position afterwards is unspecified. Returns the number of
+    /// tokens appended.
+    size_t tokenize(Lexer &lexer, TokenBuffer &buffer);
+
+    /// The number of chunks the last input was split into.
+    size_t getChunkCount() const;
+
+    /// The number of tokens which were lexed a second time in the last tokenize() call, because
+    /// they were lexed past the end of a chunk, to find the point where the next chunk's tokens can be used.
+    size_t getRelexedTokenCount() const;
+
+  private:
+    struct Chunk;
+
+    LexerFactory _factory;
+    size_t _threads;
+    size_t _minChunkSize;
+    size_t _chunkCount;
+    size_t _relexedTokenCount;
+
+    std::vector<size_t> splitInput(std::u32string_view data, size_t start, const misc::IntervalSet &restart) const;
+  };
+
+} // namespace antlr4
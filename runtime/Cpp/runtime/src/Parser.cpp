@@ -21,6 +21,8 @@
 #include "ANTLRErrorListener.h"
 #include "tree/pattern/ParseTreePattern.h"
 #include "internal/Synchronization.h"
+#include "IncrementalParse.h"
+#include "tree/FlatParseTree.h"
 
 #include "atn/ProfilingATNSimulator.h"
 #include "atn/ParseInfo.h"
@@ -115,6 +117,9 @@ void Parser::reset() {
   _precedenceStack.push_back(0);
   _ctx = nullptr;
   _tracker.reset();
+  _releaseStarts.clear();
+  _releasedBegin = 0;
+  _releasedEnd = 0;
 
   atn::ATNSimulator *interpreter = getInterpreter<atn::ParserATNSimulator>();
   if (interpreter != nullptr) {
@@ -132,10 +137,15 @@ Token* Parser::match(size_t ttype) {
     consume();
   } else {
     t = _errHandler->recoverInline(this);
-    if (_buildParseTrees && t->getTokenIndex() == INVALID_INDEX) {
+    if (t->getTokenIndex() == INVALID_INDEX) {
       // we must have conjured up a new token during single token insertion
       // if it's not the current symbol
-      _ctx->addChild(createErrorNode(t));
+      if (_buildParseTrees) {
+        _ctx->addChild(createErrorNode(t));
+      }
+      if (_flatTree != nullptr) {
+        _flatTree->addMissingToken(t->getType());
+      }
     }
   }
   return t;
@@ -148,10 +158,15 @@ Token* Parser::matchWildcard() {
     consume();
   } else {
     t = _errHandler->recoverInline(this);
-    if (_buildParseTrees && t->getTokenIndex() == INVALID_INDEX) {
+    if (t->getTokenIndex() == INVALID_INDEX) {
       // we must have conjured up a new token during single token insertion
       // if it's not the current symbol
-      _ctx->addChild(createErrorNode(t));
+      if (_buildParseTrees) {
+        _ctx->addChild(createErrorNode(t));
+      }
+      if (_flatTree != nullptr) {
+        _flatTree->addMissingToken(t->getType());
+      }
     }
   }
 
@@ -323,6 +338,10 @@ Token* Parser::consume() {
     getInputStream()->consume();
   }
 
+  if (_flatTree != nullptr) {
+    _flatTree->addToken(o->getTokenIndex(), _errHandler->inErrorRecoveryMode(this));
+  }
+
   bool hasListener = _parseListeners.size() > 0 && !_parseListeners.empty();
   if (_buildParseTrees || hasListener) {
     if (_errHandler->inErrorRecoveryMode(this)) {
@@ -353,13 +372,19 @@ void Parser::addContextToParseTree() {
   downCast<ParserRuleContext*>(_ctx->parent)->addChild(_ctx);
 }
 
-void Parser::enterRule(ParserRuleContext *localctx, size_t state, size_t /*ruleIndex*/) {
+void Parser::enterRule(ParserRuleContext *localctx, size_t state, size_t ruleIndex) {
   setState(state);
   _ctx = localctx;
   _ctx->start = _input->LT(1);
   if (_buildParseTrees) {
     addContextToParseTree();
   }
+  if (_flatTree != nullptr) {
+    _flatTree->enterRule(ruleIndex);
+  }
+  if (!_releasedRules.empty()) {
+    enterReleasedRule(localctx, ruleIndex);
+  }
   if (_parseListeners.size() > 0) {
     triggerEnterRuleEvent();
   }
@@ -377,12 +402,25 @@ void Parser::exitRule() {
   if (_parseListeners.size() > 0) {
     triggerExitRuleEvent();
   }
+  if (_flatTree != nullptr) {
+    _flatTree->exitRule();
+  }
+  ParserRuleContext *ctx = _ctx;
+  if (ctx->children.size() >= ParserRuleContext::RULE_CONTEXT_INDEX_THRESHOLD) {
+    ctx->indexRuleContexts();
+  }
   setState(_ctx->invokingState);
   _ctx = downCast<ParserRuleContext*>(_ctx->parent);
+  if (!_releasedRules.empty()) {
+    exitReleasedRule(ctx);
+  }
 }
 
 void Parser::enterOuterAlt(ParserRuleContext *localctx, size_t altNum) {
   localctx->setAltNumber(altNum);
+  if (_flatTree != nullptr) {
+    _flatTree->enterOuterAlt(altNum);
+  }
 
   // if we have new localctx, make sure we replace existing ctx
   // that is previous child of parse tree
@@ -408,17 +446,23 @@ void Parser::enterRecursionRule(ParserRuleContext *localctx, size_t ruleIndex) {
   enterRecursionRule(localctx, getATN().ruleToStartState[ruleIndex]->stateNumber, ruleIndex, 0);
 }
 
-void Parser::enterRecursionRule(ParserRuleContext *localctx, size_t state, size_t /*ruleIndex*/, int precedence) {
+void Parser::enterRecursionRule(ParserRuleContext *localctx, size_t state, size_t ruleIndex, int precedence) {
   setState(state);
   _precedenceStack.push_back(precedence);
   _ctx = localctx;
   _ctx->start = _input->LT(1);
+  if (_flatTree != nullptr) {
+    _flatTree->enterRule(ruleIndex);
+  }
+  if (!_releasedRules.empty()) {
+    enterReleasedRule(localctx, ruleIndex);
+  }
   if (!_parseListeners.empty()) {
     triggerEnterRuleEvent(); // simulates rule entry for left-recursive rules
   }
 }
 
-void Parser::pushNewRecursionContext(ParserRuleContext *localctx, size_t state, size_t /*ruleIndex*/) {
+void Parser::pushNewRecursionContext(ParserRuleContext *localctx, size_t state, size_t ruleIndex) {
   ParserRuleContext *previous = _ctx;
   previous->parent = localctx;
   previous->invokingState = state;
@@ -429,6 +473,9 @@ void Parser::pushNewRecursionContext(ParserRuleContext *localctx, size_t state,
   if (_buildParseTrees) {
     _ctx->addChild(previous);
   }
+  if (_flatTree != nullptr) {
+    _flatTree->pushRecursionContext(ruleIndex);
+  }
 
   if (_parseListeners.size() > 0) {
     triggerEnterRuleEvent(); // simulates rule entry for left-recursive rules
@@ -439,6 +486,9 @@ void Parser::unrollRecursionContexts(ParserRuleContext *parentctx) {
   _precedenceStack.pop_back();
   _ctx->stop = _input->LT(-1);
   ParserRuleContext *retctx = _ctx; // save current ctx (return value)
+  if (_flatTree != nullptr) {
+    _flatTree->exitRule();
+  }
 
   // unroll so ctx is as it was before call to recursive method
   if (_parseListeners.size() > 0) {
@@ -452,11 +502,17 @@ void Parser::unrollRecursionContexts(ParserRuleContext *parentctx) {
 
   // hook into tree
   retctx->parent = parentctx;
+  if (retctx->children.size() >= ParserRuleContext::RULE_CONTEXT_INDEX_THRESHOLD) {
+    retctx->indexRuleContexts();
+  }
 
   if (_buildParseTrees && parentctx != nullptr) {
     // add return ctx into invoking rule's tree
     parentctx->addChild(retctx);
   }
+  if (!_releasedRules.empty()) {
+    exitReleasedRule(retctx);
+  }
 }
 
 ParserRuleContext* Parser::getInvokingContext(size_t ruleIndex) {
@@ -648,6 +704,33 @@ bool Parser::isTrace() const {
   return _tracer != nullptr;
 }
 
+ParserRuleContext* Parser::reuseIncrementalContext(size_t ruleIndex) {
+  if (_ctx == nullptr || _flatTree != nullptr) {
+    return nullptr;
+  }
+  return _incrementalParse->reuse(ruleIndex);
+}
+
+void Parser::setFlatParseTree(tree::FlatParseTree *tree) {
+  _flatTree = tree;
+}
+
+tree::FlatParseTree* Parser::getFlatParseTree() const {
+  return _flatTree;
+}
+
+void Parser::setSubtreeHandler(const std::vector<size_t> &ruleIndexes, SubtreeHandler handler) {
+  _releasedRules.clear();
+  for (size_t ruleIndex : ruleIndexes) {
+    if (ruleIndex >= _releasedRules.size()) {
+      _releasedRules.resize(ruleIndex + 1);
+    }
+    _releasedRules[ruleIndex] = true;
+  }
+  _subtreeHandler = std::move(handler);
+  _releaseStarts.clear();
+}
+
 tree::TerminalNode *Parser::createTerminalNode(Token *t) {
   return _tracker.createInstance<tree::TerminalNodeImpl>(t);
 }
@@ -656,6 +739,53 @@ tree::ErrorNode *Parser::createErrorNode(Token *t) {
   return _tracker.createInstance<tree::ErrorNodeImpl>(t);
 }
 
+void Parser::enterReleasedRule(ParserRuleContext *localctx, size_t ruleIndex) {
+  if (ruleIndex >= _releasedRules.size() || !_releasedRules[ruleIndex]) {
+    return;
+  }
+
+  // The context was created just before the rule was entered, and everything created until the
+  // rule is exited belongs to its subtree. For left recursive rules that is the first context.
+  size_t count = _tracker.size();
+  _releaseStarts.push_back(count > 0 && _tracker.get(count - 1) == localctx ? count - 1 : INVALID_INDEX);
+}
+
+void Parser::exitReleasedRule(ParserRuleContext *ctx) {
+  size_t ruleIndex = ctx->getRuleIndex();
+  if (ruleIndex >= _releasedRules.size() || !_releasedRules[ruleIndex] || _releaseStarts.empty()) {
+    return;
+  }
+  size_t begin = _releaseStarts.back();
+  _releaseStarts.pop_back();
+  if (begin == INVALID_INDEX || ctx->parent == nullptr) {
+    return;
+  }
+
+  if (_subtreeHandler) {
+    _subtreeHandler(ctx);
+  }
+  ParserRuleContext *parent = downCast<ParserRuleContext*>(ctx->parent);
+  if (!parent->children.empty() && parent->children.back() == ctx) {
+    parent->removeLastChild();
+  }
+
+  // Delete the subtree released before. It lies either before this one, or inside it if nested.
+  size_t released = _releasedEnd - _releasedBegin;
+  if (released > 0) {
+    _tracker.destroy(_releasedBegin, _releasedEnd);
+    if (_releasedEnd <= begin) {
+      begin -= released;
+    }
+    for (size_t &start : _releaseStarts) {
+      if (start != INVALID_INDEX && start >= _releasedEnd) {
+        start -= released;
+      }
+    }
+  }
+  _releasedBegin = begin;
+  _releasedEnd = _tracker.size();
+}
+
 void Parser::InitializeInstanceFields() {
   _errHandler = std::make_shared<DefaultErrorStrategy>();
   _precedenceStack.clear();
@@ -666,5 +796,9 @@ void Parser::InitializeInstanceFields() {
   _input = nullptr;
   _tracer = nullptr;
   _ctx = nullptr;
+  _incrementalParse = nullptr;
+  _flatTree = nullptr;
+  _releasedBegin = 0;
+  _releasedEnd = 0;
 }
 
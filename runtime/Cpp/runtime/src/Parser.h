@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "Recognizer.h"
 #include "tree/ParseTreeListener.h"
 #include "tree/ParseTree.h"
@@ -377,6 +379,37 @@ namespace antlr4 {
 
     tree::ParseTreeTracker& getTreeTracker() { return _tracker; }
 
+    /// Called by generated parsers upon entry to a rule without arguments, before the rule context is
+    /// created. Returns a context of the previous parse tree to use instead of parsing the rule, already
+    /// added to the current context, if an <seealso cref="IncrementalParse"/> drives this parser.
+    /// Otherwise returns null. Inline, as it runs on every rule entry: without an IncrementalParse it
+    /// costs a single comparison.
+    ParserRuleContext* reuseRuleContext(size_t ruleIndex) {
+      return _incrementalParse != nullptr ? reuseIncrementalContext(ruleIndex) : nullptr;
+    }
+
+    /// Record the following parses in {@code tree}, in addition to or instead of (see
+    /// <seealso cref="#setBuildParseTree"/>) building a ParserRuleContext tree. The tree is not owned,
+    /// null stops recording.
+    void setFlatParseTree(tree::FlatParseTree *tree);
+
+    tree::FlatParseTree* getFlatParseTree() const;
+
+    using SubtreeHandler = std::function<void (ParserRuleContext *tree)>;
+
+    /// Hand every completed context of the rules in {@code ruleIndexes} to {@code handler}, after the
+    /// exit events of the parse listeners, and then delete it with its subtree. The context is removed
+    /// from the children of its parent, so the memory of a parse grows with the largest of these
+    /// subtrees instead of with the input, e.g. for a file of statements. The start rule is never
+    /// released.
+    ///
+    /// A released subtree is only deleted when the next one is released or the parser is reset, so
+    /// the context returned by the rule function and labels set to it stay valid until then. The
+    /// contexts of the rules given must be created by the tree tracker. Released subtrees nested in
+    /// each other are handed over innermost first. Set this before a parse and not together with
+    /// <seealso cref="IncrementalParse"/>; an empty {@code ruleIndexes} switches it off.
+    void setSubtreeHandler(const std::vector<size_t> &ruleIndexes, SubtreeHandler handler);
+
     /** How to create a token leaf node associated with a parent.
      *  Typically, the terminal node to create is not a function of the parent
      *  but this method must still set the parent pointer of the terminal node
@@ -448,6 +481,8 @@ namespace antlr4 {
     tree::ParseTreeTracker _tracker;
 
   private:
+    friend class IncrementalParse;
+
     /// When setTrace(true) is called, a reference to the
     /// TraceListener is stored here so it can be easily removed in a
     /// later call to setTrace(false). The listener itself is
@@ -455,6 +490,26 @@ namespace antlr4 {
     /// other parser methods.
     TraceListener *_tracer;
 
+    IncrementalParse *_incrementalParse;
+    tree::FlatParseTree *_flatTree;
+
+    ParserRuleContext* reuseIncrementalContext(size_t ruleIndex);
+
+    /// For every rule index, if its subtrees are released. Empty if none are.
+    std::vector<bool> _releasedRules;
+    SubtreeHandler _subtreeHandler;
+
+    /// The tracker indexes of the first instances of the released rules currently entered, or
+    /// INVALID_INDEX for a context the tracker did not create.
+    std::vector<size_t> _releaseStarts;
+
+    /// The tracker indexes of the last subtree released, which is deleted with the next one.
+    size_t _releasedBegin;
+    size_t _releasedEnd;
+
+    void enterReleasedRule(ParserRuleContext *localctx, size_t ruleIndex);
+    void exitReleasedRule(ParserRuleContext *ctx);
+
     void InitializeInstanceFields();
   };
 
@@ -24,6 +24,7 @@
 #include "InputMismatchException.h"
 #include "CommonToken.h"
 #include "tree/ErrorNode.h"
+#include "tree/FlatParseTree.h"
 
 #include "support/CPPUtils.h"
 #include "support/Casts.h"
@@ -188,6 +189,11 @@ void ParserInterpreter::visitState(atn::ATNState *p) {
     {
       atn::RuleStartState *ruleStartState = static_cast<atn::RuleStartState*>(transition->target);
       size_t ruleIndex = ruleStartState->ruleIndex;
+      if (!ruleStartState->isLeftRecursiveRule && reuseRuleContext(ruleIndex) != nullptr) {
+        // A subtree of a previous parse takes the place of the rule invocation.
+        setState(static_cast<const atn::RuleTransition*>(transition)->followState->stateNumber);
+        return;
+      }
       InterpreterRuleContext *newctx = createInterpreterRuleContext(_ctx, p->stateNumber, ruleIndex);
       if (ruleStartState->isLeftRecursiveRule) {
         enterRecursionRule(newctx, ruleStartState->stateNumber, ruleIndex, static_cast<const atn::RuleTransition*>(transition)->precedence);
@@ -278,6 +284,9 @@ void ParserInterpreter::recover(RecognitionException &e) {
         expectedTokenType, tok->getText(), Token::DEFAULT_CHANNEL, INVALID_INDEX, INVALID_INDEX, // invalid start/stop
         tok->getLine(), tok->getCharPositionInLine());
       _ctx->addChild(createErrorNode(_errorToken.get()));
+      if (getFlatParseTree() != nullptr) {
+        getFlatParseTree()->addMissingToken(expectedTokenType);
+      }
     }
     else { // NoViableAlt
       Token *tok = e.getOffendingToken();
@@ -285,6 +294,9 @@ void ParserInterpreter::recover(RecognitionException &e) {
         Token::INVALID_TYPE, tok->getText(), Token::DEFAULT_CHANNEL, INVALID_INDEX, INVALID_INDEX, // invalid start/stop
         tok->getLine(), tok->getCharPositionInLine());
       _ctx->addChild(createErrorNode(_errorToken.get()));
+      if (getFlatParseTree() != nullptr) {
+        getFlatParseTree()->addMissingToken(Token::INVALID_TYPE);
+      }
     }
   }
 }
@@ -154,7 +154,8 @@ namespace antlr4 {
     /** Provide simple "factory" for InterpreterRuleContext's.
      *  @since 4.5.1
      */
-    InterpreterRuleContext* createInterpreterRuleContext(ParserRuleContext *parent, size_t invokingStateNumber, size_t ruleIndex);
+    virtual InterpreterRuleContext* createInterpreterRuleContext(ParserRuleContext *parent, size_t invokingStateNumber,
+                                                                 size_t ruleIndex);
 
     virtual void visitRuleStopState(atn::ATNState *p);
 
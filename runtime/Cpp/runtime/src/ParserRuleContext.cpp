@@ -50,9 +50,14 @@ void ParserRuleContext::copyFrom(ParserRuleContext *ctx) {
     ctx->children.erase(std::remove_if(ctx->children.begin(), ctx->children.end(), [this](tree::ParseTree *e) -> bool {
       return std::find(children.begin(), children.end(), e) != children.end();
     }), ctx->children.end());
+    ctx->_ruleContextIndex.reset();
+    _ruleContextIndex.reset();
   }
 }
 
+void ParserRuleContext::rebindTokens(const std::function<Token *(Token *)> & /*map*/) {
+}
+
 void ParserRuleContext::enterRule(tree::ParseTreeListener * /*listener*/) {
 }
 
@@ -62,17 +67,20 @@ void ParserRuleContext::exitRule(tree::ParseTreeListener * /*listener*/) {
 tree::TerminalNode* ParserRuleContext::addChild(tree::TerminalNode *t) {
   t->setParent(this);
   children.push_back(t);
+  _ruleContextIndex.reset();
   return t;
 }
 
 RuleContext* ParserRuleContext::addChild(RuleContext *ruleInvocation) {
   children.push_back(ruleInvocation);
+  _ruleContextIndex.reset();
   return ruleInvocation;
 }
 
 void ParserRuleContext::removeLastChild() {
   if (!children.empty()) {
     children.pop_back();
+    _ruleContextIndex.reset();
   }
 }
 
@@ -109,6 +117,33 @@ std::vector<tree::TerminalNode *> ParserRuleContext::getTokens(size_t ttype) con
   return tokens;
 }
 
+void ParserRuleContext::indexRuleContexts() {
+  if (_ruleContextIndex == nullptr) {
+    _ruleContextIndex = std::make_unique<RuleContextIndex>();
+  }
+  std::vector<RuleContextIndex::Entry> &entries = _ruleContextIndex->entries;
+  entries.clear();
+  for (size_t i = 0; i < children.size(); ++i) {
+    if (RuleContext::is(children[i])) {
+      size_t ruleIndex = static_cast<RuleContext *>(children[i])->getContextRuleIndex();
+      if (ruleIndex != INVALID_INDEX) {
+        entries.push_back({ static_cast<uint32_t>(ruleIndex), static_cast<uint32_t>(i) });
+      }
+    }
+  }
+  std::stable_sort(entries.begin(), entries.end(), [](const RuleContextIndex::Entry &a, const RuleContextIndex::Entry &b) {
+    return a.ruleIndex < b.ruleIndex;
+  });
+  _ruleContextIndex->childCount = children.size();
+}
+
+std::pair<const ParserRuleContext::RuleContextIndex::Entry*, const ParserRuleContext::RuleContextIndex::Entry*>
+ParserRuleContext::RuleContextIndex::find(size_t ruleIndex) const {
+  auto range = std::equal_range(entries.begin(), entries.end(), Entry{ static_cast<uint32_t>(ruleIndex), 0 },
+    [](const Entry &a, const Entry &b) { return a.ruleIndex < b.ruleIndex; });
+  return { entries.data() + (range.first - entries.begin()), entries.data() + (range.second - entries.begin()) };
+}
+
 misc::Interval ParserRuleContext::getSourceInterval() {
   if (start == nullptr) {
     return misc::Interval::INVALID;
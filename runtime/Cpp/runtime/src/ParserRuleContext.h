@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "RuleContext.h"
 #include "support/CPPUtils.h"
 
@@ -74,6 +76,12 @@ namespace antlr4 {
      */
     virtual void copyFrom(ParserRuleContext *ctx);
 
+    /// Replace every token held in a token label of this context by {@code map(token)}. Generated
+    /// contexts with token labels override this; <seealso cref="IncrementalParse"/> calls it when it
+    /// takes a context over into a parse of new tokens. {@code start}, {@code stop} and the children
+    /// are not touched.
+    virtual void rebindTokens(const std::function<Token *(Token *)> &map);
+
 
     // Double dispatch methods for listeners
 
@@ -93,15 +101,40 @@ namespace antlr4 {
 
     std::vector<tree::TerminalNode*> getTokens(size_t ttype) const;
 
+    /// Generated context classes declare themselves as their ContextClass, with their
+    /// CONTEXT_RULE_INDEX and CONTEXT_ALT_LABEL, so children of those are found by comparing the type
+    /// tags of the children (see <seealso cref="RuleContext#getContextRuleIndex"/>) instead of with
+    /// dynamic_cast. This assumes that the children of a context all come from the same parser.
     template<typename T>
     T* getRuleContext(size_t i) const {
       static_assert(std::is_base_of_v<RuleContext, T>, "T must be derived from RuleContext");
-      size_t j = 0; // what element have we found with ctxType?
-      for (auto *child : children) {
-        if (RuleContext::is(child)) {
-          if (auto *typedChild = dynamic_cast<T*>(child); typedChild != nullptr) {
-            if (j++ == i) {
-              return typedChild;
+      if constexpr (HasContextType<T>::value) {
+        if constexpr (T::CONTEXT_ALT_LABEL == 0) {
+          if (const RuleContextIndex *index = getRuleContextIndex(); index != nullptr) {
+            auto [begin, end] = index->find(T::CONTEXT_RULE_INDEX);
+            if (i >= static_cast<size_t>(end - begin)) {
+              return nullptr;
+            }
+            if (tree::ParseTree *child = children[begin[i].child]; isContextOf<T>(child)) {
+              return static_cast<T*>(child);
+            }
+            // The children were changed in place, see indexRuleContexts().
+          }
+        }
+        size_t j = 0;
+        for (auto *child : children) {
+          if (isContextOf<T>(child) && j++ == i) {
+            return static_cast<T*>(child);
+          }
+        }
+      } else {
+        size_t j = 0; // what element have we found with ctxType?
+        for (auto *child : children) {
+          if (RuleContext::is(child)) {
+            if (auto *typedChild = dynamic_cast<T*>(child); typedChild != nullptr) {
+              if (j++ == i) {
+                return typedChild;
+              }
             }
           }
         }
@@ -113,16 +146,48 @@ namespace antlr4 {
     std::vector<T*> getRuleContexts() const {
       static_assert(std::is_base_of_v<RuleContext, T>, "T must be derived from RuleContext");
       std::vector<T*> contexts;
-      for (auto *child : children) {
-        if (RuleContext::is(child)) {
-          if (auto *typedChild = dynamic_cast<T*>(child); typedChild != nullptr) {
-            contexts.push_back(typedChild);
+      if constexpr (HasContextType<T>::value) {
+        if constexpr (T::CONTEXT_ALT_LABEL == 0) {
+          if (const RuleContextIndex *index = getRuleContextIndex(); index != nullptr) {
+            auto [begin, end] = index->find(T::CONTEXT_RULE_INDEX);
+            contexts.reserve(static_cast<size_t>(end - begin));
+            for (auto entry = begin; entry != end && isContextOf<T>(children[entry->child]); ++entry) {
+              contexts.push_back(static_cast<T*>(children[entry->child]));
+            }
+            if (contexts.size() == static_cast<size_t>(end - begin)) {
+              return contexts;
+            }
+            contexts.clear(); // The children were changed in place, see indexRuleContexts().
+          }
+        }
+        for (auto *child : children) {
+          if (isContextOf<T>(child)) {
+            contexts.push_back(static_cast<T*>(child));
+          }
+        }
+      } else {
+        for (auto *child : children) {
+          if (RuleContext::is(child)) {
+            if (auto *typedChild = dynamic_cast<T*>(child); typedChild != nullptr) {
+              contexts.push_back(typedChild);
+            }
           }
         }
       }
       return contexts;
     }
 
+    /// The number of children from which on the parser indexes the rule contexts among them by their
+    /// context rule index when the rule is exited.
+    static constexpr size_t RULE_CONTEXT_INDEX_THRESHOLD = 16;
+
+    /// Index the rule contexts among the children by their context rule index, so that
+    /// getRuleContext() finds the i-th of a rule in logarithmic time. The index is dropped when
+    /// children are added or removed through this class. Code which changes {@code children} directly
+    /// should call this again: lookups only check the type tag of the children they return, and fall
+    /// back to a scan if it does not match, so other changes can go unnoticed.
+    void indexRuleContexts();
+
     virtual misc::Interval getSourceInterval() override;
 
     /**
@@ -142,6 +207,45 @@ namespace antlr4 {
     /// <summary>
     /// Used for rule context info debugging during parse-time, not so much for ATN debugging </summary>
     virtual std::string toInfoString(Parser *recognizer);
+
+  private:
+    template<typename T, typename = void>
+    struct HasContextType : std::false_type {};
+
+    // Classes derived from a generated context inherit its type tag, but not its ContextClass.
+    template<typename T>
+    struct HasContextType<T, std::void_t<typename T::ContextClass>> : std::is_same<typename T::ContextClass, T> {};
+
+    /// The rule context children sorted by their context rule index and position.
+    struct RuleContextIndex {
+      struct Entry {
+        uint32_t ruleIndex;
+        uint32_t child;
+      };
+
+      size_t childCount;
+      std::vector<Entry> entries;
+
+      std::pair<const Entry*, const Entry*> find(size_t ruleIndex) const;
+    };
+
+    std::unique_ptr<RuleContextIndex> _ruleContextIndex;
+
+    template<typename T>
+    static bool isContextOf(const tree::ParseTree *child) {
+      if (!RuleContext::is(child)) {
+        return false;
+      }
+      const RuleContext *ctx = static_cast<const RuleContext *>(child);
+      return ctx->getContextRuleIndex() == T::CONTEXT_RULE_INDEX &&
+        (T::CONTEXT_ALT_LABEL == 0 || ctx->getContextAltLabel() == T::CONTEXT_ALT_LABEL);
+    }
+
+    /// The index, if it is still valid.
+    const RuleContextIndex* getRuleContextIndex() const {
+      return _ruleContextIndex != nullptr && _ruleContextIndex->childCount == children.size() ?
+        _ruleContextIndex.get() : nullptr;
+    }
   };
 
 } // namespace antlr4
@@ -23,6 +23,10 @@ void ProxyErrorListener::removeErrorListeners() {
   _delegates.clear();
 }
 
+const std::set<ANTLRErrorListener *>& ProxyErrorListener::getErrorListeners() const {
+  return _delegates;
+}
+
 void ProxyErrorListener::syntaxError(Recognizer *recognizer, Token *offendingSymbol, size_t line,
   size_t charPositionInLine, const std::string &msg, std::exception_ptr e) {
 
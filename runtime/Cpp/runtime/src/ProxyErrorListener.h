@@ -21,6 +21,7 @@ namespace antlr4 {
     void addErrorListener(ANTLRErrorListener *listener);
     void removeErrorListener(ANTLRErrorListener *listener);
     void removeErrorListeners();
+    const std::set<ANTLRErrorListener *>& getErrorListeners() const;
 
     void syntaxError(Recognizer *recognizer, Token *offendingSymbol, size_t line, size_t charPositionInLine,
                      const std::string &msg, std::exception_ptr e) override;
@@ -0,0 +1,252 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "misc/Interval.h"
+#include "Exceptions.h"
+#include "support/Utf8.h"
+
+#include "PushCharStream.h"
+
+using namespace antlrcpp;
+using namespace antlr4;
+using namespace antlr4::misc;
+
+namespace {
+
+  // Returns the length of the sequence started by the given lead byte, or 1 for anything which cannot start one.
+  size_t sequenceLength(unsigned char lead) {
+    if ((lead & 0xE0) == 0xC0) {
+      return 2;
+    }
+    if ((lead & 0xF0) == 0xE0) {
+      return 3;
+    }
+    if ((lead & 0xF8) == 0xF0) {
+      return 4;
+    }
+    return 1;
+  }
+
+  // Returns the number of complete bytes in the given input, that is, excluding a trailing incomplete sequence.
+  size_t completeLength(std::string_view bytes) {
+    size_t length = bytes.size();
+    for (size_t k = 1; k <= 4 && k <= length; ++k) {
+      unsigned char c = static_cast<unsigned char>(bytes[length - k]);
+      if ((c & 0xC0) != 0x80) {
+        return sequenceLength(c) > k ? length - k : length;
+      }
+    }
+    return length;
+  }
+
+}
+
+PushCharStream::PushCharStream(bool lenient)
+  : _p(0), _bufferStart(0), _numMarkers(0), _lastCharBufferStart(0), _closed(false), _lenient(lenient),
+    _atStart(true) {
+}
+
+void PushCharStream::append(std::string_view chunk) {
+  if (_closed) {
+    throw IllegalStateException("cannot append to a closed stream");
+  }
+
+  if (!_pending.empty()) {
+    _pending.append(chunk);
+    std::string bytes = std::move(_pending);
+    _pending.clear();
+    decode(bytes);
+  } else {
+    decode(chunk);
+  }
+}
+
+void PushCharStream::append(std::u32string_view chunk) {
+  if (_closed) {
+    throw IllegalStateException("cannot append to a closed stream");
+  }
+  if (!_pending.empty()) {
+    throw IllegalArgumentException("UTF-8 input ends with an incomplete byte sequence");
+  }
+
+  compact();
+  _data.append(chunk);
+  _atStart = false;
+}
+
+void PushCharStream::close() {
+  if (_closed) {
+    return;
+  }
+
+  if (!_pending.empty()) {
+    if (!_lenient) {
+      throw IllegalArgumentException("UTF-8 input ends with an incomplete byte sequence");
+    }
+    _data.append(Utf8::lenientDecode(_pending));
+    _pending.clear();
+  }
+  _closed = true;
+}
+
+bool PushCharStream::isClosed() const {
+  return _closed;
+}
+
+size_t PushCharStream::available() const {
+  return _data.size() - _p;
+}
+
+std::u32string_view PushCharStream::getCodePoints() const {
+  return _data;
+}
+
+size_t PushCharStream::getBufferStartIndex() const {
+  return _bufferStart;
+}
+
+void PushCharStream::decode(std::string_view bytes) {
+  if (_atStart) {
+    // Remove the UTF-8 BOM if present. A BOM split over chunks ends up in _pending (0xEF starts a 3 byte sequence).
+    if (bytes.size() < 3 && completeLength(bytes) == 0) {
+      _pending = bytes;
+      return;
+    }
+    if (bytes.substr(0, 3) == "\xef\xbb\xbf") {
+      bytes.remove_prefix(3);
+    }
+    _atStart = false;
+  }
+
+  size_t length = completeLength(bytes);
+  _pending = bytes.substr(length);
+  bytes = bytes.substr(0, length);
+
+  compact();
+  if (_lenient) {
+    _data.append(Utf8::lenientDecode(bytes));
+  } else {
+    auto maybeUtf32 = Utf8::strictDecode(bytes);
+    if (!maybeUtf32.has_value()) {
+      throw IllegalArgumentException("UTF-8 string contains an illegal byte sequence");
+    }
+    _data.append(maybeUtf32.value());
+  }
+}
+
+void PushCharStream::compact() {
+  // Dropping the consumed part on every release would make lexing quadratic in the chunk size,
+  // so wait until at least half of the buffer is garbage.
+  if (_numMarkers > 0 || _p == 0 || _p < _data.size() / 2) {
+    return;
+  }
+
+  _lastCharBufferStart = _data[_p - 1];
+  _data.erase(0, _p);
+  _bufferStart += _p;
+  _p = 0;
+}
+
+void PushCharStream::consume() {
+  if (_p >= _data.size()) {
+    if (_closed) {
+      throw IllegalStateException("cannot consume EOF");
+    }
+    throw IllegalStateException("cannot consume past the end of the available input");
+  }
+
+  ++_p;
+}
+
+size_t PushCharStream::LA(ssize_t i) {
+  if (i == 0) {
+    return 0; // undefined
+  }
+
+  ssize_t position = static_cast<ssize_t>(_p) + (i > 0 ? i - 1 : i);
+  if (position < 0) {
+    if (position == -1) {
+      return _lastCharBufferStart;
+    }
+    throw IndexOutOfBoundsException();
+  }
+
+  if (static_cast<size_t>(position) >= _data.size()) {
+    return _closed ? EOF : STARVED;
+  }
+
+  return _data[static_cast<size_t>(position)];
+}
+
+ssize_t PushCharStream::mark() {
+  ++_numMarkers;
+  return -static_cast<ssize_t>(_numMarkers);
+}
+
+void PushCharStream::release(ssize_t /*marker*/) {
+  // The lexer keeps the start marker of a suspended token across calls, so markers need not be
+  // released in the order they were created.
+  if (_numMarkers == 0) {
+    throw IllegalStateException("release() called with an invalid marker.");
+  }
+
+  --_numMarkers;
+  compact();
+}
+
+size_t PushCharStream::index() {
+  return _bufferStart + _p;
+}
+
+void PushCharStream::seek(size_t index) {
+  if (index < _bufferStart || index > _bufferStart + _data.size()) {
+    throw UnsupportedOperationException("Seek to index outside buffer: " + std::to_string(index) +
+                                        " not in " + std::to_string(_bufferStart) + ".." +
+                                        std::to_string(_bufferStart + _data.size()));
+  }
+
+  _p = index - _bufferStart;
+}
+
+size_t PushCharStream::size() {
+  if (!_closed) {
+    throw UnsupportedOperationException("Push stream cannot know its size before it is closed");
+  }
+  return _bufferStart + _data.size();
+}
+
+std::string PushCharStream::getSourceName() const {
+  if (name.empty()) {
+    return UNKNOWN_SOURCE_NAME;
+  }
+
+  return name;
+}
+
+std::string PushCharStream::getText(const misc::Interval &interval) {
+  if (interval.a < 0 || interval.b < interval.a - 1) {
+    throw IllegalArgumentException("invalid interval");
+  }
+
+  size_t start = static_cast<size_t>(interval.a);
+  size_t stop = std::min(static_cast<size_t>(interval.b + 1), _bufferStart + _data.size());
+  if (start < _bufferStart) {
+    throw UnsupportedOperationException("interval " + interval.toString() + " outside buffer: " +
+      std::to_string(_bufferStart) + ".." + std::to_string(_bufferStart + _data.size() - 1));
+  }
+  if (start >= stop) {
+    return "";
+  }
+
+  auto maybeUtf8 = Utf8::strictEncode(std::u32string_view(_data).substr(start - _bufferStart, stop - start));
+  if (!maybeUtf8.has_value()) {
+    throw IllegalArgumentException("Push stream contains invalid Unicode code points");
+  }
+  return std::move(maybeUtf8).value();
+}
+
+std::string PushCharStream::toString() const {
+  throw UnsupportedOperationException("Push stream cannot be materialized to a string");
+}
@@ -0,0 +1,107 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <string_view>
+
+#include "CharStream.h"
+
+namespace antlr4 {
+
+  /// A char stream which is fed by the application in chunks of UTF-8 encoded bytes, e.g. as they
+  /// arrive from the network, instead of pulling its input from a source.
+  ///
+  /// Looking ahead past the characters appended so far returns <seealso cref="#STARVED"/> instead of
+  /// blocking or reporting EOF, which makes the lexer suspend the current token (see
+  /// <seealso cref="Lexer#isSuspended"/>). Only after <seealso cref="#close"/> was called the stream
+  /// reports EOF at its end. Chunk boundaries may split multi-byte UTF-8 sequences.
+  ///
+  /// Like <seealso cref="UnbufferedCharStream"/> this stream uses absolute character indexes and drops
+  /// consumed characters when no marker is active, so only the text of tokens not yet emitted is kept
+  /// in memory. As with that stream, tokens must copy their text (e.g. by using a
+  /// <seealso cref="CommonTokenFactory"/> created with {@code copyText = true}) if it is needed
+  /// after the token was emitted.
+  class ANTLR4CPP_PUBLIC PushCharStream : public CharStream {
+  public:
+    /// Returned by LA() for a position which is not yet available but might be after more input
+    /// was appended. Never a valid code point.
+    static constexpr size_t STARVED = std::numeric_limits<size_t>::max() - 1;
+
+    /// The name or source of this char stream.
+    std::string name;
+
+    /// If {@code lenient} is true, invalid UTF-8 sequences are replaced by U+FFFD instead of throwing
+    /// an IllegalArgumentException.
+    explicit PushCharStream(bool lenient = false);
+
+    /// Append the next chunk of UTF-8 encoded input. A UTF-8 BOM at the very start of the input is removed.
+    virtual void append(std::string_view chunk);
+
+    /// Append already decoded code points.
+    virtual void append(std::u32string_view chunk);
+
+    /// Signal that no more input follows. From now on the end of the stream is reported as EOF.
+    virtual void close();
+
+    bool isClosed() const;
+
+    /// The number of characters appended but not yet consumed.
+    size_t available() const;
+
+    void consume() override;
+    size_t LA(ssize_t i) override;
+
+    /// Return a marker that we can release later. As long as any marker exists no characters are dropped.
+    ssize_t mark() override;
+    void release(ssize_t marker) override;
+    size_t index() override;
+
+    /// Seek to an absolute character index, which must be within the buffered window.
+    void seek(size_t index) override;
+
+    /// The number of characters in the stream. Only known after the stream was closed.
+    size_t size() override;
+    std::string getSourceName() const override;
+    std::string getText(const misc::Interval &interval) override;
+
+    std::string toString() const override;
+
+    /// The buffered characters, starting at getBufferStartIndex(), for lexers which read them directly.
+    /// Valid until input is appended or consumed characters are dropped.
+    std::u32string_view getCodePoints() const;
+
+    /// The absolute character index of the first buffered character.
+    size_t getBufferStartIndex() const;
+
+  protected:
+    /// The buffered window of the input, UTF-32 encoded.
+    std::u32string _data;
+
+    /// Index into _data of the LA(1) character.
+    size_t _p;
+
+    /// Absolute character index of _data[0].
+    size_t _bufferStart;
+
+    size_t _numMarkers;
+
+    /// The LA(-1) character for _data[0].
+    size_t _lastCharBufferStart;
+
+    /// Trailing bytes of the last chunk which form an incomplete UTF-8 sequence.
+    std::string _pending;
+
+    bool _closed;
+    bool _lenient;
+    bool _atStart;
+
+    void decode(std::string_view bytes);
+
+    /// Drop consumed characters if no marker is active and doing so pays off.
+    void compact();
+  };
+
+} // namespace antlr4
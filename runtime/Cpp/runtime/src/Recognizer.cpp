@@ -3,7 +3,9 @@
  * can be found in the LICENSE.txt file in the project root.
  */
 
+#include "CancellationToken.h"
 #include "ConsoleErrorListener.h"
+#include "Exceptions.h"
 #include "RecognitionException.h"
 #include "support/CPPUtils.h"
 #include "Token.h"
@@ -150,8 +152,31 @@ bool Recognizer::precpred(RuleContext * /*localctx*/, int /*precedence*/) {
 void Recognizer::action(RuleContext * /*localctx*/, size_t /*ruleIndex*/, size_t /*actionIndex*/) {
 }
 
+void Recognizer::setCancellationToken(const CancellationToken *token) {
+  _cancellationToken = token;
+  _cancellationPolls = 0;
+}
+
+const CancellationToken* Recognizer::getCancellationToken() const {
+  return _cancellationToken;
+}
+
+void Recognizer::pollCancellationToken() {
+  if (_cancellationToken->isCancelled()) {
+    throw OperationCancelledException("operation cancelled");
+  }
+  if (++_cancellationPolls == CANCELLATION_CLOCK_INTERVAL) {
+    _cancellationPolls = 0;
+    if (_cancellationToken->isDeadlineExceeded()) {
+      throw DeadlineExceededException("deadline exceeded");
+    }
+  }
+}
+
 void Recognizer::InitializeInstanceFields() {
   _stateNumber = ATNState::INVALID_STATE_NUMBER;
   _interpreter = nullptr;
+  _cancellationToken = nullptr;
+  _cancellationPolls = 0;
 }
 
@@ -139,6 +139,22 @@ namespace antlr4 {
     template<typename T1>
     void setTokenFactory(TokenFactory<T1> *input);
 
+    /// Let this recognizer be stopped through {@code token}, or not when it is null. The token is not
+    /// owned and must outlive its use by the recognizer.
+    void setCancellationToken(const CancellationToken *token);
+
+    const CancellationToken* getCancellationToken() const;
+
+    /// Throws if the cancellation token fired. Called at bounded intervals while lexing or predicting.
+    /// The cancelled flag is read on every call, the clock only on every CANCELLATION_CLOCK_INTERVAL-th.
+    void checkCancellation() {
+      if (_cancellationToken != nullptr) {
+        pollCancellationToken();
+      }
+    }
+
+    static constexpr size_t CANCELLATION_CLOCK_INTERVAL = 64;
+
   protected:
     atn::ATNSimulator *_interpreter; // Set and deleted in descendants (or the profiler).
 
@@ -153,6 +169,11 @@ namespace antlr4 {
 
     size_t _stateNumber;
 
+    const CancellationToken *_cancellationToken;
+    size_t _cancellationPolls;
+
+    void pollCancellationToken();
+
     void InitializeInstanceFields();
 
   };
@@ -0,0 +1,144 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "BufferedTokenStream.h"
+#include "Exceptions.h"
+#include "Parser.h"
+#include "PushCharStream.h"
+#include "TokenSource.h"
+
+#include "ResumableParse.h"
+
+using namespace antlr4;
+
+//------------------ ReplayFilter --------------------------------------------------------------------------------------
+
+bool ResumableParse::ReplayFilter::isNew() {
+  if (++notifications <= delivered) {
+    return false;
+  }
+  delivered = notifications;
+  return true;
+}
+
+void ResumableParse::ReplayFilter::syntaxError(Recognizer *recognizer, Token *offendingSymbol, size_t line,
+  size_t charPositionInLine, const std::string &msg, std::exception_ptr e) {
+  if (isNew()) {
+    ProxyErrorListener::syntaxError(recognizer, offendingSymbol, line, charPositionInLine, msg, e);
+  }
+}
+
+void ResumableParse::ReplayFilter::reportAmbiguity(Parser *recognizer, const dfa::DFA &dfa, size_t startIndex,
+  size_t stopIndex, bool exact, const antlrcpp::BitSet &ambigAlts, atn::ATNConfigSet *configs) {
+  if (isNew()) {
+    ProxyErrorListener::reportAmbiguity(recognizer, dfa, startIndex, stopIndex, exact, ambigAlts, configs);
+  }
+}
+
+void ResumableParse::ReplayFilter::reportAttemptingFullContext(Parser *recognizer, const dfa::DFA &dfa,
+  size_t startIndex, size_t stopIndex, const antlrcpp::BitSet &conflictingAlts, atn::ATNConfigSet *configs) {
+  if (isNew()) {
+    ProxyErrorListener::reportAttemptingFullContext(recognizer, dfa, startIndex, stopIndex, conflictingAlts, configs);
+  }
+}
+
+void ResumableParse::ReplayFilter::reportContextSensitivity(Parser *recognizer, const dfa::DFA &dfa,
+  size_t startIndex, size_t stopIndex, size_t prediction, atn::ATNConfigSet *configs) {
+  if (isNew()) {
+    ProxyErrorListener::reportContextSensitivity(recognizer, dfa, startIndex, stopIndex, prediction, configs);
+  }
+}
+
+//------------------ ResumableParse ------------------------------------------------------------------------------------
+
+ResumableParse::ResumableParse(Parser &parser, std::function<ParserRuleContext *()> startRule)
+  : _parser(parser), _startRule(std::move(startRule)), _result(nullptr), _attempts(0), _nextAttempt(1) {
+  _tokens = dynamic_cast<BufferedTokenStream *>(parser.getTokenStream());
+  if (_tokens == nullptr) {
+    throw IllegalArgumentException("a resumable parse requires a buffered token stream");
+  }
+
+  _parserListeners = _parser.getErrorListenerDispatch().getErrorListeners();
+  for (ANTLRErrorListener *listener : _parserListeners) {
+    _filter.addErrorListener(listener);
+  }
+  _parser.removeErrorListeners();
+  _parser.addErrorListener(&_filter);
+}
+
+ResumableParse::~ResumableParse() {
+  _parser.removeErrorListener(&_filter);
+  for (ANTLRErrorListener *listener : _parserListeners) {
+    _parser.addErrorListener(listener);
+  }
+}
+
+ResumableParse::Status ResumableParse::feed(std::string_view chunk) {
+  getPushCharStream()->append(chunk);
+  return resume();
+}
+
+ResumableParse::Status ResumableParse::finish() {
+  getPushCharStream()->close();
+  return resume();
+}
+
+ResumableParse::Status ResumableParse::resume() {
+  if (_result != nullptr) {
+    return Status::COMPLETED;
+  }
+
+  bool complete = true;
+  try {
+    _tokens->fill();
+  } catch (InputStarvedException & /*e*/) {
+    complete = false;
+  }
+
+  // Restarting on every new token would make the parse quadratic.
+  if (!complete && _tokens->size() < _nextAttempt) {
+    return Status::SUSPENDED;
+  }
+
+  _filter.notifications = 0;
+  ++_attempts;
+  try {
+    _parser.reset();
+    _result = _startRule();
+  } catch (InputStarvedException & /*e*/) {
+    _nextAttempt = 2 * _tokens->size();
+    return Status::SUSPENDED;
+  }
+
+  return Status::COMPLETED;
+}
+
+ParserRuleContext* ResumableParse::getResult() const {
+  return _result;
+}
+
+size_t ResumableParse::getAttemptCount() const {
+  return _attempts;
+}
+
+void ResumableParse::addErrorListener(ANTLRErrorListener *listener) {
+  _filter.addErrorListener(listener);
+}
+
+void ResumableParse::removeErrorListener(ANTLRErrorListener *listener) {
+  _filter.removeErrorListener(listener);
+}
+
+void ResumableParse::removeErrorListeners() {
+  _filter.removeErrorListeners();
+}
+
+PushCharStream* ResumableParse::getPushCharStream() {
+  PushCharStream *stream = dynamic_cast<PushCharStream *>(_tokens->getTokenSource()->getInputStream());
+  if (stream == nullptr) {
+    throw UnsupportedOperationException("the token source does not read from a PushCharStream");
+  }
+  return stream;
+}
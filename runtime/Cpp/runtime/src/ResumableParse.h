@@ -0,0 +1,133 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string_view>
+
+#include "ProxyErrorListener.h"
+
+namespace antlr4 {
+
+  /// Drives a parse over input which arrives incrementally (see <seealso cref="PushCharStream"/>),
+  /// without blocking the calling thread while input is missing. A single thread can so interleave
+  /// any number of parses, each owning its own stream, lexer, token stream and parser.
+  ///
+  /// A recursive descent parser keeps its state on the native call stack, which cannot be
+  /// suspended without coroutine support. Instead the parse is run in attempts over the tokens
+  /// buffered so far: when the parser looks ahead past the available tokens, the token stream
+  /// throws an <seealso cref="InputStarvedException"/>, which unwinds the attempt. A new attempt
+  /// is started from the first token once the number of buffered tokens has doubled (or the input
+  /// is complete). Lexing is not repeated; the lexer simply suspends in the middle of a token.
+  ///
+  /// Every attempt parses the tokens from the start again. Starting one per chunk would cost
+  /// O(n * k) for n tokens arriving in k chunks, i.e. O(n^2) when every chunk adds a token. With
+  /// the doubling there are at most log2(n) + 2 attempts, which parse at most 3n tokens in total,
+  /// whatever the chunk sizes. The price is latency: an attempt which could already complete may
+  /// wait until the buffered tokens have doubled or finish() is called.
+  ///
+  /// The decisions of the parser only depend on the tokens, so the path an attempt takes before it
+  /// runs out of tokens is repeated by later attempts, unless semantic predicates depend on state
+  /// changed by actions. Error listener notifications are therefore delivered as soon as they occur
+  /// and only once. Listeners must be registered here, not on the parser.
+  ///
+  /// Everything else the parser does is repeated by every attempt, up to log2(n) + 2 times:
+  /// - Parse listeners (Parser::addParseListener) see the events of every attempt. Walk the final
+  ///   tree instead.
+  /// - Embedded actions and the @init and @after actions of the rules run again. Actions which only
+  ///   set attributes or labels of their rule context are harmless, since every attempt builds a new
+  ///   tree. Actions which change @members fields or anything outside the parser must either be
+  ///   idempotent, be reset at the start of every attempt (e.g. in the @init action of the start
+  ///   rule), or move to a walk over the final tree.
+  ///
+  /// <code>
+  ///   PushCharStream input;
+  ///   MyLexer lexer(&input);
+  ///   CommonTokenStream tokens(&lexer);
+  ///   MyParser parser(&tokens);
+  ///   ResumableParse parse(parser, [&parser] { return parser.file(); });
+  ///   // For each chunk received:
+  ///   if (parse.feed(chunk) == ResumableParse::Status::COMPLETED) ...
+  ///   // At the end of the input:
+  ///   parse.finish();
+  ///   MyParser::FileContext *tree = static_cast<MyParser::FileContext *>(parse.getResult());
+  /// </code>
+  class ANTLR4CPP_PUBLIC ResumableParse {
+  public:
+    enum class Status {
+      SUSPENDED,
+      COMPLETED,
+    };
+
+    /// The parser's token stream must be a BufferedTokenStream (e.g. a CommonTokenStream), since
+    /// attempts are restarted from the first token. {@code startRule} invokes the start rule of
+    /// the parser. The parser's error listeners are moved to this instance, and given back to the
+    /// parser by the destructor.
+    ResumableParse(Parser &parser, std::function<ParserRuleContext *()> startRule);
+    ResumableParse(const ResumableParse &other) = delete;
+    virtual ~ResumableParse();
+
+    ResumableParse& operator = (const ResumableParse &other) = delete;
+
+    /// Append a chunk of UTF-8 input to the PushCharStream of the lexer, then resume().
+    virtual Status feed(std::string_view chunk);
+
+    /// Close the PushCharStream of the lexer, then resume(). Since the input is complete,
+    /// the parse is guaranteed to complete.
+    virtual Status finish();
+
+    /// Lex all input available so far and continue the parse, if worthwhile.
+    virtual Status resume();
+
+    /// The tree returned by the start rule, owned by the parser. Null while the parse is not completed.
+    ParserRuleContext* getResult() const;
+
+    /// The number of times the start rule was invoked so far.
+    size_t getAttemptCount() const;
+
+    /// Error listeners which receive the notifications of the parser.
+    void addErrorListener(ANTLRErrorListener *listener);
+    void removeErrorListener(ANTLRErrorListener *listener);
+    void removeErrorListeners();
+
+  protected:
+    /// Forwards the n-th notification of an attempt only if no earlier attempt got that far.
+    class ANTLR4CPP_PUBLIC ReplayFilter : public ProxyErrorListener {
+    public:
+      size_t notifications = 0;
+      size_t delivered = 0;
+
+      void syntaxError(Recognizer *recognizer, Token *offendingSymbol, size_t line, size_t charPositionInLine,
+                       const std::string &msg, std::exception_ptr e) override;
+
+      void reportAmbiguity(Parser *recognizer, const dfa::DFA &dfa, size_t startIndex, size_t stopIndex, bool exact,
+                           const antlrcpp::BitSet &ambigAlts, atn::ATNConfigSet *configs) override;
+
+      void reportAttemptingFullContext(Parser *recognizer, const dfa::DFA &dfa, size_t startIndex, size_t stopIndex,
+        const antlrcpp::BitSet &conflictingAlts, atn::ATNConfigSet *configs) override;
+
+      void reportContextSensitivity(Parser *recognizer, const dfa::DFA &dfa, size_t startIndex, size_t stopIndex,
+                                    size_t prediction, atn::ATNConfigSet *configs) override;
+
+    private:
+      bool isNew();
+    };
+
+    Parser &_parser;
+    BufferedTokenStream *_tokens;
+    std::function<ParserRuleContext *()> _startRule;
+    ReplayFilter _filter;
+    std::set<ANTLRErrorListener *> _parserListeners;
+    ParserRuleContext *_result;
+    size_t _attempts;
+
+    /// The number of buffered tokens required for the next attempt.
+    size_t _nextAttempt;
+
+    PushCharStream* getPushCharStream();
+  };
+
+} // namespace antlr4
@@ -140,5 +140,7 @@ std::string RuleContext::toString(Recognizer *recog, RuleContext *stop) {
 
 void RuleContext::InitializeInstanceFields() {
   invokingState = INVALID_INDEX;
+  _contextRuleIndex = NO_CONTEXT_TYPE;
+  _contextAltLabel = 0;
 }
 
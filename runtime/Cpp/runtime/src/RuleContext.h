@@ -86,6 +86,29 @@ namespace antlr4 {
 
     virtual size_t getRuleIndex() const;
 
+    /// The rule index of the generated context class of this context, or INVALID_INDEX if it is no
+    /// instance of a generated class, e.g. an InterpreterRuleContext. Unlike getRuleIndex() this is no
+    /// virtual call, so that children of a context class are found without a dynamic_cast.
+    size_t getContextRuleIndex() const {
+      return _contextRuleIndex == NO_CONTEXT_TYPE ? INVALID_INDEX : _contextRuleIndex;
+    }
+
+    /// The alternative label of the generated context class of this context: the number of the first
+    /// outer alternative with that label, or 0 for the context class of the rule itself.
+    size_t getContextAltLabel() const {
+      return _contextAltLabel;
+    }
+
+    /// Both type tags in one value, for switching over the generated context classes of a parser.
+    static constexpr size_t contextType(size_t ruleIndex, size_t altLabel) {
+      return ruleIndex << 16 | altLabel;
+    }
+
+    /// contextType() of the type tags of this context, or INVALID_INDEX if it has none.
+    size_t getContextType() const {
+      return _contextRuleIndex == NO_CONTEXT_TYPE ? INVALID_INDEX : contextType(_contextRuleIndex, _contextAltLabel);
+    }
+
     /** For rule associated with this parse tree internal node, return
      *  the outer alternative number used to match the input. Default
      *  implementation does not compute nor store this alt num. Create
@@ -134,7 +157,20 @@ namespace antlr4 {
 
     bool operator == (const RuleContext &other) { return this == &other; } // Simple address comparison.
 
+  protected:
+    /// Called by the constructors of generated contexts with the CONTEXT_RULE_INDEX and
+    /// CONTEXT_ALT_LABEL of their class.
+    void setContextType(size_t ruleIndex, size_t altLabel) {
+      _contextRuleIndex = static_cast<uint32_t>(ruleIndex);
+      _contextAltLabel = static_cast<uint32_t>(altLabel);
+    }
+
   private:
+    static constexpr uint32_t NO_CONTEXT_TYPE = std::numeric_limits<uint32_t>::max();
+
+    uint32_t _contextRuleIndex;
+    uint32_t _contextAltLabel;
+
     void InitializeInstanceFields();
   };
 
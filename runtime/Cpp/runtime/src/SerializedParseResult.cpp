@@ -0,0 +1,291 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "CharStream.h"
+#include "Exceptions.h"
+#include "ParserRuleContext.h"
+#include "TokenBuffer.h"
+#include "misc/Interval.h"
+#include "support/Casts.h"
+#include "tree/ErrorNode.h"
+#include "tree/TerminalNode.h"
+
+#include "SerializedParseResult.h"
+
+using namespace antlr4;
+using namespace antlr4::tree;
+
+using Kind = FlatParseTree::Kind;
+using Node = FlatParseTree::Node;
+
+namespace {
+
+  // Header words: version, ATN hash (2), source checksum (2), token count, text count, node count.
+  // They are followed by the token columns, the explicit token texts (token index, byte length and the
+  // bytes padded to full words) and the nodes (4 words each).
+  constexpr size_t HEADER_SIZE = 8;
+  constexpr size_t TOKEN_COLUMNS = TokenBuffer::COLUMN_COUNT;
+  constexpr size_t NODE_SIZE = 4;
+
+  uint64_t fnv1a(const void *data, size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+  }
+
+  uint64_t read64(const uint32_t *data) {
+    return data[0] | static_cast<uint64_t>(data[1]) << 32;
+  }
+
+  void append64(std::vector<uint32_t> &data, uint64_t value) {
+    data.push_back(static_cast<uint32_t>(value));
+    data.push_back(static_cast<uint32_t>(value >> 32));
+  }
+
+  void appendNode(std::vector<uint32_t> &data, const Node &node) {
+    data.push_back(node.value);
+    data.push_back(node.size);
+    data.push_back(node.parent);
+    data.push_back(node.altNumber | static_cast<uint32_t>(node.kind) << 16);
+  }
+
+}
+
+std::vector<uint32_t> SerializedParseResult::serialize(atn::SerializedATNView atn, const TokenBuffer &tokens,
+                                                       const FlatParseTree &tree, bool includeText) {
+  std::vector<uint32_t> data = serializeTokens(atn, tokens, includeText);
+  data.reserve(data.size() + tree.size() * NODE_SIZE);
+  for (size_t i = 0; i < tree.size(); ++i) {
+    appendNode(data, tree.getNode(i));
+  }
+  data[HEADER_SIZE - 1] = static_cast<uint32_t>(tree.size());
+  return data;
+}
+
+std::vector<uint32_t> SerializedParseResult::serialize(atn::SerializedATNView atn, const TokenBuffer &tokens,
+                                                       ParserRuleContext *tree, bool includeText) {
+  if (tree == nullptr) {
+    return serializeTokens(atn, tokens, includeText);
+  }
+
+  // The nodes in preorder. The size of a rule node is set once all of its children are added.
+  std::vector<Node> nodes;
+  struct Open {
+    ParserRuleContext *ctx;
+    uint32_t node;
+    size_t nextChild;
+  };
+  std::vector<Open> open;
+  auto addRule = [&](ParserRuleContext *ctx, uint32_t parent) {
+    if (ctx->getAltNumber() > std::numeric_limits<uint16_t>::max()) {
+      throw IllegalArgumentException("the alternative number of a rule context does not fit into a serialized parse result");
+    }
+    open.push_back({ ctx, static_cast<uint32_t>(nodes.size()), 0 });
+    nodes.push_back({ static_cast<uint32_t>(ctx->getRuleIndex()), 1, parent,
+                      static_cast<uint16_t>(ctx->getAltNumber()), Kind::RULE });
+  };
+
+  addRule(tree, FlatParseTree::NO_NODE);
+  while (!open.empty()) {
+    Open &top = open.back();
+    if (top.nextChild == top.ctx->children.size()) {
+      nodes[top.node].size = static_cast<uint32_t>(nodes.size() - top.node);
+      open.pop_back();
+      continue;
+    }
+
+    ParseTree *child = top.ctx->children[top.nextChild++];
+    if (RuleContext::is(child)) {
+      addRule(antlrcpp::downCast<ParserRuleContext *>(child), top.node);
+      continue;
+    }
+
+    Token *token = antlrcpp::downCast<TerminalNode *>(child)->getSymbol();
+    if (token->getTokenIndex() == INVALID_INDEX) {
+      nodes.push_back({ static_cast<uint32_t>(token->getType()), 1, top.node, 0, Kind::MISSING });
+    } else {
+      nodes.push_back({ static_cast<uint32_t>(token->getTokenIndex()), 1, top.node, 0,
+                        ErrorNode::is(child) ? Kind::ERROR : Kind::TOKEN });
+    }
+  }
+
+  std::vector<uint32_t> data = serializeTokens(atn, tokens, includeText);
+  data.reserve(data.size() + nodes.size() * NODE_SIZE);
+  for (const Node &node : nodes) {
+    appendNode(data, node);
+  }
+  data[HEADER_SIZE - 1] = static_cast<uint32_t>(nodes.size());
+  return data;
+}
+
+uint64_t SerializedParseResult::checksum(CharStream *input) {
+  if (input == nullptr) {
+    return 0;
+  }
+  if (input->size() == 0) {
+    return checksum(std::string_view());
+  }
+  return checksum(input->getText(misc::Interval(static_cast<size_t>(0), input->size() - 1)));
+}
+
+uint64_t SerializedParseResult::checksum(std::string_view text) {
+  return fnv1a(text.data(), text.size());
+}
+
+SerializedParseResult::SerializedParseResult(const uint32_t *data, size_t size, atn::SerializedATNView atn)
+  : _data(data) {
+  if (size < HEADER_SIZE) {
+    throw IllegalArgumentException("the serialized parse result is truncated");
+  }
+  if (data[0] != SERIALIZED_VERSION) {
+    throw IllegalArgumentException("unsupported serialized parse result version");
+  }
+  if (read64(data + 1) != fnv1a(atn.data(), atn.size_bytes())) {
+    throw IllegalArgumentException("the serialized parse result was written for another grammar");
+  }
+
+  _tokenCount = data[5];
+  size_t textCount = data[6];
+  _nodeCount = data[7];
+  if (_tokenCount > (size - HEADER_SIZE) / TOKEN_COLUMNS) {
+    throw IllegalArgumentException("the serialized parse result is truncated");
+  }
+
+  _texts = HEADER_SIZE + _tokenCount * TOKEN_COLUMNS;
+  size_t p = _texts;
+  for (size_t i = 0; i < textCount; ++i) {
+    if (size - p < 2) {
+      throw IllegalArgumentException("the serialized parse result is truncated");
+    }
+    if (data[p] >= _tokenCount) {
+      throw IllegalArgumentException("the serialized parse result is corrupt");
+    }
+    size_t words = (static_cast<size_t>(data[p + 1]) + 3) / 4;
+    p += 2;
+    if (size - p < words) {
+      throw IllegalArgumentException("the serialized parse result is truncated");
+    }
+    p += words;
+  }
+
+  _nodes = p;
+  if (_nodeCount > (size - p) / NODE_SIZE) {
+    throw IllegalArgumentException("the serialized parse result is truncated");
+  }
+
+  // Check the structure once, so that the nodes can be used without further checks: every node
+  // must be a child of the innermost rule whose subtree contains it, and end within that subtree.
+  std::vector<size_t> open; // The end of the subtree of every enclosing rule node, innermost last.
+  std::vector<uint32_t> openNodes;
+  for (size_t i = 0; i < _nodeCount; ++i) {
+    while (!open.empty() && open.back() <= i) {
+      open.pop_back();
+      openNodes.pop_back();
+    }
+
+    Node node = getNode(i);
+    bool valid = node.size > 0 && node.size <= _nodeCount - i && node.kind <= Kind::MISSING;
+    if (i == 0) {
+      valid = valid && node.parent == FlatParseTree::NO_NODE && node.size == _nodeCount;
+    } else {
+      valid = valid && !open.empty() && node.parent == openNodes.back() && i + node.size <= open.back();
+    }
+    if (node.kind == Kind::RULE) {
+      open.push_back(i + node.size);
+      openNodes.push_back(static_cast<uint32_t>(i));
+    } else {
+      valid = valid && node.size == 1 && (node.kind == Kind::MISSING || node.value < _tokenCount);
+    }
+    if (!valid) {
+      throw IllegalArgumentException("the serialized parse result is corrupt");
+    }
+  }
+}
+
+uint64_t SerializedParseResult::getSourceChecksum() const {
+  return read64(_data + 3);
+}
+
+bool SerializedParseResult::matchesSource(CharStream *input) const {
+  return checksum(input) == getSourceChecksum();
+}
+
+size_t SerializedParseResult::getTokenCount() const {
+  return _tokenCount;
+}
+
+size_t SerializedParseResult::getNodeCount() const {
+  return _nodeCount;
+}
+
+FlatParseTree::Node SerializedParseResult::getNode(size_t index) const {
+  const uint32_t *words = _data + _nodes + index * NODE_SIZE;
+  return { words[0], words[1], words[2], static_cast<uint16_t>(words[3]), static_cast<Kind>(words[3] >> 16) };
+}
+
+void SerializedParseResult::loadTokens(TokenBuffer &tokens, CharStream *input) const {
+  tokens.setInputStream(input);
+  tokens.assignColumns(_data + HEADER_SIZE, _tokenCount);
+
+  const uint32_t *text = _data + _texts;
+  for (size_t i = 0; i < _data[6]; ++i) {
+    size_t length = text[1];
+    tokens.setText(text[0], std::string(reinterpret_cast<const char *>(text + 2), length));
+    text += 2 + (length + 3) / 4;
+  }
+}
+
+void SerializedParseResult::loadTree(FlatParseTree &tree) const {
+  tree._nodes.resize(_nodeCount);
+  for (size_t i = 0; i < _nodeCount; ++i) {
+    tree._nodes[i] = getNode(i);
+  }
+  tree._open.clear();
+  tree._missingTokens.clear();
+  tree._complete = _nodeCount > 0;
+}
+
+std::vector<uint32_t> SerializedParseResult::serializeTokens(atn::SerializedATNView atn, const TokenBuffer &tokens,
+                                                             bool includeText) {
+  size_t count = tokens.size();
+  std::vector<uint32_t> data;
+  data.reserve(HEADER_SIZE + count * TOKEN_COLUMNS);
+  data.push_back(SERIALIZED_VERSION);
+  append64(data, fnv1a(atn.data(), atn.size_bytes()));
+  append64(data, checksum(tokens.getInputStream()));
+  data.push_back(static_cast<uint32_t>(count));
+  data.push_back(0); // text count
+  data.push_back(0); // node count
+  tokens.appendColumns(data);
+
+  std::vector<size_t> indexes;
+  if (includeText) {
+    for (size_t i = 0; i < count; ++i) {
+      if (tokens.getType(i) != Token::EOF) {
+        indexes.push_back(i);
+      }
+    }
+  } else {
+    // Sorted, so that the same tokens always give the same data.
+    indexes = tokens.getTextIndexes();
+  }
+
+  for (size_t index : indexes) {
+    std::string text = tokens.getText(index);
+    data.push_back(static_cast<uint32_t>(index));
+    data.push_back(static_cast<uint32_t>(text.size()));
+    size_t offset = data.size();
+    data.resize(offset + (text.size() + 3) / 4, 0);
+    std::copy(text.begin(), text.end(), reinterpret_cast<char *>(data.data() + offset));
+  }
+  data[HEADER_SIZE - 2] = static_cast<uint32_t>(indexes.size());
+  return data;
+}
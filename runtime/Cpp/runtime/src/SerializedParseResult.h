@@ -0,0 +1,98 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <string_view>
+
+#include "atn/SerializedATNView.h"
+#include "tree/FlatParseTree.h"
+
+namespace antlr4 {
+
+  /// A parse result in a compact binary form, to store it or pass it to another process instead of
+  /// parsing the same input again.
+  ///
+  /// serialize() writes the tokens of a <seealso cref="TokenBuffer"/> and the nodes of a parse tree,
+  /// with their rule indexes, alternatives, tokens, error and missing tokens, into an array of 32-bit
+  /// words in the byte order of the machine. It also records a checksum of the input and a hash of the
+  /// serialized ATN of the grammar. Reading the data takes no copy: the constructor only checks it,
+  /// and the nodes can be read in place, or loaded into a <seealso cref="tree::FlatParseTree"/> and a
+  /// TokenBuffer with a few block copies. The data is rejected if it was written for another grammar.
+  ///
+  /// To get ParserRuleContexts back, wrap the loaded tokens in a <seealso cref="TokenBufferStream"/>,
+  /// set it on a parser and call <seealso cref="tree::FlatParseTree#toParseTree"/>.
+  ///
+  /// <code>
+  ///   SerializedParseResult result(data.data(), data.size(), parser.getSerializedATN());
+  ///   if (result.matchesSource(&input)) {
+  ///     TokenBuffer buffer;
+  ///     result.loadTokens(buffer, &input);
+  ///     TokenBufferStream tokens(std::move(buffer));
+  ///     parser.setTokenStream(&tokens);
+  ///     result.loadTree(flatTree);
+  ///     ParserRuleContext *tree = flatTree.toParseTree(parser);
+  ///   }
+  /// </code>
+  class ANTLR4CPP_PUBLIC SerializedParseResult final {
+  public:
+    static constexpr uint32_t SERIALIZED_VERSION = 1;
+
+    /// Export {@code tokens} and {@code tree}, which were produced by a parser with the serialized ATN
+    /// {@code atn}. Only token text stored in the buffer is written, unless {@code includeText} is set,
+    /// so the input is needed again to read the text of the other tokens.
+    static std::vector<uint32_t> serialize(atn::SerializedATNView atn, const TokenBuffer &tokens,
+                                           const tree::FlatParseTree &tree, bool includeText = false);
+
+    /// Same as above, for a ParserRuleContext tree whose tokens are in {@code tokens}. The alternative of
+    /// a rule node is the <seealso cref="RuleContext#getAltNumber"/> of its context, which is always
+    /// ATN::INVALID_ALT_NUMBER (0) for generated contexts, unless their contextSuperClass stores it.
+    /// Throws an IllegalArgumentException if an alternative number is larger than 65535.
+    static std::vector<uint32_t> serialize(atn::SerializedATNView atn, const TokenBuffer &tokens,
+                                           ParserRuleContext *tree, bool includeText = false);
+
+    /// The checksum of the whole text of {@code input}, as recorded by serialize() for the input stream
+    /// of the token buffer. 0 for no input.
+    static uint64_t checksum(CharStream *input);
+    static uint64_t checksum(std::string_view text);
+
+    /// Read {@code size} words at {@code data}, which must stay valid for the lifetime of this object.
+    /// Throws an IllegalArgumentException if the data is truncated or corrupt, of another version, or
+    /// was not written for {@code atn}.
+    SerializedParseResult(const uint32_t *data, size_t size, atn::SerializedATNView atn);
+
+    uint64_t getSourceChecksum() const;
+
+    /// Whether the data was written for the same text as the one of {@code input}.
+    bool matchesSource(CharStream *input) const;
+
+    size_t getTokenCount() const;
+    size_t getNodeCount() const;
+
+    /// The node at {@code index} in preorder, see <seealso cref="tree::FlatParseTree#getNode"/>.
+    tree::FlatParseTree::Node getNode(size_t index) const;
+
+    /// Replace the content of {@code tokens} by the serialized tokens. The text of tokens which was not
+    /// written is read from {@code input}, which becomes the input stream of the buffer.
+    void loadTokens(TokenBuffer &tokens, CharStream *input = nullptr) const;
+
+    /// Replace the content of {@code tree} by the serialized nodes.
+    void loadTree(tree::FlatParseTree &tree) const;
+
+  private:
+    const uint32_t *_data;
+    size_t _tokenCount;
+    size_t _nodeCount;
+
+    /// Word offsets of the explicit token texts and of the nodes.
+    size_t _texts;
+    size_t _nodes;
+
+    /// The header and the tokens, without nodes.
+    static std::vector<uint32_t> serializeTokens(atn::SerializedATNView atn, const TokenBuffer &tokens,
+                                                 bool includeText);
+  };
+
+} // namespace antlr4
@@ -0,0 +1,64 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "misc/Interval.h"
+#include "CommonToken.h"
+#include "CharStream.h"
+
+#include "SlabTokenFactory.h"
+
+using namespace antlr4;
+
+namespace {
+
+  // Deleting a token through its virtual destructor uses the deallocation function of the dynamic
+  // type, so this one makes std::unique_ptr<CommonToken> leave the memory to the slab.
+  class SlabToken final : public CommonToken {
+  public:
+    using CommonToken::CommonToken;
+
+    static void operator delete(void * /*p*/) {
+    }
+  };
+
+}
+
+SlabTokenFactory::SlabTokenFactory(bool copyText_) : CommonTokenFactory(copyText_), _used(BLOCK_SIZE) {
+}
+
+SlabTokenFactory::~SlabTokenFactory() {
+}
+
+std::unique_ptr<CommonToken> SlabTokenFactory::create(std::pair<TokenSource*, CharStream*> source, size_t type,
+  const std::string &text, size_t channel, size_t start, size_t stop, size_t line, size_t charPositionInLine) {
+
+  std::unique_ptr<CommonToken> t(new (allocate()) SlabToken(source, type, channel, start, stop));
+  t->setLine(line);
+  t->setCharPositionInLine(charPositionInLine);
+  if (text != "") {
+    t->setText(text);
+  } else if (copyText && source.second != nullptr) {
+    t->setText(source.second->getText(misc::Interval(start, stop)));
+  }
+
+  return t;
+}
+
+std::unique_ptr<CommonToken> SlabTokenFactory::create(size_t type, const std::string &text) {
+  return std::unique_ptr<CommonToken>(new (allocate()) SlabToken(type, text));
+}
+
+size_t SlabTokenFactory::getBlockCount() const {
+  return _blocks.size();
+}
+
+void* SlabTokenFactory::allocate() {
+  if (_used == BLOCK_SIZE) {
+    // Array new returns memory suitably aligned for any object of fundamental alignment.
+    _blocks.emplace_back(new char[BLOCK_SIZE * sizeof(SlabToken)]);
+    _used = 0;
+  }
+  return _blocks.back().get() + sizeof(SlabToken) * _used++;
+}
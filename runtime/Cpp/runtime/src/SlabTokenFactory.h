@@ -0,0 +1,55 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "CommonTokenFactory.h"
+
+namespace antlr4 {
+
+  /// A <seealso cref="CommonTokenFactory"/> which constructs its tokens in large blocks of memory
+  /// owned by the factory, instead of allocating each token separately. The tokens are still handed
+  /// out (and later destroyed) through std::unique_ptr, but destroying a token does not free its
+  /// memory. All blocks are freed together when the factory is destroyed, so the factory must
+  /// outlive every token it created. Declare it before the token stream:
+  ///
+  /// <code>
+  ///   SlabTokenFactory factory;
+  ///   MyLexer lexer(&input);
+  ///   lexer.setTokenFactory(&factory);
+  ///   CommonTokenStream tokens(&lexer);
+  /// </code>
+  ///
+  /// Memory of destroyed tokens is not reused, which suits token streams keeping all their tokens
+  /// (like BufferedTokenStream), but not UnbufferedTokenStream. A factory is not thread-safe.
+  class ANTLR4CPP_PUBLIC SlabTokenFactory : public CommonTokenFactory {
+  public:
+    /// The number of tokens per block.
+    static constexpr size_t BLOCK_SIZE = 1024;
+
+    SlabTokenFactory(bool copyText = false);
+    SlabTokenFactory(const SlabTokenFactory &other) = delete;
+    virtual ~SlabTokenFactory();
+
+    SlabTokenFactory& operator = (const SlabTokenFactory &other) = delete;
+
+    virtual std::unique_ptr<CommonToken> create(std::pair<TokenSource*, CharStream*> source, size_t type,
+      const std::string &text, size_t channel, size_t start, size_t stop, size_t line, size_t charPositionInLine) override;
+
+    virtual std::unique_ptr<CommonToken> create(size_t type, const std::string &text) override;
+
+    /// The number of blocks allocated so far.
+    size_t getBlockCount() const;
+
+  protected:
+    std::vector<std::unique_ptr<char[]>> _blocks;
+
+    /// The number of tokens constructed in the last block.
+    size_t _used;
+
+    void* allocate();
+  };
+
+} // namespace antlr4
@@ -0,0 +1,386 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "CharStream.h"
+#include "Exceptions.h"
+#include "TokenSource.h"
+#include "misc/Interval.h"
+#include "support/StringUtils.h"
+
+#include "TokenBuffer.h"
+
+using namespace antlr4;
+using namespace antlr4::misc;
+
+//------------------ TokenBuffer ---------------------------------------------------------------------------------------
+
+TokenBuffer::TokenBuffer(bool copyText) : _source(nullptr), _input(nullptr), _copyText(copyText) {
+}
+
+void TokenBuffer::setTokenSource(TokenSource *source) {
+  _source = source;
+  _input = source != nullptr ? source->getInputStream() : nullptr;
+}
+
+TokenSource* TokenBuffer::getTokenSource() const {
+  return _source;
+}
+
+CharStream* TokenBuffer::getInputStream() const {
+  return _input;
+}
+
+void TokenBuffer::setInputStream(CharStream *input) {
+  _source = nullptr;
+  _input = input;
+}
+
+size_t TokenBuffer::add(size_t type, size_t channel, size_t start, size_t stop, size_t line,
+                        size_t charPositionInLine) {
+  size_t index = addFields(type, channel, start, stop, line, charPositionInLine);
+  if (_copyText && _input != nullptr && type != Token::EOF) {
+    _texts[index] = _input->getText(misc::Interval(start, stop));
+  }
+  return index;
+}
+
+size_t TokenBuffer::add(size_t type, size_t channel, size_t start, size_t stop, size_t line, size_t charPositionInLine,
+                        const std::string &text) {
+  size_t index = addFields(type, channel, start, stop, line, charPositionInLine);
+  _texts[index] = text;
+  return index;
+}
+
+size_t TokenBuffer::add(const Token &token) {
+  if (token.getType() == Token::EOF) {
+    return add(token.getType(), token.getChannel(), token.getStartIndex(), token.getStopIndex(), token.getLine(),
+               token.getCharPositionInLine());
+  }
+  return add(token.getType(), token.getChannel(), token.getStartIndex(), token.getStopIndex(), token.getLine(),
+             token.getCharPositionInLine(), token.getText());
+}
+
+size_t TokenBuffer::add(const TokenBuffer &other, size_t index) {
+  size_t result = _types.size();
+  _types.push_back(other._types[index]);
+  _channels.push_back(other._channels[index]);
+  _starts.push_back(other._starts[index]);
+  _stops.push_back(other._stops[index]);
+  _lines.push_back(other._lines[index]);
+  _columns.push_back(other._columns[index]);
+
+  auto iterator = other._texts.find(index);
+  if (iterator != other._texts.end()) {
+    _texts[result] = iterator->second;
+  }
+
+  return result;
+}
+
+void TokenBuffer::append(const TokenBuffer &other, size_t begin, size_t end) {
+  if (begin >= end) {
+    return;
+  }
+
+  size_t offset = _types.size();
+  _types.insert(_types.end(), other._types.begin() + begin, other._types.begin() + end);
+  _channels.insert(_channels.end(), other._channels.begin() + begin, other._channels.begin() + end);
+  _starts.insert(_starts.end(), other._starts.begin() + begin, other._starts.begin() + end);
+  _stops.insert(_stops.end(), other._stops.begin() + begin, other._stops.begin() + end);
+  _lines.insert(_lines.end(), other._lines.begin() + begin, other._lines.begin() + end);
+  _columns.insert(_columns.end(), other._columns.begin() + begin, other._columns.begin() + end);
+
+  for (const auto &[index, text] : other._texts) {
+    if (index >= begin && index < end) {
+      _texts[offset + index - begin] = text;
+    }
+  }
+
+  if (_copyText && _input != nullptr) {
+    for (size_t i = offset; i < _types.size(); ++i) {
+      if (_types[i] != narrow(Token::EOF) && _texts.find(i) == _texts.end()) {
+        _texts[i] = _input->getText(misc::Interval(getStartIndex(i), getStopIndex(i)));
+      }
+    }
+  }
+}
+
+void TokenBuffer::replace(size_t begin, size_t end, const TokenBuffer &other) {
+  size_t count = other.size();
+  auto replaceColumn = [&](std::vector<uint32_t> &column, const std::vector<uint32_t> &source) {
+    if (end - begin > count) {
+      column.erase(column.begin() + begin + count, column.begin() + end);
+    } else {
+      column.insert(column.begin() + end, count - (end - begin), 0);
+    }
+    std::copy(source.begin(), source.end(), column.begin() + begin);
+  };
+  replaceColumn(_types, other._types);
+  replaceColumn(_channels, other._channels);
+  replaceColumn(_starts, other._starts);
+  replaceColumn(_stops, other._stops);
+  replaceColumn(_lines, other._lines);
+  replaceColumn(_columns, other._columns);
+
+  if (!_texts.empty() || !other._texts.empty()) {
+    std::unordered_map<size_t, std::string> texts;
+    for (auto &[index, text] : _texts) {
+      if (index < begin) {
+        texts[index] = std::move(text);
+      } else if (index >= end) {
+        texts[index - end + begin + count] = std::move(text);
+      }
+    }
+    for (const auto &[index, text] : other._texts) {
+      texts[begin + index] = text;
+    }
+    _texts = std::move(texts);
+  }
+}
+
+void TokenBuffer::removeLast() {
+  if (!_texts.empty()) {
+    _texts.erase(_types.size() - 1);
+  }
+  _types.pop_back();
+  _channels.pop_back();
+  _starts.pop_back();
+  _stops.pop_back();
+  _lines.pop_back();
+  _columns.pop_back();
+}
+
+void TokenBuffer::shift(size_t begin, ssize_t delta, size_t line, ssize_t lineDelta, ssize_t columnDelta) {
+  for (size_t i = begin; i < _types.size(); ++i) {
+    _starts[i] = static_cast<uint32_t>(_starts[i] + delta);
+
+    // An empty token at index 0, e.g. the EOF token of an empty input, has the stop index -1, which is
+    // stored as the invalid index. Like all empty tokens it stays one before its start index.
+    if (_stops[i] != std::numeric_limits<uint32_t>::max()) {
+      _stops[i] = static_cast<uint32_t>(_stops[i] + delta);
+    } else {
+      _stops[i] = _starts[i] - 1;
+    }
+  }
+
+  for (size_t i = begin; i < _lines.size() && _lines[i] == line; ++i) {
+    _columns[i] = static_cast<uint32_t>(_columns[i] + columnDelta);
+  }
+  for (size_t i = begin; i < _lines.size(); ++i) {
+    _lines[i] = static_cast<uint32_t>(_lines[i] + lineDelta);
+  }
+}
+
+void TokenBuffer::appendColumns(std::vector<uint32_t> &data) const {
+  for (const std::vector<uint32_t> *column : { &_types, &_channels, &_starts, &_stops, &_lines, &_columns }) {
+    data.insert(data.end(), column->begin(), column->end());
+  }
+}
+
+void TokenBuffer::assignColumns(const uint32_t *columns, size_t count) {
+  _texts.clear();
+  for (std::vector<uint32_t> *column : { &_types, &_channels, &_starts, &_stops, &_lines, &_columns }) {
+    column->assign(columns, columns + count);
+    columns += count;
+  }
+}
+
+std::vector<size_t> TokenBuffer::getTextIndexes() const {
+  std::vector<size_t> indexes;
+  indexes.reserve(_texts.size());
+  for (const auto &entry : _texts) {
+    indexes.push_back(entry.first);
+  }
+  std::sort(indexes.begin(), indexes.end());
+  return indexes;
+}
+
+size_t TokenBuffer::size() const {
+  return _types.size();
+}
+
+void TokenBuffer::reserve(size_t n) {
+  _types.reserve(n);
+  _channels.reserve(n);
+  _starts.reserve(n);
+  _stops.reserve(n);
+  _lines.reserve(n);
+  _columns.reserve(n);
+}
+
+void TokenBuffer::clear() {
+  _types.clear();
+  _channels.clear();
+  _starts.clear();
+  _stops.clear();
+  _lines.clear();
+  _columns.clear();
+  _texts.clear();
+}
+
+size_t TokenBuffer::getType(size_t index) const {
+  return widen(_types[index]);
+}
+
+size_t TokenBuffer::getChannel(size_t index) const {
+  return _channels[index];
+}
+
+size_t TokenBuffer::getStartIndex(size_t index) const {
+  return widen(_starts[index]);
+}
+
+size_t TokenBuffer::getStopIndex(size_t index) const {
+  return widen(_stops[index]);
+}
+
+size_t TokenBuffer::getLine(size_t index) const {
+  return widen(_lines[index]);
+}
+
+size_t TokenBuffer::getCharPositionInLine(size_t index) const {
+  return widen(_columns[index]);
+}
+
+std::string TokenBuffer::getText(size_t index) const {
+  auto iterator = _texts.find(index);
+  if (iterator != _texts.end()) {
+    return iterator->second;
+  }
+
+  if (_input == nullptr) {
+    return "";
+  }
+  if (getType(index) == Token::EOF) {
+    return "<EOF>";
+  }
+
+  // Not checked against the input size, which streams like PushCharStream only know at their end.
+  return _input->getText(misc::Interval(getStartIndex(index), getStopIndex(index)));
+}
+
+void TokenBuffer::setType(size_t index, size_t type) {
+  _types[index] = narrow(type);
+}
+
+void TokenBuffer::setChannel(size_t index, size_t channel) {
+  _channels[index] = narrow(channel);
+}
+
+void TokenBuffer::setStartIndex(size_t index, size_t start) {
+  _starts[index] = narrow(start);
+}
+
+void TokenBuffer::setStopIndex(size_t index, size_t stop) {
+  _stops[index] = narrow(stop);
+}
+
+void TokenBuffer::setLine(size_t index, size_t line) {
+  _lines[index] = narrow(line);
+}
+
+void TokenBuffer::setCharPositionInLine(size_t index, size_t charPositionInLine) {
+  _columns[index] = narrow(charPositionInLine);
+}
+
+void TokenBuffer::setText(size_t index, const std::string &text) {
+  _texts[index] = text;
+}
+
+size_t TokenBuffer::addFields(size_t type, size_t channel, size_t start, size_t stop, size_t line,
+                              size_t charPositionInLine) {
+  size_t index = _types.size();
+  _types.push_back(narrow(type));
+  _channels.push_back(narrow(channel));
+  _starts.push_back(narrow(start));
+  _stops.push_back(narrow(stop));
+  _lines.push_back(narrow(line));
+  _columns.push_back(narrow(charPositionInLine));
+  return index;
+}
+
+uint32_t TokenBuffer::narrow(size_t value) {
+  if (value == INVALID_INDEX) {
+    return std::numeric_limits<uint32_t>::max();
+  }
+  if (value >= std::numeric_limits<uint32_t>::max()) {
+    throw IndexOutOfBoundsException("token field value " + std::to_string(value) + " exceeds 32 bits");
+  }
+  return static_cast<uint32_t>(value);
+}
+
+size_t TokenBuffer::widen(uint32_t value) {
+  if (value == std::numeric_limits<uint32_t>::max()) {
+    return INVALID_INDEX;
+  }
+  return value;
+}
+
+//------------------ TokenView -----------------------------------------------------------------------------------------
+
+TokenView::TokenView(const TokenBuffer *buffer, size_t index) : _buffer(buffer), _index(index) {
+}
+
+std::string TokenView::getText() const {
+  return _buffer->getText(_index);
+}
+
+size_t TokenView::getType() const {
+  return _buffer->getType(_index);
+}
+
+size_t TokenView::getLine() const {
+  return _buffer->getLine(_index);
+}
+
+size_t TokenView::getCharPositionInLine() const {
+  return _buffer->getCharPositionInLine(_index);
+}
+
+size_t TokenView::getChannel() const {
+  return _buffer->getChannel(_index);
+}
+
+size_t TokenView::getTokenIndex() const {
+  return _index;
+}
+
+size_t TokenView::getStartIndex() const {
+  return _buffer->getStartIndex(_index);
+}
+
+size_t TokenView::getStopIndex() const {
+  return _buffer->getStopIndex(_index);
+}
+
+TokenSource* TokenView::getTokenSource() const {
+  return _buffer->getTokenSource();
+}
+
+CharStream* TokenView::getInputStream() const {
+  return _buffer->getInputStream();
+}
+
+std::string TokenView::toString() const {
+  std::stringstream ss;
+
+  std::string channelStr;
+  size_t channel = getChannel();
+  if (channel > 0) {
+    channelStr = ",channel=" + std::to_string(channel);
+  }
+  std::string txt = getText();
+  if (!txt.empty()) {
+    txt = antlrcpp::escapeWhitespace(txt);
+  } else {
+    txt = "<no text>";
+  }
+
+  ss << "[@" << _index << "," << symbolToNumeric(getStartIndex()) << ":" << symbolToNumeric(getStopIndex())
+    << "='" << txt << "',<" << symbolToNumeric(getType()) << ">" << channelStr << "," << getLine() << ":"
+    << getCharPositionInLine() << "]";
+
+  return ss.str();
+}
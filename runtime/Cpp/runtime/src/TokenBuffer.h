@@ -0,0 +1,139 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+#include "Token.h"
+
+namespace antlr4 {
+
+  /// Compact storage for a sequence of tokens. Instead of one heap allocated <seealso cref="CommonToken"/>
+  /// per token (well over 100 bytes each), the token fields are kept in parallel 32-bit columns,
+  /// which take 24 bytes per token. Token text is normally not stored, but read from the input stream
+  /// on request. Only explicitly given text (e.g. set by the lexer with setText()) goes into a side
+  /// table, unless {@code copyText} is set.
+  ///
+  /// Character indexes, lines and columns are therefore limited to 32 bits (the EOF and invalid index
+  /// markers are preserved). Tokens are filled in by <seealso cref="Lexer#appendNextToken"/> and read
+  /// through <seealso cref="TokenBufferStream"/> or <seealso cref="TokenView"/>.
+  class ANTLR4CPP_PUBLIC TokenBuffer {
+  public:
+    /// The number of 32-bit columns written by appendColumns().
+    static constexpr size_t COLUMN_COUNT = 6;
+
+    /// Set {@code copyText} to keep the text of all tokens, which is required for input streams
+    /// that discard consumed input, like UnbufferedCharStream and PushCharStream.
+    TokenBuffer(bool copyText = false);
+
+    /// The token source (and its input stream) the tokens are read from.
+    void setTokenSource(TokenSource *source);
+    TokenSource* getTokenSource() const;
+    CharStream* getInputStream() const;
+
+    /// Read the token text from {@code input}, without a token source.
+    void setInputStream(CharStream *input);
+
+    /// Append a token and return its index. Its text comes from the input.
+    size_t add(size_t type, size_t channel, size_t start, size_t stop, size_t line, size_t charPositionInLine);
+
+    /// Append a token with the given text, which is stored even if it is empty.
+    size_t add(size_t type, size_t channel, size_t start, size_t stop, size_t line, size_t charPositionInLine,
+               const std::string &text);
+
+    /// Append a copy of {@code token}, including its text.
+    size_t add(const Token &token);
+
+    /// Append a copy of the token at {@code index} in {@code other}. Its text is copied only if stored.
+    size_t add(const TokenBuffer &other, size_t index);
+
+    /// Append copies of the tokens {@code begin} up to (excluding) {@code end} of {@code other}.
+    void append(const TokenBuffer &other, size_t begin, size_t end);
+
+    /// Replace the tokens {@code begin} up to (excluding) {@code end} by copies of all tokens of {@code other}.
+    void replace(size_t begin, size_t end, const TokenBuffer &other);
+
+    /// Remove the last token.
+    void removeLast();
+
+    /// Move the tokens from {@code begin} on by {@code delta} characters and {@code lineDelta} lines,
+    /// e.g. after an edit before them. Those still on {@code line} also move by {@code columnDelta}.
+    void shift(size_t begin, ssize_t delta, size_t line, ssize_t lineDelta, ssize_t columnDelta);
+
+    /// Append the token columns to {@code data}: COLUMN_COUNT blocks of size() words each.
+    void appendColumns(std::vector<uint32_t> &data) const;
+
+    /// Replace all tokens by {@code count} tokens read from {@code columns}, as written by appendColumns().
+    void assignColumns(const uint32_t *columns, size_t count);
+
+    /// The indexes of the tokens whose text is stored, in ascending order.
+    std::vector<size_t> getTextIndexes() const;
+
+    size_t size() const;
+    void reserve(size_t n);
+    void clear();
+
+    size_t getType(size_t index) const;
+    size_t getChannel(size_t index) const;
+    size_t getStartIndex(size_t index) const;
+    size_t getStopIndex(size_t index) const;
+    size_t getLine(size_t index) const;
+    size_t getCharPositionInLine(size_t index) const;
+    std::string getText(size_t index) const;
+
+    void setType(size_t index, size_t type);
+    void setChannel(size_t index, size_t channel);
+    void setStartIndex(size_t index, size_t start);
+    void setStopIndex(size_t index, size_t stop);
+    void setLine(size_t index, size_t line);
+    void setCharPositionInLine(size_t index, size_t charPositionInLine);
+    void setText(size_t index, const std::string &text);
+
+  protected:
+    TokenSource *_source;
+    CharStream *_input;
+    bool _copyText;
+
+    std::vector<uint32_t> _types;
+    std::vector<uint32_t> _channels;
+    std::vector<uint32_t> _starts;
+    std::vector<uint32_t> _stops;
+    std::vector<uint32_t> _lines;
+    std::vector<uint32_t> _columns;
+
+    /// Explicitly set token text, by token index.
+    std::unordered_map<size_t, std::string> _texts;
+
+    size_t addFields(size_t type, size_t channel, size_t start, size_t stop, size_t line, size_t charPositionInLine);
+
+    static uint32_t narrow(size_t value);
+    static size_t widen(uint32_t value);
+  };
+
+  /// A <seealso cref="Token"/> which reads its fields from a <seealso cref="TokenBuffer"/>.
+  class ANTLR4CPP_PUBLIC TokenView final : public Token {
+  public:
+    TokenView(const TokenBuffer *buffer, size_t index);
+
+    std::string getText() const override;
+    size_t getType() const override;
+    size_t getLine() const override;
+    size_t getCharPositionInLine() const override;
+    size_t getChannel() const override;
+    size_t getTokenIndex() const override;
+    size_t getStartIndex() const override;
+    size_t getStopIndex() const override;
+    TokenSource* getTokenSource() const override;
+    CharStream* getInputStream() const override;
+
+    std::string toString() const override;
+
+  private:
+    const TokenBuffer *_buffer;
+    size_t _index;
+  };
+
+} // namespace antlr4
@@ -0,0 +1,373 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "CharStream.h"
+#include "Exceptions.h"
+#include "Lexer.h"
+#include "RuleContext.h"
+#include "misc/Interval.h"
+
+#include "TokenBufferStream.h"
+
+using namespace antlr4;
+
+TokenBufferStream::TokenBufferStream(Lexer *lexer, size_t channel, bool copyText)
+  : _lexer(lexer), _channel(channel), _buffer(copyText), _p(0), _needSetup(true), _fetchedEOF(false),
+    _separateHidden(false) {
+  if (lexer == nullptr) {
+    throw NullPointerException("lexer cannot be null");
+  }
+  _buffer.setTokenSource(lexer);
+  _hidden.setTokenSource(lexer);
+}
+
+TokenBufferStream::TokenBufferStream(TokenBuffer tokens, size_t channel)
+  : _lexer(nullptr), _channel(channel), _buffer(std::move(tokens)), _p(0), _needSetup(true), _fetchedEOF(true),
+    _separateHidden(false) {
+  if (_buffer.size() == 0 || _buffer.getType(_buffer.size() - 1) != Token::EOF) {
+    throw IllegalArgumentException("the tokens must end with EOF");
+  }
+}
+
+TokenSource* TokenBufferStream::getTokenSource() const {
+  return _lexer != nullptr ? _lexer : _buffer.getTokenSource();
+}
+
+size_t TokenBufferStream::index() {
+  return _p;
+}
+
+ssize_t TokenBufferStream::mark() {
+  return 0;
+}
+
+void TokenBufferStream::release(ssize_t /*marker*/) {
+  // no resources to release
+}
+
+void TokenBufferStream::reset() {
+  seek(0);
+}
+
+void TokenBufferStream::seek(size_t index) {
+  lazyInit();
+  _p = nextTokenOnChannel(index);
+}
+
+size_t TokenBufferStream::size() {
+  return _buffer.size();
+}
+
+void TokenBufferStream::consume() {
+  lazyInit();
+  if (_buffer.getType(_p) == Token::EOF) {
+    throw IllegalStateException("cannot consume EOF");
+  }
+
+  if (sync(_p + 1)) {
+    _p = nextTokenOnChannel(_p + 1);
+  }
+}
+
+Token* TokenBufferStream::get(size_t i) const {
+  if (i >= _buffer.size()) {
+    throw IndexOutOfBoundsException(std::string("token index ") +
+                                    std::to_string(i) +
+                                    std::string(" out of range 0..") +
+                                    std::to_string(_buffer.size() - 1));
+  }
+  return getView(_buffer, _views, i);
+}
+
+size_t TokenBufferStream::LA(ssize_t i) {
+  ssize_t index = lookahead(i);
+  if (index < 0) {
+    return Token::INVALID_TYPE;
+  }
+  return _buffer.getType(static_cast<size_t>(index));
+}
+
+Token* TokenBufferStream::LT(ssize_t k) {
+  ssize_t index = lookahead(k);
+  if (index < 0) {
+    return nullptr;
+  }
+  return get(static_cast<size_t>(index));
+}
+
+std::string TokenBufferStream::getSourceName() const {
+  if (_lexer != nullptr) {
+    return _lexer->getSourceName();
+  }
+  CharStream *input = _buffer.getInputStream();
+  return input != nullptr ? input->getSourceName() : IntStream::UNKNOWN_SOURCE_NAME;
+}
+
+std::string TokenBufferStream::getText() {
+  fill();
+  return getText(misc::Interval(0U, size() - 1));
+}
+
+std::string TokenBufferStream::getText(const misc::Interval &interval) {
+  lazyInit();
+  size_t start = interval.a;
+  size_t stop = interval.b;
+  if (start == INVALID_INDEX || stop == INVALID_INDEX) {
+    return "";
+  }
+  sync(stop);
+  if (stop >= _buffer.size()) {
+    stop = _buffer.size() - 1;
+  }
+
+  std::string result;
+  for (size_t i = start; i <= stop; i++) {
+    if (_separateHidden && i > start) {
+      for (size_t j = _hiddenBefore[i - 1]; j < _hiddenBefore[i]; ++j) {
+        result += _hidden.getText(j);
+      }
+    }
+    if (_buffer.getType(i) == Token::EOF) {
+      break;
+    }
+    result += _buffer.getText(i);
+  }
+  return result;
+}
+
+std::string TokenBufferStream::getText(RuleContext *ctx) {
+  return getText(ctx->getSourceInterval());
+}
+
+std::string TokenBufferStream::getText(Token *start, Token *stop) {
+  if (start != nullptr && stop != nullptr) {
+    return getText(misc::Interval(start->getTokenIndex(), stop->getTokenIndex()));
+  }
+
+  return "";
+}
+
+void TokenBufferStream::fill() {
+  lazyInit();
+  if (_fetchedEOF) {
+    return;
+  }
+
+  if (_separateHidden) {
+    const size_t blockSize = 1000;
+    while (fetch(blockSize) == blockSize) {
+    }
+    return;
+  }
+
+  _lexer->tokenizeAll(_buffer);
+  if (_lexer->isSuspended()) {
+    throw InputStarvedException("token source needs more input");
+  }
+  _fetchedEOF = true;
+}
+
+const TokenBuffer& TokenBufferStream::getBuffer() const {
+  return _buffer;
+}
+
+void TokenBufferStream::setSeparateHiddenTokens(bool separate) {
+  if (!_needSetup || _lexer == nullptr) {
+    throw IllegalStateException("tokens have already been read");
+  }
+  _separateHidden = separate;
+}
+
+const TokenBuffer& TokenBufferStream::getHiddenBuffer() const {
+  return _hidden;
+}
+
+std::vector<Token *> TokenBufferStream::getHiddenTokensToRight(size_t tokenIndex, ssize_t channel) {
+  lazyInit();
+  sync(tokenIndex + 1);
+  if (tokenIndex >= _buffer.size()) {
+    throw IndexOutOfBoundsException(std::to_string(tokenIndex) + " not in 0.." + std::to_string(_buffer.size() - 1));
+  }
+
+  if (_separateHidden) {
+    size_t to = tokenIndex + 1 < _buffer.size() ? _hiddenBefore[tokenIndex + 1] : _hidden.size();
+    return filterForChannel(_hidden, _hiddenViews, _hiddenBefore[tokenIndex], to, channel);
+  }
+
+  size_t to = tokenIndex + 1;
+  while (sync(to) && _buffer.getChannel(to) != _channel && _buffer.getType(to) != Token::EOF) {
+    ++to;
+  }
+  return filterForChannel(_buffer, _views, tokenIndex + 1, std::min(to, _buffer.size()), channel);
+}
+
+std::vector<Token *> TokenBufferStream::getHiddenTokensToRight(size_t tokenIndex) {
+  return getHiddenTokensToRight(tokenIndex, -1);
+}
+
+std::vector<Token *> TokenBufferStream::getHiddenTokensToLeft(size_t tokenIndex, ssize_t channel) {
+  lazyInit();
+  if (tokenIndex >= _buffer.size()) {
+    throw IndexOutOfBoundsException(std::to_string(tokenIndex) + " not in 0.." + std::to_string(_buffer.size() - 1));
+  }
+
+  if (_separateHidden) {
+    size_t from = tokenIndex > 0 ? _hiddenBefore[tokenIndex - 1] : 0;
+    return filterForChannel(_hidden, _hiddenViews, from, _hiddenBefore[tokenIndex], channel);
+  }
+
+  size_t from = tokenIndex;
+  while (from > 0 && _buffer.getChannel(from - 1) != _channel) {
+    --from;
+  }
+  return filterForChannel(_buffer, _views, from, tokenIndex, channel);
+}
+
+std::vector<Token *> TokenBufferStream::getHiddenTokensToLeft(size_t tokenIndex) {
+  return getHiddenTokensToLeft(tokenIndex, -1);
+}
+
+ssize_t TokenBufferStream::lookahead(ssize_t k) {
+  lazyInit();
+  if (k == 0) {
+    return -1;
+  }
+
+  if (k < 0) {
+    if (static_cast<size_t>(-k) > _p) {
+      return -1;
+    }
+
+    // find k good tokens looking backwards
+    ssize_t i = static_cast<ssize_t>(_p);
+    for (ssize_t n = 0; n < -k && i >= 0; ++n) {
+      // skip off-channel tokens
+      i = i == 0 ? -1 : previousTokenOnChannel(i - 1);
+    }
+    return i;
+  }
+
+  size_t i = _p;
+  for (ssize_t n = 1; n < k; ++n) {
+    // skip off-channel tokens, but make sure to not look past EOF
+    if (sync(i + 1)) {
+      i = nextTokenOnChannel(i + 1);
+    }
+  }
+  return static_cast<ssize_t>(i);
+}
+
+bool TokenBufferStream::sync(size_t i) {
+  if (i < _buffer.size()) {
+    return true;
+  }
+
+  size_t n = i - _buffer.size() + 1;
+  return fetch(n) >= n;
+}
+
+size_t TokenBufferStream::fetch(size_t n) {
+  if (_fetchedEOF) {
+    return 0;
+  }
+
+  size_t i = 0;
+  while (i < n) {
+    if (!_lexer->appendNextToken(_buffer)) {
+      // The lexer is waiting for more input, see Lexer::nextToken().
+      throw InputStarvedException("token source needs more input");
+    }
+
+    size_t last = _buffer.size() - 1;
+    if (_separateHidden) {
+      if (_buffer.getChannel(last) != _channel && _buffer.getType(last) != Token::EOF) {
+        _hidden.add(_buffer, last);
+        _buffer.removeLast();
+        continue;
+      }
+      if (_hidden.size() >= std::numeric_limits<uint32_t>::max()) {
+        throw IndexOutOfBoundsException("more than " + std::to_string(std::numeric_limits<uint32_t>::max() - 1) +
+                                        " hidden tokens");
+      }
+      _hiddenBefore.push_back(static_cast<uint32_t>(_hidden.size()));
+    }
+    ++i;
+
+    if (_buffer.getType(last) == Token::EOF) {
+      _fetchedEOF = true;
+      break;
+    }
+  }
+
+  return i;
+}
+
+Token* TokenBufferStream::getView(const TokenBuffer &buffer, std::vector<std::vector<TokenView>> &views, size_t i) {
+  size_t block = i / VIEW_BLOCK_SIZE;
+  while (views.size() <= block) {
+    views.emplace_back();
+    views.back().reserve(VIEW_BLOCK_SIZE); // Never reallocated, the views have stable addresses.
+  }
+
+  std::vector<TokenView> &blockViews = views[block];
+  while (blockViews.size() <= i % VIEW_BLOCK_SIZE) {
+    blockViews.emplace_back(&buffer, block * VIEW_BLOCK_SIZE + blockViews.size());
+  }
+  return &blockViews[i % VIEW_BLOCK_SIZE];
+}
+
+std::vector<Token *> TokenBufferStream::filterForChannel(const TokenBuffer &buffer,
+  std::vector<std::vector<TokenView>> &views, size_t from, size_t to, ssize_t channel) const {
+  std::vector<Token *> hidden;
+  for (size_t i = from; i < to; i++) {
+    size_t tokenChannel = buffer.getChannel(i);
+    if (channel == -1 ? tokenChannel != _channel : tokenChannel == static_cast<size_t>(channel)) {
+      hidden.push_back(getView(buffer, views, i));
+    }
+  }
+  return hidden;
+}
+
+void TokenBufferStream::lazyInit() {
+  if (_needSetup) {
+    _needSetup = false;
+    sync(0);
+    _p = nextTokenOnChannel(0);
+  }
+}
+
+size_t TokenBufferStream::nextTokenOnChannel(size_t i) {
+  sync(i);
+  if (i >= _buffer.size()) {
+    return _buffer.size() - 1;
+  }
+
+  while (_buffer.getChannel(i) != _channel) {
+    if (_buffer.getType(i) == Token::EOF) {
+      return i;
+    }
+    i++;
+    sync(i);
+  }
+  return i;
+}
+
+ssize_t TokenBufferStream::previousTokenOnChannel(size_t i) {
+  sync(i);
+  if (i >= _buffer.size()) {
+    // the EOF token is on every channel
+    return _buffer.size() - 1;
+  }
+
+  while (true) {
+    if (_buffer.getType(i) == Token::EOF || _buffer.getChannel(i) == _channel) {
+      return i;
+    }
+
+    if (i == 0)
+      return -1;
+    i--;
+  }
+}
@@ -0,0 +1,128 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "TokenBuffer.h"
+#include "TokenStream.h"
+
+namespace antlr4 {
+
+  /// A channel filtering token stream like <seealso cref="CommonTokenStream"/>, which stores its tokens
+  /// in a <seealso cref="TokenBuffer"/>. Tokens are lexed on demand via <seealso cref="Lexer#appendNextToken"/>,
+  /// so no token objects are allocated while lexing. The <seealso cref="Token"/> pointers handed out by
+  /// get() and LT() are <seealso cref="TokenView"/>s, created in blocks for the tokens actually accessed
+  /// and valid for the lifetime of the stream.
+  ///
+  /// As for CommonTokenStream, the channel filtering only applies to LA(), LT() and LB().
+  ///
+  /// With setSeparateHiddenTokens(), tokens not on the channel (typically whitespace and comments)
+  /// are moved to a second buffer instead. Lookahead then never steps over them, while they remain
+  /// available through getHiddenTokensToLeft() and getHiddenTokensToRight().
+  class ANTLR4CPP_PUBLIC TokenBufferStream : public TokenStream {
+  public:
+    /// See <seealso cref="TokenBuffer#TokenBuffer"/> for {@code copyText}.
+    TokenBufferStream(Lexer *lexer, size_t channel = Token::DEFAULT_CHANNEL, bool copyText = false);
+
+    /// A stream over tokens lexed before, e.g. loaded by <seealso cref="SerializedParseResult#loadTokens"/>.
+    /// {@code tokens} must end with an EOF token. The stream has no lexer, and getTokenSource() returns
+    /// the token source of the buffer.
+    explicit TokenBufferStream(TokenBuffer tokens, size_t channel = Token::DEFAULT_CHANNEL);
+    TokenBufferStream(const TokenBufferStream &other) = delete;
+
+    TokenBufferStream& operator = (const TokenBufferStream &other) = delete;
+
+    virtual TokenSource* getTokenSource() const override;
+    virtual size_t index() override;
+    virtual ssize_t mark() override;
+    virtual void release(ssize_t marker) override;
+    virtual void reset();
+    virtual void seek(size_t index) override;
+    virtual size_t size() override;
+    virtual void consume() override;
+
+    virtual Token* get(size_t i) const override;
+    virtual size_t LA(ssize_t i) override;
+    virtual Token* LT(ssize_t k) override;
+
+    virtual std::string getSourceName() const override;
+    virtual std::string getText() override;
+    virtual std::string getText(const misc::Interval &interval) override;
+    virtual std::string getText(RuleContext *ctx) override;
+    virtual std::string getText(Token *start, Token *stop) override;
+
+    /// Lex all remaining tokens.
+    virtual void fill();
+
+    /// The tokens lexed so far.
+    const TokenBuffer& getBuffer() const;
+
+    /// Store tokens which are not on the channel of this stream in a separate buffer. They do not get
+    /// an index in this stream then, and get() and getText() only see the tokens on the channel
+    /// (getText() includes the text of the hidden tokens in between, though). Must be called before
+    /// any token is read, and is not supported for streams over given tokens.
+    ///
+    /// The token index of a hidden token is its index in getHiddenBuffer(), which is also the index of
+    /// some token of this stream. Do not pass it to get() or getText().
+    virtual void setSeparateHiddenTokens(bool separate);
+
+    /// The off-channel tokens if they are stored separately, see setSeparateHiddenTokens().
+    const TokenBuffer& getHiddenBuffer() const;
+
+    /// Collect all tokens on the specified channel to the right of the current token up until we see
+    /// a token on the channel of this stream or EOF. If {@code channel} is -1, find any off-channel token.
+    /// See setSeparateHiddenTokens() for the token indexes of the result.
+    virtual std::vector<Token *> getHiddenTokensToRight(size_t tokenIndex, ssize_t channel);
+    virtual std::vector<Token *> getHiddenTokensToRight(size_t tokenIndex);
+
+    /// Collect all tokens on the specified channel to the left of the current token up until we see
+    /// a token on the channel of this stream. If {@code channel} is -1, find any off-channel token.
+    virtual std::vector<Token *> getHiddenTokensToLeft(size_t tokenIndex, ssize_t channel);
+    virtual std::vector<Token *> getHiddenTokensToLeft(size_t tokenIndex);
+
+  protected:
+    static constexpr size_t VIEW_BLOCK_SIZE = 1024;
+
+    Lexer *_lexer;
+    size_t _channel;
+    TokenBuffer _buffer;
+
+    /// Index into the buffer of the current token, always on the channel (or EOF).
+    size_t _p;
+    bool _needSetup;
+    bool _fetchedEOF;
+
+    /// The token views handed out so far, indexed by (token index / VIEW_BLOCK_SIZE).
+    mutable std::vector<std::vector<TokenView>> _views;
+
+    bool _separateHidden;
+    TokenBuffer _hidden;
+    mutable std::vector<std::vector<TokenView>> _hiddenViews;
+
+    /// For each token in the buffer, the number of hidden tokens lexed before it.
+    std::vector<uint32_t> _hiddenBefore;
+
+    static Token* getView(const TokenBuffer &buffer, std::vector<std::vector<TokenView>> &views, size_t i);
+
+    /// The tokens of {@code buffer} with indexes [from, to) on {@code channel}, or on any channel
+    /// but that of this stream if {@code channel} is -1.
+    std::vector<Token *> filterForChannel(const TokenBuffer &buffer, std::vector<std::vector<TokenView>> &views,
+                                          size_t from, size_t to, ssize_t channel) const;
+
+    /// The buffer index of the token LT(k) returns, or -1 if there is none.
+    ssize_t lookahead(ssize_t k);
+
+    /// Make sure index {@code i} is in the buffer. Returns false if the buffer ends (with EOF) before.
+    bool sync(size_t i);
+
+    /// Add {@code n} tokens to the buffer, returns the number actually added.
+    size_t fetch(size_t n);
+
+    void lazyInit();
+    size_t nextTokenOnChannel(size_t i);
+    ssize_t previousTokenOnChannel(size_t i);
+  };
+
+} // namespace antlr4
@@ -16,7 +16,10 @@
 #include "BailErrorStrategy.h"
 #include "BaseErrorListener.h"
 #include "BufferedTokenStream.h"
+#include "CancellationToken.h"
+#include "CaseFoldingInputStream.h"
 #include "CharStream.h"
+#include "CodePointStream.h"
 #include "CommonToken.h"
 #include "CommonTokenFactory.h"
 #include "CommonTokenStream.h"
@@ -25,24 +28,34 @@
 #include "DiagnosticErrorListener.h"
 #include "Exceptions.h"
 #include "FailedPredicateException.h"
+#include "IncrementalLexer.h"
+#include "IncrementalParse.h"
 #include "InputMismatchException.h"
 #include "IntStream.h"
 #include "InterpreterRuleContext.h"
+#include "KeywordTable.h"
 #include "Lexer.h"
 #include "LexerInterpreter.h"
 #include "LexerNoViableAltException.h"
 #include "ListTokenSource.h"
 #include "NoViableAltException.h"
+#include "ParallelTokenizer.h"
 #include "Parser.h"
 #include "ParserInterpreter.h"
 #include "ParserRuleContext.h"
 #include "ProxyErrorListener.h"
+#include "PushCharStream.h"
 #include "RecognitionException.h"
 #include "Recognizer.h"
+#include "ResumableParse.h"
 #include "RuleContext.h"
 #include "RuleContextWithAltNum.h"
 #include "RuntimeMetaData.h"
+#include "SerializedParseResult.h"
+#include "SlabTokenFactory.h"
 #include "Token.h"
+#include "TokenBuffer.h"
+#include "TokenBufferStream.h"
 #include "TokenFactory.h"
 #include "TokenSource.h"
 #include "TokenStream.h"
@@ -126,6 +139,7 @@
 #include "dfa/DFASerializer.h"
 #include "dfa/DFAState.h"
 #include "dfa/LexerDFASerializer.h"
+#include "dfa/LexerDFATable.h"
 #include "misc/InterpreterDataReader.h"
 #include "misc/Interval.h"
 #include "misc/IntervalSet.h"
@@ -137,9 +151,13 @@
 #include "support/Casts.h"
 #include "support/CPPUtils.h"
 #include "tree/AbstractParseTreeVisitor.h"
+#include "tree/DenseParseTreeProperty.h"
 #include "tree/ErrorNode.h"
 #include "tree/ErrorNodeImpl.h"
+#include "tree/FlatParseTree.h"
+#include "tree/ParallelParseTreeWalker.h"
 #include "tree/ParseTree.h"
+#include "tree/ParseTreeArena.h"
 #include "tree/ParseTreeListener.h"
 #include "tree/ParseTreeProperty.h"
 #include "tree/ParseTreeVisitor.h"
@@ -147,6 +165,7 @@
 #include "tree/TerminalNode.h"
 #include "tree/TerminalNodeImpl.h"
 #include "tree/Trees.h"
+#include "tree/TypedParseTreeVisitor.h"
 #include "tree/pattern/Chunk.h"
 #include "tree/pattern/ParseTreeMatch.h"
 #include "tree/pattern/ParseTreePattern.h"
@@ -3,6 +3,11 @@
  * can be found in the LICENSE.txt file in the project root.
  */
 
+#include <typeinfo>
+
+#include "ANTLRInputStream.h"
+#include "CaseFoldingInputStream.h"
+#include "CodePointStream.h"
 #include "IntStream.h"
 #include "atn/OrderedATNConfigSet.h"
 #include "Token.h"
@@ -12,10 +17,15 @@
 #include "atn/SingletonPredictionContext.h"
 #include "atn/PredicateTransition.h"
 #include "atn/ActionTransition.h"
+#include "atn/AtomTransition.h"
+#include "atn/RangeTransition.h"
+#include "atn/SetTransition.h"
 #include "atn/TokensStartState.h"
 #include "misc/Interval.h"
 #include "dfa/DFA.h"
+#include "dfa/LexerDFATable.h"
 #include "Lexer.h"
+#include "PushCharStream.h"
 #include "internal/Synchronization.h"
 
 #include "dfa/DFAState.h"
@@ -66,23 +76,57 @@ size_t LexerATNSimulator::match(CharStream *input, size_t mode) {
     input->release(mark);
   });
 
-  _startIndex = input->index();
-  _prevAccept.reset();
-  const dfa::DFA &dfa = _decisionToDFA[mode];
-  dfa::DFAState* s0;
-  {
-    SharedLock<SharedMutex> stateLock(atn._stateMutex);
-    s0 = dfa.s0;
-  }
-  if (s0 == nullptr) {
-    return matchATN(input);
+  size_t ttype;
+  if (_suspendedState != nullptr) {
+    // Continue the token which ran out of input in the previous call.
+    dfa::DFAState *s = _suspendedState;
+    _suspendedState = nullptr;
+    ttype = execATN(input, s);
+  } else if (_suspendedTableState != dfa::LexerDFATable::ERROR_STATE) {
+    uint32_t s = _suspendedTableState;
+    _suspendedTableState = dfa::LexerDFATable::ERROR_STATE;
+    ttype = execTable(input, s);
   } else {
-    return execATN(input, s0);
+    ttype = matchToken(input);
   }
+
+  // A token skipped on the fast path (see setFastSkip()) did not run any lexer action, so the lexer
+  // state is still that of a fresh token and the next token can be matched right away. Tokens
+  // continuing a MORE token and the end of input are left to the lexer.
+  while (ttype == Lexer::SKIP && _recog != nullptr && _recog->tokenStartCharIndex == _startIndex &&
+         input->LA(1) != Token::EOF) {
+    _recog->tokenStartCharIndex = input->index();
+    _recog->tokenStartLine = _line;
+    _recog->tokenStartCharPositionInLine = _charPositionInLine;
+    ttype = matchToken(input);
+  }
+
+  return ttype;
+}
+
+void LexerATNSimulator::setFastSkip(bool enable) {
+  _fastSkip = enable;
+}
+
+bool LexerATNSimulator::isFastSkip() const {
+  return _fastSkip;
+}
+
+void LexerATNSimulator::setDFATable(const dfa::LexerDFATable *table) {
+  _dfaTable = table;
+  _suspendedState = nullptr;
+  _suspendedTableState = dfa::LexerDFATable::ERROR_STATE;
+}
+
+const dfa::LexerDFATable* LexerATNSimulator::getDFATable() const {
+  return _dfaTable;
 }
 
 void LexerATNSimulator::reset() {
   _prevAccept.reset();
+  _suspendedState = nullptr;
+  _tableAccept = dfa::LexerDFATable::ERROR_STATE;
+  _suspendedTableState = dfa::LexerDFATable::ERROR_STATE;
   _startIndex = 0;
   _line = 1;
   _charPositionInLine = 0;
@@ -97,6 +141,27 @@ void LexerATNSimulator::clearDFA() {
   }
 }
 
+size_t LexerATNSimulator::matchToken(CharStream *input) {
+  _startIndex = input->index();
+  _prevAccept.reset();
+  if (_dfaTable != nullptr) {
+    _tableAccept = dfa::LexerDFATable::ERROR_STATE;
+    return execTable(input, _dfaTable->getStartState(_mode));
+  }
+
+  const dfa::DFA &dfa = _decisionToDFA[_mode];
+  dfa::DFAState* s0;
+  {
+    SharedLock<SharedMutex> stateLock(atn._stateMutex);
+    s0 = dfa.s0;
+  }
+  if (s0 == nullptr) {
+    return matchATN(input);
+  } else {
+    return execATN(input, s0);
+  }
+}
+
 size_t LexerATNSimulator::matchATN(CharStream *input) {
   ATNState *startState = atn.modeToStartState[_mode];
 
@@ -113,6 +178,20 @@ size_t LexerATNSimulator::matchATN(CharStream *input) {
 }
 
 size_t LexerATNSimulator::execATN(CharStream *input, dfa::DFAState *ds0) {
+  // The direct loops bypass the virtual helpers below, so they are only used by this class itself.
+  if (typeid(*this) == typeid(LexerATNSimulator)) {
+    const std::type_info &streamType = typeid(*input);
+    if (streamType == typeid(ANTLRInputStream) || streamType == typeid(CaseFoldingInputStream)) {
+      return execATNDirect(static_cast<ANTLRInputStream *>(input), ds0);
+    }
+    if (streamType == typeid(PushCharStream)) {
+      return execATNDirect(static_cast<PushCharStream *>(input), ds0);
+    }
+    if (streamType == typeid(CodePointStream)) {
+      return execATNDirect(static_cast<CodePointStream *>(input), ds0);
+    }
+  }
+
   if (ds0->isAcceptState) {
     // allow zero-length tokens
     // ml: in Java code this method uses 3 params. The first is a member var of the class anyway (_prevAccept), so why pass it here?
@@ -121,8 +200,16 @@ size_t LexerATNSimulator::execATN(CharStream *input, dfa::DFAState *ds0) {
 
   size_t t = input->LA(1);
   dfa::DFAState *s = ds0; // s is current/from DFA state
+  size_t uncheckedCharacters = 0;
 
   while (true) { // while more work
+    if (t == PushCharStream::STARVED && (_prevAccept.dfaState == nullptr || canMatchMore(s))) {
+      // Not enough input yet to decide where the token ends. Suspend here; all the state needed
+      // to continue (s, _prevAccept, _startIndex, line and position) is kept in this simulator.
+      _suspendedState = s;
+      return Lexer::SUSPEND;
+    }
+
     // As we move src->trg, src->trg, we keep track of the previous trg to
     // avoid looking up the DFA state again, which is expensive.
     // If the previous target was already part of the DFA, we might
@@ -155,6 +242,10 @@ size_t LexerATNSimulator::execATN(CharStream *input, dfa::DFAState *ds0) {
     // end of the token.
     if (t != Token::EOF) {
       consume(input);
+      if (++uncheckedCharacters == CANCELLATION_CHECK_INTERVAL) {
+        uncheckedCharacters = 0;
+        checkCancellation();
+      }
     }
 
     if (target->isAcceptState) {
@@ -171,6 +262,287 @@ size_t LexerATNSimulator::execATN(CharStream *input, dfa::DFAState *ds0) {
   return failOrAccept(input, s->configs.get(), t);
 }
 
+template <typename Stream>
+size_t LexerATNSimulator::execATNDirect(Stream *input, dfa::DFAState *ds0) {
+  const char32_t *data;
+  size_t size;
+  size_t offset; // Absolute index of data[0].
+  size_t end;    // Returned for LA(1) past the buffer.
+  auto load = [&] {
+    std::u32string_view codePoints = input->getCodePoints();
+    data = codePoints.data();
+    size = codePoints.size();
+    if constexpr (std::is_same_v<Stream, PushCharStream>) {
+      offset = input->getBufferStartIndex();
+      end = input->isClosed() ? Token::EOF : PushCharStream::STARVED;
+    } else {
+      offset = 0;
+      end = Token::EOF;
+    }
+  };
+  load();
+
+  size_t p = input->index() - offset;
+  size_t line = _line;
+  size_t charPositionInLine = _charPositionInLine;
+
+  // Hands the local state back to the stream and the simulator, before leaving or calling out.
+  auto store = [&] {
+    input->seek(offset + p);
+    _line = line;
+    _charPositionInLine = charPositionInLine;
+  };
+  auto capture = [&](dfa::DFAState *state) {
+    _prevAccept.index = offset + p;
+    _prevAccept.line = line;
+    _prevAccept.charPos = charPositionInLine;
+    _prevAccept.dfaState = state;
+  };
+
+  if (ds0->isAcceptState) {
+    // allow zero-length tokens
+    capture(ds0);
+  }
+
+  size_t t = p < size ? data[p] : end;
+  dfa::DFAState *s = ds0;
+  size_t uncheckedCharacters = 0;
+  auto countCharacters = [&](size_t count) {
+    uncheckedCharacters += count;
+    if (uncheckedCharacters >= CANCELLATION_CHECK_INTERVAL) {
+      uncheckedCharacters = 0;
+      store();
+      checkCancellation();
+    }
+  };
+
+  while (true) {
+    if (t == PushCharStream::STARVED && (_prevAccept.dfaState == nullptr || canMatchMore(s))) {
+      store();
+      _suspendedState = s;
+      return Lexer::SUSPEND;
+    }
+
+    dfa::DFAState *target = LexerATNSimulator::getExistingTargetState(s, t);
+    if (target == nullptr) {
+      // Predicates evaluated while computing the target use the stream and the simulator.
+      store();
+      target = computeTargetState(input, s, t);
+      load();
+      p = input->index() - offset;
+      line = _line;
+      charPositionInLine = _charPositionInLine;
+    }
+
+    if (target == ERROR.get()) {
+      break;
+    }
+
+    if (t != Token::EOF) {
+      if (t == '\n') {
+        ++line;
+        charPositionInLine = 0;
+      } else {
+        ++charPositionInLine;
+      }
+      ++p;
+      countCharacters(1);
+    }
+
+    if (target->isAcceptState) {
+      capture(target);
+      if (t == Token::EOF) {
+        break;
+      }
+    }
+
+    t = p < size ? data[p] : end;
+    s = target;
+
+    if (s->hasSelfLoop(t)) {
+      // Consume the run of characters whose edges lead back to s, up to the next cancellation check.
+      uint64_t low = s->selfLoop[0].load(std::memory_order_relaxed);
+      uint64_t high = s->selfLoop[1].load(std::memory_order_relaxed);
+      size_t start = p;
+      size_t limit = std::min(size, p + (CANCELLATION_CHECK_INTERVAL - uncheckedCharacters));
+      while (p < limit) {
+        char32_t c = data[p];
+        if (c >= 128 || ((c < 64 ? low >> c : high >> (c - 64)) & 1) == 0) {
+          break;
+        }
+        ++p;
+      }
+
+      size_t lineStart = start;
+      size_t newlines = 0;
+      for (size_t i = start; i < p; ++i) {
+        if (data[i] == '\n') {
+          ++newlines;
+          lineStart = i + 1;
+        }
+      }
+      if (newlines > 0) {
+        line += newlines;
+        charPositionInLine = p - lineStart;
+      } else {
+        charPositionInLine += p - start;
+      }
+
+      if (s->isAcceptState) {
+        capture(s);
+      }
+      t = p < size ? data[p] : end;
+      countCharacters(p - start);
+    }
+  }
+
+  store();
+  return failOrAccept(input, s->configs.get(), t);
+}
+
+size_t LexerATNSimulator::execTable(CharStream *input, uint32_t s0) {
+  const std::type_info &streamType = typeid(*input);
+  if (streamType == typeid(ANTLRInputStream) || streamType == typeid(CaseFoldingInputStream)) {
+    return execTableLoop(static_cast<ANTLRInputStream *>(input), s0);
+  }
+  if (streamType == typeid(PushCharStream)) {
+    return execTableLoop(static_cast<PushCharStream *>(input), s0);
+  }
+  if (streamType == typeid(CodePointStream)) {
+    return execTableLoop(static_cast<CodePointStream *>(input), s0);
+  }
+  return execTableLoop(input, s0);
+}
+
+template <typename Stream>
+size_t LexerATNSimulator::execTableLoop(Stream *input, uint32_t s0) {
+  constexpr bool direct = !std::is_same_v<Stream, CharStream>;
+  const dfa::LexerDFATable &table = *_dfaTable;
+
+  const char32_t *data = nullptr;
+  size_t size = 0;
+  size_t offset = 0;
+  size_t end = Token::EOF;
+  size_t p = 0;
+  if constexpr (direct) {
+    std::u32string_view codePoints = input->getCodePoints();
+    data = codePoints.data();
+    size = codePoints.size();
+    if constexpr (std::is_same_v<Stream, PushCharStream>) {
+      offset = input->getBufferStartIndex();
+      end = input->isClosed() ? Token::EOF : PushCharStream::STARVED;
+    }
+    p = input->index() - offset;
+  }
+  size_t line = _line;
+  size_t charPositionInLine = _charPositionInLine;
+
+  auto lookahead = [&]() -> size_t {
+    if constexpr (direct) {
+      return p < size ? data[p] : end;
+    } else {
+      return input->LA(1);
+    }
+  };
+  auto position = [&]() -> size_t {
+    if constexpr (direct) {
+      return offset + p;
+    } else {
+      return input->index();
+    }
+  };
+  auto store = [&] {
+    if constexpr (direct) {
+      input->seek(offset + p);
+    }
+    _line = line;
+    _charPositionInLine = charPositionInLine;
+  };
+  auto capture = [&](uint32_t state) {
+    _prevAccept.index = position();
+    _prevAccept.line = line;
+    _prevAccept.charPos = charPositionInLine;
+    _tableAccept = state;
+  };
+
+  if (table.isAcceptState(s0)) {
+    capture(s0);
+  }
+
+  size_t t = lookahead();
+  uint32_t s = s0;
+  size_t uncheckedCharacters = 0;
+  while (true) {
+    if (t == PushCharStream::STARVED && (_tableAccept == dfa::LexerDFATable::ERROR_STATE || table.canMatchMore(s))) {
+      store();
+      _suspendedTableState = s;
+      return Lexer::SUSPEND;
+    }
+
+    uint32_t target = table.next(s, t);
+    if (target == dfa::LexerDFATable::ERROR_STATE) {
+      break;
+    }
+
+    if (t != Token::EOF) {
+      if (t == '\n') {
+        ++line;
+        charPositionInLine = 0;
+      } else {
+        ++charPositionInLine;
+      }
+      if constexpr (direct) {
+        ++p;
+      } else {
+        input->consume();
+      }
+      if (++uncheckedCharacters == CANCELLATION_CHECK_INTERVAL) {
+        uncheckedCharacters = 0;
+        store();
+        checkCancellation();
+      }
+    }
+
+    if (table.isAcceptState(target)) {
+      capture(target);
+      if (t == Token::EOF) {
+        break;
+      }
+    }
+
+    t = lookahead();
+    s = target;
+  }
+
+  store();
+  if (_tableAccept != dfa::LexerDFATable::ERROR_STATE) {
+    const Ref<const LexerActionExecutor> &lexerActionExecutor = table.getLexerActionExecutor(_tableAccept);
+    if (_fastSkip && isSkipOnly(lexerActionExecutor.get())) {
+      accept(input, nullptr, _startIndex, _prevAccept.index, _prevAccept.line, _prevAccept.charPos);
+      return Lexer::SKIP;
+    }
+
+    accept(input, lexerActionExecutor, _startIndex, _prevAccept.index, _prevAccept.line, _prevAccept.charPos);
+    return table.getPrediction(_tableAccept);
+  }
+
+  if (t == Token::EOF && input->index() == _startIndex) {
+    return Token::EOF;
+  }
+  throw LexerNoViableAltException(_recog, input, _startIndex, nullptr);
+}
+
+bool LexerATNSimulator::canMatchMore(dfa::DFAState *s) {
+  // Lexer closures only keep configurations in states with non-epsilon transitions
+  // or in rule stop states (see closure()).
+  for (const auto &config : s->configs->configs) {
+    if (!RuleStopState::is(config->state)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 dfa::DFAState *LexerATNSimulator::getExistingTargetState(dfa::DFAState *s, size_t t) {
   dfa::DFAState* retval = nullptr;
   SharedLock<SharedMutex> edgeLock(atn._edgeMutex);
@@ -189,6 +561,10 @@ dfa::DFAState *LexerATNSimulator::getExistingTargetState(dfa::DFAState *s, size_
 }
 
 dfa::DFAState *LexerATNSimulator::computeTargetState(CharStream *input, dfa::DFAState *s, size_t t) {
+  if (_recog != nullptr) {
+    _recog->checkCancellation();
+  }
+
   OrderedATNConfigSet *reach = new OrderedATNConfigSet(); /* mem-check: deleted on error or managed by new DFA state. */
 
   // if we don't find an existing DFA state
@@ -213,7 +589,13 @@ dfa::DFAState *LexerATNSimulator::computeTargetState(CharStream *input, dfa::DFA
 
 size_t LexerATNSimulator::failOrAccept(CharStream *input, ATNConfigSet *reach, size_t t) {
   if (_prevAccept.dfaState != nullptr) {
-    accept(input, _prevAccept.dfaState->lexerActionExecutor, _startIndex, _prevAccept.index, _prevAccept.line, _prevAccept.charPos);
+    const Ref<const LexerActionExecutor> &lexerActionExecutor = _prevAccept.dfaState->lexerActionExecutor;
+    if (_fastSkip && isSkipOnly(lexerActionExecutor.get())) {
+      accept(input, nullptr, _startIndex, _prevAccept.index, _prevAccept.line, _prevAccept.charPos);
+      return Lexer::SKIP;
+    }
+
+    accept(input, lexerActionExecutor, _startIndex, _prevAccept.index, _prevAccept.line, _prevAccept.charPos);
     return _prevAccept.dfaState->prediction;
   } else {
     // if no accept and EOF is first char, return EOF
@@ -225,6 +607,14 @@ size_t LexerATNSimulator::failOrAccept(CharStream *input, ATNConfigSet *reach, s
   }
 }
 
+bool LexerATNSimulator::isSkipOnly(const LexerActionExecutor *lexerActionExecutor) {
+  if (lexerActionExecutor == nullptr) {
+    return false;
+  }
+  const std::vector<Ref<const LexerAction>> &actions = lexerActionExecutor->getLexerActions();
+  return actions.size() == 1 && actions[0]->getActionType() == LexerActionType::SKIP;
+}
+
 void LexerATNSimulator::getReachableConfigSet(CharStream *input, ATNConfigSet *closure_, ATNConfigSet *reach, size_t t) {
   // this is used to skip processing for configs which have a lower priority
   // than a config that already reached an accept state for the same rule
@@ -283,11 +673,34 @@ void LexerATNSimulator::accept(CharStream *input, const Ref<const LexerActionExe
 }
 
 atn::ATNState *LexerATNSimulator::getReachableTarget(const Transition *trans, size_t t) {
-  if (trans->matches(t, Lexer::MIN_CHAR_VALUE, Lexer::MAX_CHAR_VALUE)) {
-    return trans->target;
+  // The character transitions are matched here directly, without a virtual call.
+  bool matches;
+  switch (trans->getTransitionType()) {
+    case TransitionType::ATOM:
+      matches = static_cast<const AtomTransition *>(trans)->_label == t;
+      break;
+
+    case TransitionType::RANGE: {
+      const RangeTransition *range = static_cast<const RangeTransition *>(trans);
+      matches = t >= range->from && t <= range->to;
+      break;
+    }
+
+    case TransitionType::SET:
+      matches = static_cast<const SetTransition *>(trans)->contains(t);
+      break;
+
+    case TransitionType::NOT_SET:
+      matches = t >= Lexer::MIN_CHAR_VALUE && t <= Lexer::MAX_CHAR_VALUE &&
+        !static_cast<const SetTransition *>(trans)->contains(t);
+      break;
+
+    default:
+      matches = trans->matches(t, Lexer::MIN_CHAR_VALUE, Lexer::MAX_CHAR_VALUE);
+      break;
   }
 
-  return nullptr;
+  return matches ? trans->target : nullptr;
 }
 
 std::unique_ptr<ATNConfigSet> LexerATNSimulator::computeStartState(CharStream *input, ATNState *p) {
@@ -521,6 +934,9 @@ void LexerATNSimulator::addDFAEdge(dfa::DFAState *p, size_t t, dfa::DFAState *q)
 
   UniqueLock<SharedMutex> edgeLock(atn._edgeMutex);
   p->edges[t - MIN_DFA_EDGE] = q; // connect
+  if (p == q) {
+    p->selfLoop[t >> 6].fetch_or(uint64_t(1) << (t & 63), std::memory_order_relaxed);
+  }
 }
 
 dfa::DFAState *LexerATNSimulator::addDFAState(ATNConfigSet *configs) {
@@ -595,6 +1011,12 @@ void LexerATNSimulator::setCharPositionInLine(size_t charPositionInLine) {
   _charPositionInLine = charPositionInLine;
 }
 
+void LexerATNSimulator::checkCancellation() {
+  if (_recog != nullptr) {
+    _recog->checkCancellation();
+  }
+}
+
 void LexerATNSimulator::consume(CharStream *input) {
   size_t curChar = input->LA(1);
   if (curChar == '\n') {
@@ -618,4 +1040,9 @@ void LexerATNSimulator::InitializeInstanceFields() {
   _line = 1;
   _charPositionInLine = 0;
   _mode = antlr4::Lexer::DEFAULT_MODE;
+  _suspendedState = nullptr;
+  _fastSkip = false;
+  _dfaTable = nullptr;
+  _tableAccept = dfa::LexerDFATable::ERROR_STATE;
+  _suspendedTableState = dfa::LexerDFATable::ERROR_STATE;
 }
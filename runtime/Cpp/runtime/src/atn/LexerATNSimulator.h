@@ -30,6 +30,10 @@ namespace atn {
     static constexpr size_t MIN_DFA_EDGE = 0;
     static constexpr size_t MAX_DFA_EDGE = 127; // forces unicode to stay in ATN
 
+    /// Within a token the cancellation token of the lexer is checked every this many characters,
+    /// so long tokens like comments cannot delay a cancellation.
+    static constexpr size_t CANCELLATION_CHECK_INTERVAL = 1024;
+
   protected:
     /// <summary>
     /// When we hit an accept state in either the DFA or the ATN, we
@@ -70,6 +74,21 @@ namespace atn {
     /// Used during DFA/ATN exec to record the most recent accept configuration info.
     SimState _prevAccept;
 
+    /// The DFA state reached when the input of a PushCharStream ran out in the middle of a token.
+    /// The next call to match() continues from here instead of starting a new token.
+    dfa::DFAState *_suspendedState;
+
+    /// See setFastSkip().
+    bool _fastSkip;
+
+    /// See setDFATable().
+    const dfa::LexerDFATable *_dfaTable;
+
+    /// When matching with _dfaTable: the table state of _prevAccept, and the state to continue a
+    /// suspended token from (like _suspendedState). LexerDFATable::ERROR_STATE if there is none.
+    uint32_t _tableAccept;
+    uint32_t _suspendedTableState;
+
   public:
     LexerATNSimulator(const ATN &atn, std::vector<dfa::DFA> &decisionToDFA, PredictionContextCache &sharedContextCache);
     LexerATNSimulator(Lexer *recog, const ATN &atn, std::vector<dfa::DFA> &decisionToDFA, PredictionContextCache &sharedContextCache);
@@ -81,10 +100,44 @@ namespace atn {
 
     virtual void clearDFA() override;
 
+    /// Tokens of rules whose only lexer command is {@code skip} normally go through the lexer action
+    /// executor and back to Lexer::nextToken(), which calls Lexer::skip() and then starts a new token.
+    /// With fast skip enabled, such tokens are dropped right here and matching continues with the next
+    /// token, so they cost nothing beyond the DFA traversal. Lexer::skip() is not called for them.
+    void setFastSkip(bool enable);
+    bool isFastSkip() const;
+
+    /// Match tokens with the complete DFA in {@code table} (see dfa::LexerDFATable) instead of the ATN
+    /// and the DFA built on demand. The table must have been built for the ATN of this simulator and
+    /// must outlive it. Pass null to switch back.
+    void setDFATable(const dfa::LexerDFATable *table);
+    const dfa::LexerDFATable* getDFATable() const;
+
   protected:
+    /// Match a token starting at the current input position.
+    size_t matchToken(CharStream *input);
+
     virtual size_t matchATN(CharStream *input);
     virtual size_t execATN(CharStream *input, dfa::DFAState *ds0);
 
+    /// execATN() for the stream types whose buffer can be read directly (ANTLRInputStream and
+    /// PushCharStream). The input position, line and column are kept in locals and characters are
+    /// read without virtual calls. Runs of characters looping on the current DFA state (see
+    /// dfa::DFAState::selfLoop) are consumed at once.
+    template <typename Stream>
+    size_t execATNDirect(Stream *input, dfa::DFAState *ds0);
+
+    /// execATN() over _dfaTable, starting in table state s0.
+    size_t execTable(CharStream *input, uint32_t s0);
+
+    /// Checks the cancellation token of the lexer, if there is one.
+    void checkCancellation();
+
+    /// The loop of execTable(). Reads the buffer directly like execATNDirect(), unless Stream is
+    /// CharStream. Line and column are always tracked here; consume() is not called.
+    template <typename Stream>
+    size_t execTableLoop(Stream *input, uint32_t s0);
+
     /// <summary>
     /// Get an existing target state for an edge in the DFA. If the target state
     /// for the edge has not yet been computed or is otherwise not available,
@@ -112,6 +165,13 @@ namespace atn {
 
     virtual size_t failOrAccept(CharStream *input, ATNConfigSet *reach, size_t t);
 
+    /// Returns true if any configuration of {@code s} can still consume input, i.e. the token
+    /// matched so far might get longer.
+    bool canMatchMore(dfa::DFAState *s);
+
+    /// Returns true if the only action of {@code lexerActionExecutor} is the {@code skip} command.
+    static bool isSkipOnly(const LexerActionExecutor *lexerActionExecutor);
+
     /// <summary>
     /// Given a starting configuration set, figure out all ATN configurations
     ///  we can reach upon input {@code t}. Parameter {@code reach} is a return
@@ -91,6 +91,11 @@ size_t ParserATNSimulator::adaptivePredict(TokenStream *input, size_t decision,
       << input->LT(1)->getLine() << ":" << input->LT(1)->getCharPositionInLine() << std::endl;
 #endif
 
+  // Nothing is changed yet, so a cancellation leaves the simulator as it was.
+  if (parser != nullptr) {
+    parser->checkCancellation();
+  }
+
   _input = input;
   _startIndex = input->index();
   _outerContext = outerContext;
@@ -364,7 +369,17 @@ size_t ParserATNSimulator::execATNWithFullContext(dfa::DFA &dfa, dfa::DFAState *
   size_t t = input->LA(1);
   size_t predictedAlt;
 
+  // The sets in between are owned here, also when the prediction is cancelled.
+  auto onExit = finally([&previous, s0] {
+    if (previous != s0) {
+      delete previous;
+    }
+  });
+
   while (true) {
+    if (parser != nullptr) {
+      parser->checkCancellation();
+    }
     reach = computeReachSet(previous, t, fullCtx);
     if (reach == nullptr) {
       // if any configs in previous dipped into outer context, that
@@ -377,8 +392,10 @@ size_t ParserATNSimulator::execATNWithFullContext(dfa::DFA &dfa, dfa::DFAState *
       // If conflict in states that dip out, choose min since we
       // will get error no matter what.
       NoViableAltException e = noViableAlt(input, outerContext, previous, startIndex, previous != s0);
+      ATNConfigSet *deadEndConfigs = previous;
+      previous = s0; // Owned by the exception now.
       input->seek(startIndex);
-      size_t alt = getSynValidOrSemInvalidAltThatFinishedDecisionEntryRule(previous, outerContext);
+      size_t alt = getSynValidOrSemInvalidAltThatFinishedDecisionEntryRule(deadEndConfigs, outerContext);
       if (alt != ATN::INVALID_ALT_NUMBER) {
         return alt;
       }
@@ -903,6 +920,10 @@ void ParserATNSimulator::closureCheckingStopState(Ref<ATNConfig> const& config,
 
 void ParserATNSimulator::closure_(Ref<ATNConfig> const& config, ATNConfigSet *configs, ATNConfig::Set &closureBusy,
                                   bool collectPredicates, bool fullCtx, int depth, bool treatEofAsEpsilon) {
+  if (parser != nullptr) {
+    parser->checkCancellation();
+  }
+
   ATNState *p = config->state;
   // optimization
   if (!p->epsilonOnlyTransitions) {
@@ -3,6 +3,8 @@
  * can be found in the LICENSE.txt file in the project root.
  */
 
+#include <algorithm>
+
 #include "Token.h"
 #include "misc/IntervalSet.h"
 
@@ -13,6 +15,7 @@ using namespace antlr4::atn;
 
 SetTransition::SetTransition(TransitionType transitionType, ATNState *target, misc::IntervalSet aSet)
   : Transition(transitionType, target), set(aSet.isEmpty() ? misc::IntervalSet::of(Token::INVALID_TYPE) : std::move(aSet)) {
+  buildTables();
 }
 
 misc::IntervalSet SetTransition::label() const {
@@ -20,9 +23,33 @@ misc::IntervalSet SetTransition::label() const {
 }
 
 bool SetTransition::matches(size_t symbol, size_t /*minVocabSymbol*/, size_t /*maxVocabSymbol*/) const {
-  return set.contains(symbol);
+  return contains(symbol);
 }
 
 std::string SetTransition::toString() const {
   return "SET " + Transition::toString() + " { set: " + set.toString() + "}";
 }
+
+void SetTransition::buildTables() {
+  std::vector<Block> bmp(256, Block());
+  for (const misc::Interval &interval : set.getIntervals()) {
+    ssize_t last = std::min<ssize_t>(interval.b, 0xFFFF);
+    for (ssize_t c = std::max<ssize_t>(interval.a, 0); c <= last; ++c) {
+      bmp[c >> 8][(c >> 6) & 3] |= uint64_t(1) << (c & 63);
+    }
+  }
+
+  _latin1 = bmp[0];
+  if (std::all_of(bmp.begin() + 1, bmp.end(), [](const Block &block) { return block == Block(); })) {
+    return;
+  }
+
+  _bmpIndex.resize(256);
+  for (size_t i = 1; i < bmp.size(); ++i) {
+    auto existing = std::find(_bmpBlocks.begin(), _bmpBlocks.end(), bmp[i]);
+    _bmpIndex[i] = static_cast<uint8_t>(existing - _bmpBlocks.begin());
+    if (existing == _bmpBlocks.end()) {
+      _bmpBlocks.push_back(bmp[i]);
+    }
+  }
+}
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "atn/Transition.h"
 
 namespace antlr4 {
@@ -30,8 +32,37 @@ namespace atn {
 
     virtual std::string toString() const override;
 
+    /// Same as set.contains(symbol), but answered from tables built with the transition for
+    /// Latin-1 and the rest of the BMP. Only supplementary code points search the set.
+    bool contains(size_t symbol) const {
+      if (symbol < 256) {
+        return testBit(_latin1, symbol);
+      }
+      if (symbol <= 0xFFFF) {
+        return !_bmpIndex.empty() && testBit(_bmpBlocks[_bmpIndex[symbol >> 8]], symbol & 0xFF);
+      }
+      return set.contains(symbol);
+    }
+
   protected:
     SetTransition(TransitionType transitionType, ATNState *target, misc::IntervalSet set);
+
+  private:
+    /// A bitmap of 256 consecutive code points.
+    using Block = std::array<uint64_t, 4>;
+
+    Block _latin1 = {};
+
+    /// Maps the high byte of a BMP code point to its block in _bmpBlocks, which holds every distinct
+    /// block only once. Empty if the set has no member in U+0100..U+FFFF.
+    std::vector<uint8_t> _bmpIndex;
+    std::vector<Block> _bmpBlocks;
+
+    static bool testBit(const Block &block, size_t bit) {
+      return (block[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    void buildTables();
   };
 
 } // namespace atn
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "antlr4-common.h"
 
 #include "atn/ATNConfigSet.h"
@@ -66,6 +68,10 @@ namespace dfa {
     //     Watch out: we no longer have the -1 offset, as it isn't needed anymore.
     FlatHashMap<size_t, DFAState*> edges;
 
+    /// Lexer DFA only: bitmap of the characters below 128 whose edge leads back to this state, so a
+    /// run of such characters can be consumed at once. Filled in as the edges are added.
+    std::atomic<uint64_t> selfLoop[2] = {};
+
     /// if accept state, what ttype do we match or alt do we predict?
     /// This is set to <seealso cref="ATN#INVALID_ALT_NUMBER"/> when <seealso cref="#predicates"/>{@code !=null} or
     /// <seealso cref="#requiresFullContext"/>.
@@ -113,6 +119,11 @@ namespace dfa {
     /// </summary>
     std::set<size_t> getAltSet() const;
 
+    /// Returns true if the edge for character {@code t} is known to lead back to this state.
+    bool hasSelfLoop(size_t t) const {
+      return t < 128 && ((selfLoop[t >> 6].load(std::memory_order_relaxed) >> (t & 63)) & 1) != 0;
+    }
+
     size_t hashCode() const;
 
     /// Two DFAState instances are equal if their ATN configuration sets
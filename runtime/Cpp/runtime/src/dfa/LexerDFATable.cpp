@@ -0,0 +1,449 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <map>
+#include <unordered_map>
+
+#include "CharStream.h"
+#include "Exceptions.h"
+#include "Lexer.h"
+#include "atn/ATN.h"
+#include "atn/ATNState.h"
+#include "atn/ATNType.h"
+#include "atn/AtomTransition.h"
+#include "atn/LexerATNConfig.h"
+#include "atn/LexerATNSimulator.h"
+#include "atn/LexerIndexedCustomAction.h"
+#include "atn/OrderedATNConfigSet.h"
+#include "atn/PredictionContextCache.h"
+#include "atn/RangeTransition.h"
+#include "atn/SetTransition.h"
+#include "atn/TokensStartState.h"
+#include "dfa/DFA.h"
+#include "misc/Interval.h"
+#include "support/Casts.h"
+
+#include "dfa/LexerDFATable.h"
+
+using namespace antlr4;
+using namespace antlr4::atn;
+using namespace antlr4::dfa;
+using namespace antlrcpp;
+
+namespace {
+
+  constexpr uint32_t SERIALIZED_VERSION = 2;
+  constexpr uint32_t NO_OFFSET = std::numeric_limits<uint32_t>::max();
+
+  /// Stands in for the input while building. Only the position matters: it is the number of
+  /// characters matched so far, which position dependent lexer actions record.
+  class DepthStream final : public CharStream {
+  public:
+    explicit DepthStream(size_t depth) : _depth(depth) {}
+
+    void consume() override {}
+    size_t LA(ssize_t /*i*/) override { return Token::EOF; }
+    ssize_t mark() override { return -1; }
+    void release(ssize_t /*marker*/) override {}
+    size_t index() override { return _depth; }
+    void seek(size_t /*index*/) override {}
+    size_t size() override { return 0; }
+    std::string getSourceName() const override { return UNKNOWN_SOURCE_NAME; }
+    std::string getText(const misc::Interval &/*interval*/) override { return ""; }
+    std::string toString() const override { return ""; }
+
+  private:
+    const size_t _depth;
+  };
+
+  struct BuilderData {
+    std::vector<DFA> decisionToDFA;
+    PredictionContextCache sharedContextCache;
+  };
+
+  /// Runs the closure operations of the simulator on behalf of LexerDFATable::build().
+  class Builder final : private BuilderData, public LexerATNSimulator {
+  public:
+    explicit Builder(const ATN &atn) : LexerATNSimulator(atn, decisionToDFA, sharedContextCache) {
+      for (size_t i = 0; i < atn.getNumberOfDecisions(); ++i) {
+        decisionToDFA.emplace_back(atn.getDecisionState(i), i);
+      }
+    }
+
+    DFAState* getStartState(size_t mode) {
+      _mode = mode;
+      DepthStream input(0);
+      std::unique_ptr<ATNConfigSet> configs = computeStartState(&input, atn.modeToStartState[mode]);
+      return addDFAState(configs.release(), true);
+    }
+
+    /// The state reached from s on t, with depth characters matched before t. Null if there is none.
+    DFAState* getTarget(size_t mode, DFAState *s, size_t t, size_t depth) {
+      _mode = mode;
+      DepthStream input(depth);
+      auto reach = std::make_unique<OrderedATNConfigSet>();
+      getReachableConfigSet(&input, s->configs.get(), reach.get(), t);
+      if (reach->isEmpty()) {
+        return nullptr;
+      }
+      return addDFAState(reach.release(), true);
+    }
+  };
+
+  /// The first code point of every range of code points which all transitions of the ATN treat alike.
+  std::vector<uint32_t> partitionAlphabet(const ATN &atn) {
+    std::vector<uint32_t> starts = { 0 };
+    auto addRange = [&starts](ssize_t a, ssize_t b) {
+      if (b < 0 || a > static_cast<ssize_t>(Lexer::MAX_CHAR_VALUE)) {
+        return;
+      }
+      starts.push_back(static_cast<uint32_t>(std::max<ssize_t>(a, 0)));
+      if (b < static_cast<ssize_t>(Lexer::MAX_CHAR_VALUE)) {
+        starts.push_back(static_cast<uint32_t>(b + 1));
+      }
+    };
+
+    for (const ATNState *state : atn.states) {
+      if (state == nullptr) {
+        continue;
+      }
+      for (const auto &transition : state->transitions) {
+        switch (transition->getTransitionType()) {
+          case TransitionType::PREDICATE:
+          case TransitionType::PRECEDENCE:
+            throw UnsupportedOperationException("cannot build the DFA of a lexer with predicates");
+
+          case TransitionType::ATOM: {
+            ssize_t label = static_cast<ssize_t>(static_cast<const AtomTransition *>(transition.get())->_label);
+            addRange(label, label);
+            break;
+          }
+
+          case TransitionType::RANGE: {
+            const RangeTransition *range = static_cast<const RangeTransition *>(transition.get());
+            addRange(static_cast<ssize_t>(range->from), static_cast<ssize_t>(range->to));
+            break;
+          }
+
+          case TransitionType::SET:
+          case TransitionType::NOT_SET:
+            for (const misc::Interval &interval : static_cast<const SetTransition *>(transition.get())->set.getIntervals()) {
+              addRange(interval.a, interval.b);
+            }
+            break;
+
+          default:
+            break;
+        }
+      }
+    }
+
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+    return starts;
+  }
+
+  /// Whether a configuration of the state carries an action whose offset was fixed while matching.
+  bool hasIndexedAction(const DFAState *state) {
+    for (const auto &config : state->configs->configs) {
+      const Ref<const LexerActionExecutor> &executor =
+        downCast<const LexerATNConfig&>(*config).getLexerActionExecutor();
+      if (executor == nullptr) {
+        continue;
+      }
+      for (const auto &action : executor->getLexerActions()) {
+        if (LexerIndexedCustomAction::is(*action)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /// A hash of the states, transitions and lexer actions of {@code atn}, which a serialized table is
+  /// checked against. It is computed on 32 bits, so it does not depend on the platform.
+  uint32_t fingerprint(const ATN &atn) {
+    uint32_t hash = 2166136261u;
+    auto update = [&hash](size_t value) {
+      hash = (hash ^ static_cast<uint32_t>(value)) * 16777619u;
+    };
+
+    update(atn.states.size());
+    for (const ATNState *state : atn.states) {
+      if (state == nullptr) {
+        update(ATNState::INVALID_STATE_NUMBER);
+        continue;
+      }
+      update(static_cast<size_t>(state->getStateType()));
+      update(state->ruleIndex);
+      update(state->transitions.size());
+      for (const auto &transition : state->transitions) {
+        update(static_cast<size_t>(transition->getTransitionType()));
+        update(transition->target->stateNumber);
+        misc::IntervalSet label = transition->label();
+        for (const misc::Interval &interval : label.getIntervals()) {
+          update(static_cast<size_t>(interval.a));
+          update(static_cast<size_t>(interval.b));
+        }
+      }
+    }
+    update(atn.lexerActions.size());
+    for (const auto &action : atn.lexerActions) {
+      update(static_cast<size_t>(action->getActionType()));
+    }
+    return hash;
+  }
+
+  uint32_t read(const std::vector<uint32_t> &data, size_t &p) {
+    if (p >= data.size()) {
+      throw IllegalArgumentException("the serialized lexer DFA is truncated");
+    }
+    return data[p++];
+  }
+
+}
+
+LexerDFATable LexerDFATable::build(const ATN &atn) {
+  if (atn.grammarType != ATNType::LEXER) {
+    throw IllegalArgumentException("the ATN is not a lexer ATN");
+  }
+
+  LexerDFATable table;
+  table.setClasses(partitionAlphabet(atn));
+  table._executors.push_back(nullptr);
+
+  // Subset construction. Row 0 is the error state.
+  Builder builder(atn);
+  std::unordered_map<DFAState *, uint32_t> ids;
+  std::vector<DFAState *> states = { nullptr };
+  std::vector<size_t> modes = { 0 };
+  std::vector<size_t> depths = { 0 };
+  std::vector<uint32_t> transitions(table._classCount, ERROR_STATE);
+
+  auto getId = [&](DFAState *state, size_t mode, size_t depth) {
+    auto [iterator, inserted] = ids.emplace(state, static_cast<uint32_t>(states.size()));
+    if (inserted) {
+      // The offsets of position dependent actions make the states at every depth distinct. A path
+      // longer than the ATN has states went through a loop, so there is no end to them.
+      if (depth > atn.states.size() && hasIndexedAction(state)) {
+        throw UnsupportedOperationException("cannot build the DFA of a lexer with actions inside or after a loop");
+      }
+      states.push_back(state);
+      modes.push_back(mode);
+      depths.push_back(depth);
+      transitions.resize(transitions.size() + table._classCount, ERROR_STATE);
+    }
+    return iterator->second;
+  };
+
+  std::vector<uint32_t> modeStarts;
+  for (size_t mode = 0; mode < atn.modeToStartState.size(); ++mode) {
+    modeStarts.push_back(getId(builder.getStartState(mode), mode, 0));
+  }
+
+  for (uint32_t id = 1; id < states.size(); ++id) {
+    for (size_t charClass = 0; charClass < table._classCount; ++charClass) {
+      size_t t = charClass < table._classStarts.size() ? table._classStarts[charClass] : Token::EOF;
+      DFAState *target = builder.getTarget(modes[id], states[id], t, depths[id]);
+      if (target != nullptr) {
+        transitions[id * table._classCount + charClass] = getId(target, modes[id], depths[id] + 1);
+      }
+    }
+  }
+
+  // Minimization: start with one block per distinct accept action, then split blocks whose
+  // states have transitions into different blocks until nothing changes.
+  size_t stateCount = states.size();
+  std::vector<uint32_t> block(stateCount);
+  std::vector<size_t> predictions(stateCount, Token::INVALID_TYPE);
+  std::vector<uint32_t> executorIndexes(stateCount, 0);
+  {
+    std::map<std::pair<size_t, uint32_t>, uint32_t> initial;
+    for (size_t i = 0; i < stateCount; ++i) {
+      if (states[i] != nullptr && states[i]->isAcceptState) {
+        predictions[i] = states[i]->prediction;
+        const Ref<const LexerActionExecutor> &executor = states[i]->lexerActionExecutor;
+        if (executor != nullptr) {
+          auto existing = std::find_if(table._executors.begin() + 1, table._executors.end(),
+            [&executor](const Ref<const LexerActionExecutor> &other) { return *other == *executor; });
+          executorIndexes[i] = static_cast<uint32_t>(existing - table._executors.begin());
+          if (existing == table._executors.end()) {
+            table._executors.push_back(executor);
+          }
+        }
+      }
+      block[i] = initial.emplace(std::make_pair(predictions[i], executorIndexes[i]),
+        static_cast<uint32_t>(initial.size())).first->second;
+    }
+  }
+
+  size_t blockCount = 0;
+  while (true) {
+    std::map<std::vector<uint32_t>, uint32_t> signatures;
+    std::vector<uint32_t> refined(stateCount);
+    std::vector<uint32_t> signature(table._classCount + 1);
+    for (size_t i = 0; i < stateCount; ++i) {
+      signature[0] = block[i];
+      for (size_t charClass = 0; charClass < table._classCount; ++charClass) {
+        signature[charClass + 1] = block[transitions[i * table._classCount + charClass]];
+      }
+      refined[i] = signatures.emplace(signature, static_cast<uint32_t>(signatures.size())).first->second;
+    }
+    block = std::move(refined);
+    if (signatures.size() == blockCount) {
+      break;
+    }
+    blockCount = signatures.size();
+  }
+
+  // Number the blocks so the error state stays state 0. Refinement numbers them by first occurrence,
+  // so the block of state 0 already is block 0.
+  table._transitions.assign(blockCount * table._classCount, ERROR_STATE);
+  table._predictions.assign(blockCount, Token::INVALID_TYPE);
+  table._executorIndexes.assign(blockCount, 0);
+  for (size_t i = 0; i < stateCount; ++i) {
+    uint32_t b = block[i];
+    table._predictions[b] = predictions[i];
+    table._executorIndexes[b] = executorIndexes[i];
+    for (size_t charClass = 0; charClass < table._classCount; ++charClass) {
+      table._transitions[b * table._classCount + charClass] = block[transitions[i * table._classCount + charClass]];
+    }
+  }
+  for (uint32_t start : modeStarts) {
+    table._modeStarts.push_back(block[start]);
+  }
+
+  return table;
+}
+
+LexerDFATable LexerDFATable::deserialize(const std::vector<uint32_t> &data, const ATN &atn) {
+  size_t p = 0;
+  if (read(data, p) != SERIALIZED_VERSION) {
+    throw IllegalArgumentException("unsupported serialized lexer DFA version");
+  }
+  if (read(data, p) != fingerprint(atn)) {
+    throw IllegalArgumentException("the serialized lexer DFA does not match the ATN");
+  }
+
+  LexerDFATable table;
+  std::vector<uint32_t> classStarts(read(data, p));
+  for (uint32_t &start : classStarts) {
+    start = read(data, p);
+  }
+  table.setClasses(std::move(classStarts));
+
+  table._modeStarts.resize(read(data, p));
+  if (table._modeStarts.size() != atn.modeToStartState.size()) {
+    throw IllegalArgumentException("the serialized lexer DFA does not match the ATN");
+  }
+  for (uint32_t &start : table._modeStarts) {
+    start = read(data, p);
+  }
+
+  size_t stateCount = read(data, p);
+  table._predictions.resize(stateCount);
+  table._executorIndexes.resize(stateCount);
+  for (size_t i = 0; i < stateCount; ++i) {
+    table._predictions[i] = read(data, p);
+    table._executorIndexes[i] = read(data, p);
+  }
+  table._transitions.resize(stateCount * table._classCount);
+  for (uint32_t &target : table._transitions) {
+    target = read(data, p);
+    if (target >= stateCount) {
+      throw IllegalArgumentException("the serialized lexer DFA is corrupt");
+    }
+  }
+
+  table._executors.push_back(nullptr);
+  size_t executorCount = read(data, p);
+  for (size_t i = 0; i < executorCount; ++i) {
+    std::vector<Ref<const LexerAction>> actions(read(data, p));
+    for (Ref<const LexerAction> &action : actions) {
+      uint32_t index = read(data, p);
+      uint32_t offset = read(data, p);
+      if (index >= atn.lexerActions.size()) {
+        throw IllegalArgumentException("the serialized lexer DFA does not match the ATN");
+      }
+      action = atn.lexerActions[index];
+      if (offset != NO_OFFSET) {
+        action = std::make_shared<LexerIndexedCustomAction>(static_cast<int>(offset), std::move(action));
+      }
+    }
+    table._executors.push_back(std::make_shared<LexerActionExecutor>(std::move(actions)));
+  }
+  for (uint32_t index : table._executorIndexes) {
+    if (index >= table._executors.size()) {
+      throw IllegalArgumentException("the serialized lexer DFA is corrupt");
+    }
+  }
+
+  return table;
+}
+
+LexerDFATable LexerDFATable::loadOrBuild(const std::vector<uint32_t> &data, const ATN &atn) {
+  try {
+    return deserialize(data, atn);
+  } catch (IllegalArgumentException &) {
+    return build(atn);
+  }
+}
+
+std::vector<uint32_t> LexerDFATable::serialize(const ATN &atn) const {
+  std::vector<uint32_t> data;
+  data.push_back(SERIALIZED_VERSION);
+  data.push_back(fingerprint(atn));
+  data.push_back(static_cast<uint32_t>(_classStarts.size()));
+  data.insert(data.end(), _classStarts.begin(), _classStarts.end());
+  data.push_back(static_cast<uint32_t>(_modeStarts.size()));
+  data.insert(data.end(), _modeStarts.begin(), _modeStarts.end());
+  data.push_back(static_cast<uint32_t>(getStateCount()));
+  for (size_t i = 0; i < getStateCount(); ++i) {
+    data.push_back(static_cast<uint32_t>(_predictions[i]));
+    data.push_back(_executorIndexes[i]);
+  }
+  data.insert(data.end(), _transitions.begin(), _transitions.end());
+
+  data.push_back(static_cast<uint32_t>(_executors.size() - 1));
+  for (size_t i = 1; i < _executors.size(); ++i) {
+    const std::vector<Ref<const LexerAction>> &actions = _executors[i]->getLexerActions();
+    data.push_back(static_cast<uint32_t>(actions.size()));
+    for (const Ref<const LexerAction> &action : actions) {
+      const LexerAction *plain = action.get();
+      uint32_t offset = NO_OFFSET;
+      if (LexerIndexedCustomAction::is(*action)) {
+        const LexerIndexedCustomAction &indexed = static_cast<const LexerIndexedCustomAction &>(*action);
+        plain = indexed.getAction().get();
+        offset = static_cast<uint32_t>(indexed.getOffset());
+      }
+      auto existing = std::find_if(atn.lexerActions.begin(), atn.lexerActions.end(),
+        [plain](const Ref<const LexerAction> &other) { return *other == *plain; });
+      if (existing == atn.lexerActions.end()) {
+        throw IllegalArgumentException("the lexer DFA was not built for this ATN");
+      }
+      data.push_back(static_cast<uint32_t>(existing - atn.lexerActions.begin()));
+      data.push_back(offset);
+    }
+  }
+  return data;
+}
+
+bool LexerDFATable::canMatchMore(uint32_t state) const {
+  auto row = _transitions.begin() + state * _classCount;
+  return std::any_of(row, row + _classCount, [](uint32_t target) { return target != ERROR_STATE; });
+}
+
+void LexerDFATable::setClasses(std::vector<uint32_t> classStarts) {
+  if (classStarts.empty() || classStarts[0] != 0 || !std::is_sorted(classStarts.begin(), classStarts.end())) {
+    throw IllegalArgumentException("invalid character classes");
+  }
+  _classStarts = std::move(classStarts);
+  _classCount = _classStarts.size() + 1;
+  _latin1Classes.resize(256);
+  for (uint32_t c = 0; c < 256; ++c) {
+    _latin1Classes[c] = static_cast<uint32_t>(std::upper_bound(_classStarts.begin(), _classStarts.end(), c) -
+      _classStarts.begin()) - 1;
+  }
+}
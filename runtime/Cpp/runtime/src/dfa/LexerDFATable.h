@@ -0,0 +1,103 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "Token.h"
+#include "atn/LexerActionExecutor.h"
+
+namespace antlr4 {
+namespace dfa {
+
+  /// The complete, minimized DFA of a lexer as a flat transition table, covering every mode.
+  ///
+  /// The lexer ATN simulator builds its DFA lazily, one edge at a time, and only caches edges for
+  /// ASCII characters. This table is instead built up front by exhaustive subset construction over
+  /// the same closure operation, so matching never falls back to the ATN. The alphabet is split into
+  /// classes of code points which no transition of the ATN distinguishes, which keeps the table small
+  /// even for grammars using large Unicode sets. A lexer uses it through
+  /// <seealso cref="atn::LexerATNSimulator#setDFATable"/>.
+  ///
+  /// Lexer predicates are evaluated while matching, so lexers which use them cannot be tabulated.
+  /// Lexer actions are supported as they are run after the token is matched, except for custom
+  /// actions inside or after a loop of a rule: their offset in the token has no upper bound.
+  class ANTLR4CPP_PUBLIC LexerDFATable final {
+  public:
+    /// The state without any outgoing transition. Matching stops when reaching it.
+    static constexpr uint32_t ERROR_STATE = 0;
+
+    /// Build the table for the given lexer ATN.
+    /// Throws an UnsupportedOperationException if the ATN contains predicates, or custom actions
+    /// inside or after a loop.
+    static LexerDFATable build(const atn::ATN &atn);
+
+    /// Load a table previously exported by serialize(). {@code atn} must be the ATN it was built for;
+    /// the lexer actions are restored from it. Throws an IllegalArgumentException if {@code data} is
+    /// corrupt or was exported for a different ATN.
+    static LexerDFATable deserialize(const std::vector<uint32_t> &data, const atn::ATN &atn);
+
+    /// Load {@code data} like deserialize(), or build() the table if the data does not fit
+    /// {@code atn}, e.g. because it was exported before the grammar changed. Generated lexers with
+    /// the lexerDFATableData option embed their exported table this way.
+    static LexerDFATable loadOrBuild(const std::vector<uint32_t> &data, const atn::ATN &atn);
+
+    /// Export the table, e.g. to embed it in generated code and skip build() at run time.
+    std::vector<uint32_t> serialize(const atn::ATN &atn) const;
+
+    size_t getStateCount() const { return _predictions.size(); }
+
+    /// The number of character classes, including the class of EOF.
+    size_t getClassCount() const { return _classCount; }
+
+    uint32_t getStartState(size_t mode) const { return _modeStarts[mode]; }
+
+    /// The state reached from {@code state} on the code point (or EOF) {@code symbol}.
+    uint32_t next(uint32_t state, size_t symbol) const {
+      size_t charClass;
+      if (symbol < 256) {
+        charClass = _latin1Classes[symbol];
+      } else if (symbol <= 0x10FFFF) {
+        charClass = static_cast<size_t>(std::upper_bound(_classStarts.begin(), _classStarts.end(), symbol) -
+          _classStarts.begin()) - 1;
+      } else if (symbol == Token::EOF) {
+        charClass = _classCount - 1;
+      } else {
+        return ERROR_STATE;
+      }
+      return _transitions[state * _classCount + charClass];
+    }
+
+    bool isAcceptState(uint32_t state) const { return _predictions[state] != Token::INVALID_TYPE; }
+
+    /// The token type matched when stopping in {@code state}, if it is an accept state.
+    size_t getPrediction(uint32_t state) const { return _predictions[state]; }
+
+    const Ref<const atn::LexerActionExecutor>& getLexerActionExecutor(uint32_t state) const {
+      return _executors[_executorIndexes[state]];
+    }
+
+    /// Whether any transition leaves {@code state}.
+    bool canMatchMore(uint32_t state) const;
+
+  private:
+    /// The first code point of each character class, in ascending order. The class of EOF is not included.
+    std::vector<uint32_t> _classStarts;
+    std::vector<uint32_t> _latin1Classes;
+    size_t _classCount = 0;
+
+    /// _classCount entries per state.
+    std::vector<uint32_t> _transitions;
+    std::vector<uint32_t> _modeStarts;
+    std::vector<size_t> _predictions;
+
+    /// Entry 0 is null, for states without actions.
+    std::vector<uint32_t> _executorIndexes;
+    std::vector<Ref<const atn::LexerActionExecutor>> _executors;
+
+    void setClasses(std::vector<uint32_t> classStarts);
+  };
+
+} // namespace dfa
+} // namespace antlr4
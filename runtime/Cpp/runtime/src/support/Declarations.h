@@ -13,20 +13,27 @@ namespace antlr4 {
   class BailErrorStrategy;
   class BaseErrorListener;
   class BufferedTokenStream;
+  class CancellationToken;
+  class CaseFoldingInputStream;
   class CharStream;
+  class CodePointStream;
   class CommonToken;
   class CommonTokenFactory;
   class CommonTokenStream;
   class ConsoleErrorListener;
+  class DeadlineExceededException;
   class DefaultErrorStrategy;
   class DiagnosticErrorListener;
   class EmptyStackException;
   class FailedPredicateException;
   class IllegalArgumentException;
   class IllegalStateException;
+  class IncrementalLexer;
+  class IncrementalParse;
   class InputMismatchException;
   class IntStream;
   class InterpreterRuleContext;
+  class KeywordTable;
   class Lexer;
   class LexerInterpreter;
   class LexerNoViableAltException;
@@ -34,19 +41,28 @@ namespace antlr4 {
   class NoSuchElementException;
   class NoViableAltException;
   class NullPointerException;
+  class OperationCancelledException;
+  class ParallelTokenizer;
   class ParseCancellationException;
   class Parser;
   class ParserInterpreter;
   class ParserRuleContext;
   class ProxyErrorListener;
+  class PushCharStream;
   class RecognitionException;
   class Recognizer;
+  class ResumableParse;
   class RuleContext;
+  class SerializedParseResult;
+  class SlabTokenFactory;
   class Token;
+  class TokenBuffer;
+  class TokenBufferStream;
   template<typename Symbol> class TokenFactory;
   class TokenSource;
   class TokenStream;
   class TokenStreamRewriter;
+  class TokenView;
   class UnbufferedCharStream;
   class UnbufferedTokenStream;
   class WritableToken;
@@ -118,13 +134,18 @@ namespace antlr4 {
     class DFASerializer;
     class DFAState;
     class LexerDFASerializer;
+    class LexerDFATable;
     class Vocabulary;
   }
   namespace tree {
     class AbstractParseTreeVisitor;
+    template<typename V> class DenseParseTreeProperty;
     class ErrorNode;
     class ErrorNodeImpl;
+    class FlatParseTree;
+    class ParallelParseTreeWalker;
     class ParseTree;
+    class ParseTreeArena;
     class ParseTreeListener;
     template<typename T> class ParseTreeProperty;
     class ParseTreeVisitor;
@@ -134,6 +155,7 @@ namespace antlr4 {
     class TerminalNodeImpl;
     class Tree;
     class Trees;
+    template<typename Result> class TypedParseTreeVisitor;
 
     namespace pattern {
       class Chunk;
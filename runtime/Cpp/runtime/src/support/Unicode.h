@@ -17,6 +17,13 @@ namespace antlrcpp {
       return codePoint < 0xd800 || (codePoint > 0xdfff && codePoint <= 0x10ffff);
     }
 
+    /// Returns the simple case folding of the code point (mostly its lowercase form), or the code point
+    /// itself if it has none. Folds that expand to several code points (like U+00DF to "ss") are not applied.
+    static char32_t foldCase(char32_t codePoint);
+
+    /// Returns the simple uppercase mapping of the code point, or the code point itself if it has none.
+    static char32_t toUpper(char32_t codePoint);
+
   private:
     Unicode() = delete;
     Unicode(const Unicode&) = delete;
@@ -0,0 +1,69 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "tree/ParseTree.h"
+#include "tree/ParseTreeProperty.h"
+
+namespace antlr4 {
+namespace tree {
+
+  /// A <seealso cref="ParseTreeProperty"/> which stores the values in a vector indexed by
+  /// <seealso cref="ParseTree#getNodeId"/>, so get() and put() take constant time and the values of
+  /// neighbouring nodes are close together in memory. The vector grows up to the largest node id
+  /// used. Nodes which were not created by a <seealso cref="ParseTreeTracker"/> have no node id, their
+  /// values are kept in the map of the base class.
+  ///
+  /// All nodes must come from the same tracker, or from trackers whose node ids do not overlap.
+  template<typename V>
+  class ANTLR4CPP_PUBLIC DenseParseTreeProperty : public ParseTreeProperty<V> {
+  public:
+    DenseParseTreeProperty() = default;
+
+    /// Make room for the nodes created by {@code tracker} so far.
+    explicit DenseParseTreeProperty(const ParseTreeTracker &tracker) {
+      _values.reserve(tracker.getNodeIdLimit());
+    }
+
+    virtual V get(ParseTree *node) override {
+      size_t id = node->getNodeId();
+      if (id == INVALID_INDEX) {
+        return ParseTreeProperty<V>::get(node);
+      }
+      return id < _values.size() ? _values[id] : V();
+    }
+
+    virtual void put(ParseTree *node, V value) override {
+      size_t id = node->getNodeId();
+      if (id == INVALID_INDEX) {
+        ParseTreeProperty<V>::put(node, std::move(value));
+        return;
+      }
+      if (id >= _values.size()) {
+        _values.resize(id + 1);
+      }
+      _values[id] = std::move(value);
+    }
+
+    virtual V removeFrom(ParseTree *node) override {
+      size_t id = node->getNodeId();
+      if (id == INVALID_INDEX) {
+        return ParseTreeProperty<V>::removeFrom(node);
+      }
+      if (id >= _values.size()) {
+        return V();
+      }
+      V value = std::move(_values[id]);
+      _values[id] = V();
+      return value;
+    }
+
+  protected:
+    std::vector<V> _values;
+  };
+
+} // namespace tree
+} // namespace antlr4
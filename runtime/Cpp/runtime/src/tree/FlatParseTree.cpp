@@ -0,0 +1,260 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "CommonToken.h"
+#include "CommonTokenFactory.h"
+#include "InterpreterRuleContext.h"
+#include "Parser.h"
+#include "Token.h"
+#include "TokenFactory.h"
+#include "TokenSource.h"
+#include "TokenStream.h"
+#include "Vocabulary.h"
+#include "atn/ATNState.h"
+#include "tree/ErrorNode.h"
+#include "tree/TerminalNode.h"
+
+#include "tree/FlatParseTree.h"
+
+using namespace antlr4;
+using namespace antlr4::tree;
+
+FlatParseTree::Cursor::Cursor(const FlatParseTree &tree) : _tree(&tree), _index(0), _depth(0) {
+}
+
+bool FlatParseTree::Cursor::gotoFirstChild() {
+  size_t child = _tree->getFirstChild(_index);
+  if (child == NO_NODE) {
+    return false;
+  }
+  _index = child;
+  ++_depth;
+  return true;
+}
+
+bool FlatParseTree::Cursor::gotoNextSibling() {
+  size_t sibling = _tree->getNextSibling(_index);
+  if (sibling == NO_NODE) {
+    return false;
+  }
+  _index = sibling;
+  return true;
+}
+
+bool FlatParseTree::Cursor::gotoParent() {
+  size_t parent = _tree->getParent(_index);
+  if (parent == NO_NODE) {
+    return false;
+  }
+  _index = parent;
+  --_depth;
+  return true;
+}
+
+bool FlatParseTree::Cursor::gotoNext() {
+  size_t next = _index + 1;
+  if (next >= _tree->size()) {
+    return false;
+  }
+
+  // Climb up to the siblings of the next node. Over a whole walk this is one step per node.
+  size_t parent = _tree->getParent(next);
+  if (parent == _index) {
+    ++_depth;
+  } else {
+    for (size_t node = _index; _tree->getParent(node) != parent; node = _tree->getParent(node)) {
+      --_depth;
+    }
+  }
+  _index = next;
+  return true;
+}
+
+size_t FlatParseTree::getChildCount(size_t index) const {
+  size_t count = 0;
+  for (size_t child = getFirstChild(index); child != NO_NODE; child = getNextSibling(child)) {
+    ++count;
+  }
+  return count;
+}
+
+size_t FlatParseTree::getMemoryUsage() const {
+  return _nodes.capacity() * sizeof(Node);
+}
+
+ParserRuleContext* FlatParseTree::toParseTree(Parser &parser, const ContextFactory &createContext) {
+  if (empty()) {
+    return nullptr;
+  }
+
+  TokenStream *tokens = parser.getTokenStream();
+  ParseTreeTracker &tracker = parser.getTreeTracker();
+  _missingTokens.clear();
+
+  ParserRuleContext *root = nullptr;
+  std::vector<std::pair<ParserRuleContext *, size_t>> open; // Contexts and the end of their subtree.
+  size_t withoutStart = 0; // Open contexts from this one on did not see a token yet.
+  Token *lastToken = nullptr;
+
+  auto close = [&] {
+    ParserRuleContext *ctx = open.back().first;
+    if (ctx->start == nullptr) {
+      // An empty rule starts at the next token on the default channel.
+      size_t index = lastToken == nullptr ? 0 : lastToken->getTokenIndex() + 1;
+      Token *next = tokens->get(index);
+      while (next->getChannel() != Token::DEFAULT_CHANNEL && next->getType() != Token::EOF) {
+        next = tokens->get(++index);
+      }
+      ctx->start = next;
+    }
+    ctx->stop = lastToken;
+    open.pop_back();
+    withoutStart = std::min(withoutStart, open.size());
+  };
+
+  for (size_t i = 0; i < _nodes.size(); ++i) {
+    while (!open.empty() && open.back().second <= i) {
+      close();
+    }
+
+    const Node &node = _nodes[i];
+    ParserRuleContext *parent = open.empty() ? nullptr : open.back().first;
+    switch (node.kind) {
+      case Kind::RULE: {
+        ParserRuleContext *ctx;
+        if (createContext) {
+          ctx = createContext(parent, node.value, node.altNumber);
+        } else {
+          ctx = tracker.createInstance<InterpreterRuleContext>(parent, atn::ATNState::INVALID_STATE_NUMBER, node.value);
+          ctx->setAltNumber(node.altNumber);
+        }
+        ctx->parent = parent;
+        if (parent != nullptr) {
+          parent->addChild(ctx);
+        } else {
+          root = ctx;
+        }
+        open.push_back({ ctx, i + node.size });
+        break;
+      }
+
+      case Kind::TOKEN:
+      case Kind::ERROR: {
+        Token *token = tokens->get(node.value);
+        parent->addChild(node.kind == Kind::TOKEN ? parser.createTerminalNode(token) : parser.createErrorNode(token));
+        for (; withoutStart < open.size(); ++withoutStart) {
+          open[withoutStart].first->start = token;
+        }
+        lastToken = token;
+        break;
+      }
+
+      case Kind::MISSING: {
+        // Placed like the token conjured up by DefaultErrorStrategy. Tokens of an invalid type stand
+        // for the token at which ParserInterpreter could not predict an alternative.
+        size_t type = node.value;
+        Token *current = tokens->get(lastToken == nullptr ? 0 : lastToken->getTokenIndex() + 1);
+        std::string text;
+        if (type == Token::INVALID_TYPE) {
+          text = current->getText();
+        } else if (type == Token::EOF) {
+          text = "<missing EOF>";
+        } else {
+          text = "<missing " + parser.getVocabulary().getDisplayName(type) + ">";
+        }
+        // Loaded tokens (see SerializedParseResult) may have no token source.
+        TokenSource *source = current->getTokenSource();
+        TokenFactory<CommonToken> *factory = source != nullptr ? source->getTokenFactory()
+                                                               : CommonTokenFactory::DEFAULT.get();
+        _missingTokens.push_back(factory->create(
+          { source, source != nullptr ? source->getInputStream() : nullptr },
+          type, text, Token::DEFAULT_CHANNEL, INVALID_INDEX, INVALID_INDEX,
+          current->getLine(), current->getCharPositionInLine()));
+        parent->addChild(parser.createErrorNode(_missingTokens.back().get()));
+        break;
+      }
+    }
+  }
+  while (!open.empty()) {
+    close();
+  }
+  return root;
+}
+
+void FlatParseTree::enterRule(size_t ruleIndex) {
+  if (_open.empty()) {
+    _nodes.clear();
+    _complete = false;
+  }
+  _open.push_back({ _nodes.size(), static_cast<uint32_t>(ruleIndex), 0 });
+}
+
+void FlatParseTree::enterOuterAlt(size_t altNumber) {
+  if (!_open.empty()) {
+    _open.back().altNumber = static_cast<uint16_t>(altNumber);
+  }
+}
+
+void FlatParseTree::pushRecursionContext(size_t ruleIndex) {
+  // The previous context is complete, but the rule is not exited, even if it is the start rule.
+  OpenRule &rule = _open.back();
+  _nodes.push_back({ rule.ruleIndex, static_cast<uint32_t>(_nodes.size() - rule.start + 1), NO_NODE, rule.altNumber,
+    Kind::RULE });
+  rule.ruleIndex = static_cast<uint32_t>(ruleIndex);
+}
+
+void FlatParseTree::exitRule() {
+  OpenRule rule = _open.back();
+  _open.pop_back();
+  _nodes.push_back({ rule.ruleIndex, static_cast<uint32_t>(_nodes.size() - rule.start + 1), NO_NODE, rule.altNumber,
+    Kind::RULE });
+  if (_open.empty()) {
+    finish();
+  }
+}
+
+void FlatParseTree::addToken(size_t tokenIndex, bool error) {
+  if (!_open.empty()) {
+    _nodes.push_back({ static_cast<uint32_t>(tokenIndex), 1, NO_NODE, 0, error ? Kind::ERROR : Kind::TOKEN });
+  }
+}
+
+void FlatParseTree::addMissingToken(size_t tokenType) {
+  if (!_open.empty()) {
+    _nodes.push_back({ static_cast<uint32_t>(tokenType), 1, NO_NODE, 0, Kind::MISSING });
+  }
+}
+
+void FlatParseTree::finish() {
+  // Reverse postorder visits a node before its children, and those from the last to the first.
+  // Every node therefore takes the rightmost free place in the range of its parent.
+  std::vector<Node> preorder(_nodes.size());
+  struct Range {
+    uint32_t node;
+    uint32_t free; // The end of the places not yet taken by children.
+  };
+  std::vector<Range> parents;
+  for (size_t i = _nodes.size(); i-- > 0;) {
+    while (!parents.empty() && parents.back().free == parents.back().node + 1) {
+      parents.pop_back();
+    }
+    Node node = _nodes[i];
+    uint32_t index;
+    if (parents.empty()) {
+      index = 0;
+      node.parent = NO_NODE;
+    } else {
+      index = parents.back().free - node.size;
+      parents.back().free = index;
+      node.parent = parents.back().node;
+    }
+    preorder[index] = node;
+    if (node.size > 1) {
+      parents.push_back({ index, index + node.size });
+    }
+  }
+  _nodes.swap(preorder);
+  _complete = true;
+}
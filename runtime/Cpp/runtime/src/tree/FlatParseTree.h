@@ -0,0 +1,161 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+namespace tree {
+
+  /// A read only parse tree stored as a preorder array of 16 byte nodes.
+  ///
+  /// The parser fills it while parsing when it is set with <seealso cref="Parser#setFlatParseTree"/>,
+  /// also when no ParserRuleContext tree is built (see <seealso cref="Parser#setBuildParseTree"/>).
+  /// Rule nodes hold their rule index and outer alternative, leaves the index of their token. Since
+  /// every node stores the size of its subtree and the index of its parent, parent, first child and
+  /// next sibling are found in constant time, and a subtree is a contiguous range of the array.
+  ///
+  /// The tree is built in postorder and reordered when the start rule is exited, because the
+  /// contexts of left recursive rules are only known to be children of a new context after they
+  /// have been parsed. Rule contexts reused by <seealso cref="IncrementalParse"/> are not recorded.
+  class ANTLR4CPP_PUBLIC FlatParseTree {
+    // Loads the nodes of a serialized tree.
+    friend class antlr4::SerializedParseResult;
+
+  public:
+    static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+    enum class Kind : uint8_t {
+      RULE,
+      TOKEN,
+
+      /// A token consumed during error recovery.
+      ERROR,
+
+      /// A token conjured up during error recovery, which is not in the token stream. The node holds
+      /// its token type instead of a token index.
+      MISSING,
+    };
+
+    struct Node {
+      /// The rule index of a rule node, the token index of a leaf, or the token type of a missing token.
+      uint32_t value;
+
+      /// The number of nodes in the subtree, including this node.
+      uint32_t size;
+
+      uint32_t parent;
+
+      /// The outer alternative of a rule node, as passed to <seealso cref="Parser#enterOuterAlt"/>.
+      /// Left recursive rules are entered with alternative 1 for every context.
+      uint16_t altNumber;
+
+      Kind kind;
+    };
+
+    /// Walks a FlatParseTree without recursion.
+    class ANTLR4CPP_PUBLIC Cursor {
+    public:
+      /// A cursor at the root of {@code tree}, which must not be empty.
+      explicit Cursor(const FlatParseTree &tree);
+
+      size_t getIndex() const { return _index; }
+      const Node& getNode() const { return _tree->getNode(_index); }
+      size_t getDepth() const { return _depth; }
+
+      bool gotoFirstChild();
+      bool gotoNextSibling();
+      bool gotoParent();
+
+      /// Move to the next node in preorder.
+      bool gotoNext();
+
+    private:
+      const FlatParseTree *_tree;
+      size_t _index;
+      size_t _depth;
+    };
+
+    /// Creates the rule context for a rule node during <seealso cref="toParseTree"/>.
+    using ContextFactory = std::function<ParserRuleContext *(ParserRuleContext *parent, size_t ruleIndex,
+                                                             size_t altNumber)>;
+
+    FlatParseTree() = default;
+    FlatParseTree(const FlatParseTree &other) = delete;
+    FlatParseTree& operator = (const FlatParseTree &other) = delete;
+
+    /// The number of nodes, 0 while the start rule was not completed.
+    size_t size() const { return _complete ? _nodes.size() : 0; }
+    bool empty() const { return size() == 0; }
+
+    const Node& getNode(size_t index) const { return _nodes[index]; }
+
+    size_t getParent(size_t index) const { return _nodes[index].parent; }
+
+    size_t getFirstChild(size_t index) const {
+      return _nodes[index].size > 1 ? index + 1 : NO_NODE;
+    }
+
+    size_t getNextSibling(size_t index) const {
+      uint32_t parent = _nodes[index].parent;
+      size_t next = index + _nodes[index].size;
+      return parent != NO_NODE && next < parent + _nodes[parent].size ? next : NO_NODE;
+    }
+
+    size_t getChildCount(size_t index) const;
+
+    /// The number of bytes used by the nodes.
+    size_t getMemoryUsage() const;
+
+    /// Build a ParserRuleContext tree with the same structure for code working on those, e.g.
+    /// listeners and visitors. The nodes are owned by the tree tracker of {@code parser}, whose token
+    /// stream must still hold the tokens of the parse. Rule contexts are created by
+    /// {@code createContext}, or are InterpreterRuleContexts without one. Label fields of generated
+    /// contexts are not set. The tokens of MISSING nodes are owned by this object.
+    ParserRuleContext* toParseTree(Parser &parser, const ContextFactory &createContext = nullptr);
+
+    /// Called by the parser when a rule is entered. Clears the tree if the start rule is entered.
+    void enterRule(size_t ruleIndex);
+
+    /// Called by the parser when an outer alternative of the current rule is entered.
+    void enterOuterAlt(size_t altNumber);
+
+    /// Called by the parser when the current rule context becomes the first child of a new context of
+    /// a left recursive rule.
+    void pushRecursionContext(size_t ruleIndex);
+
+    /// Called by the parser when the current rule is exited.
+    void exitRule();
+
+    /// Called by the parser for every token added to the current rule.
+    void addToken(size_t tokenIndex, bool error);
+
+    /// Called by the parser for every token conjured up during error recovery.
+    void addMissingToken(size_t tokenType);
+
+  private:
+    /// A rule which was entered but not exited yet. {@code start} is the position of its first
+    /// descendant in the postorder array.
+    struct OpenRule {
+      size_t start;
+      uint32_t ruleIndex;
+      uint16_t altNumber;
+    };
+
+    std::vector<Node> _nodes;
+    std::vector<OpenRule> _open;
+    bool _complete = false;
+    std::vector<std::unique_ptr<Token>> _missingTokens;
+
+    void finish();
+  };
+
+  static_assert(sizeof(FlatParseTree::Node) == 16, "flat parse tree nodes should take 16 bytes");
+
+} // namespace tree
+} // namespace antlr4
@@ -16,51 +16,37 @@ using namespace antlr4::tree;
 using namespace antlrcpp;
 
 void IterativeParseTreeWalker::walk(ParseTreeListener *listener, ParseTree *t) const {
-  std::vector<std::pair<ParseTree*, size_t>> stack;
-  ParseTree *currentNode = t;
-  size_t currentIndex = 0;
-
-  while (currentNode != nullptr) {
-    // pre-order visit
-    if (ErrorNode::is(*currentNode)) {
-      listener->visitErrorNode(downCast<ErrorNode*>(currentNode));
-    } else if (TerminalNode::is(*currentNode)) {
-      listener->visitTerminal(downCast<TerminalNode*>(currentNode));
+  iterate(t, [this, listener](ParseTree *node) {
+    if (ErrorNode::is(*node)) {
+      listener->visitErrorNode(downCast<ErrorNode*>(node));
+    } else if (TerminalNode::is(*node)) {
+      listener->visitTerminal(downCast<TerminalNode*>(node));
     } else {
-      enterRule(listener, currentNode);
-    }
-
-    // Move down to first child, if it exists.
-    if (!currentNode->children.empty()) {
-      stack.push_back(std::make_pair(currentNode, currentIndex));
-      currentIndex = 0;
-      currentNode = currentNode->children[0];
-      continue;
+      enterRule(listener, node);
     }
+  }, [this, listener](ParseTree *node) {
+    exitRule(listener, node);
+  });
+}
 
-    // No child nodes, so walk tree.
-    do {
-      // post-order visit
-      if (!TerminalNode::is(*currentNode)) {
-        exitRule(listener, currentNode);
+void IterativeParseTreeWalker::walkAll(const std::vector<ParseTreeListener *> &listeners, ParseTree *t) const {
+  iterate(t, [this, &listeners](ParseTree *node) {
+    if (ErrorNode::is(*node)) {
+      for (ParseTreeListener *listener : listeners) {
+        listener->visitErrorNode(downCast<ErrorNode*>(node));
       }
-
-      // No parent, so no siblings.
-      if (stack.empty()) {
-        currentNode = nullptr;
-        currentIndex = 0;
-        break;
+    } else if (TerminalNode::is(*node)) {
+      for (ParseTreeListener *listener : listeners) {
+        listener->visitTerminal(downCast<TerminalNode*>(node));
       }
-
-      // Move to next sibling if possible.
-      if (stack.back().first->children.size() > ++currentIndex) {
-        currentNode = stack.back().first->children[currentIndex];
-        break;
+    } else {
+      for (ParseTreeListener *listener : listeners) {
+        enterRule(listener, node);
       }
-
-      // No next sibling, so move up.
-      std::tie(currentNode, currentIndex) = stack.back();
-      stack.pop_back();
-    } while (currentNode != nullptr);
-  }
+    }
+  }, [this, &listeners](ParseTree *node) {
+    for (ParseTreeListener *listener : listeners) {
+      exitRule(listener, node);
+    }
+  });
 }
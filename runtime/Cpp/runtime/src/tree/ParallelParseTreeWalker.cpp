@@ -0,0 +1,191 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "ParserRuleContext.h"
+#include "support/Casts.h"
+#include "tree/ErrorNode.h"
+#include "tree/ParseTreeListener.h"
+#include "tree/TerminalNode.h"
+
+#include "tree/ParallelParseTreeWalker.h"
+
+using namespace antlr4;
+using namespace antlr4::tree;
+using namespace antlrcpp;
+
+/// A thread of a walk, with its listener and the subtrees it still has to walk. The thread takes
+/// subtrees from the front of its own queue, other threads steal them from the back.
+class ParallelParseTreeWalker::Worker {
+public:
+  std::unique_ptr<ParseTreeListener> listener;
+  std::deque<ParseTree *> subtrees;
+  size_t stolen = 0;
+  std::exception_ptr failure;
+
+  ParseTree* takeFirst() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (subtrees.empty()) {
+      return nullptr;
+    }
+    ParseTree *subtree = subtrees.front();
+    subtrees.pop_front();
+    return subtree;
+  }
+
+  ParseTree* takeLast() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (subtrees.empty()) {
+      return nullptr;
+    }
+    ParseTree *subtree = subtrees.back();
+    subtrees.pop_back();
+    return subtree;
+  }
+
+private:
+  std::mutex _mutex;
+};
+
+ParallelParseTreeWalker::ParallelParseTreeWalker(size_t threads, const ParseTreeWalker &walker)
+  : _threads(threads), _walker(walker), _splitDepth(DEFAULT_SPLIT_DEPTH), _subtreeCount(0), _stolenSubtreeCount(0) {
+  if (_threads == 0) {
+    _threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+}
+
+void ParallelParseTreeWalker::setSplitDepth(size_t depth) {
+  _splitDepth = depth;
+}
+
+size_t ParallelParseTreeWalker::getSplitDepth() const {
+  return _splitDepth;
+}
+
+void ParallelParseTreeWalker::setSplitRules(const std::vector<size_t> &ruleIndexes) {
+  _splitRules.clear();
+  for (size_t ruleIndex : ruleIndexes) {
+    if (ruleIndex >= _splitRules.size()) {
+      _splitRules.resize(ruleIndex + 1);
+    }
+    _splitRules[ruleIndex] = true;
+  }
+}
+
+size_t ParallelParseTreeWalker::getSubtreeCount() const {
+  return _subtreeCount;
+}
+
+size_t ParallelParseTreeWalker::getStolenSubtreeCount() const {
+  return _stolenSubtreeCount;
+}
+
+void ParallelParseTreeWalker::walk(ParseTree *t, const ListenerFactory &createListener, const Reduce &reduce) {
+  std::vector<std::unique_ptr<Worker>> workers;
+  workers.push_back(std::make_unique<Worker>());
+  workers[0]->listener = createListener();
+
+  // Walk the tree above the split on this thread, and collect the subtrees below it.
+  ParseTreeListener *listener = workers[0]->listener.get();
+  std::vector<ParseTree *> subtrees;
+  struct Pending {
+    ParseTree *node;
+    size_t depth;
+    bool exit;
+  };
+  std::vector<Pending> pending = { { t, 0, false } };
+  while (!pending.empty()) {
+    Pending current = pending.back();
+    pending.pop_back();
+    if (current.exit) {
+      ParserRuleContext *ctx = downCast<ParserRuleContext *>(current.node);
+      ctx->exitRule(listener);
+      listener->exitEveryRule(ctx);
+    } else if (ErrorNode::is(*current.node)) {
+      listener->visitErrorNode(downCast<ErrorNode *>(current.node));
+    } else if (TerminalNode::is(*current.node)) {
+      listener->visitTerminal(downCast<TerminalNode *>(current.node));
+    } else if (isSplitPoint(current.node, current.depth)) {
+      subtrees.push_back(current.node);
+    } else {
+      ParserRuleContext *ctx = downCast<ParserRuleContext *>(current.node);
+      listener->enterEveryRule(ctx);
+      ctx->enterRule(listener);
+      pending.push_back({ current.node, current.depth, true });
+      for (auto child = ctx->children.rbegin(); child != ctx->children.rend(); ++child) {
+        pending.push_back({ *child, current.depth + 1, false });
+      }
+    }
+  }
+  _subtreeCount = subtrees.size();
+  _stolenSubtreeCount = 0;
+
+  // Every thread starts with a range of neighbouring subtrees.
+  size_t count = std::max<size_t>(std::min(_threads, subtrees.size()), 1);
+  for (size_t i = 1; i < count; ++i) {
+    workers.push_back(std::make_unique<Worker>());
+    workers[i]->listener = createListener();
+  }
+  for (size_t i = 0; i < count; ++i) {
+    workers[i]->subtrees.assign(subtrees.begin() + static_cast<ssize_t>(subtrees.size() * i / count),
+                                subtrees.begin() + static_cast<ssize_t>(subtrees.size() * (i + 1) / count));
+  }
+
+  std::atomic<bool> failed(false);
+  auto run = [&](size_t i) {
+    Worker &worker = *workers[i];
+    try {
+      while (!failed) {
+        ParseTree *subtree = worker.takeFirst();
+        for (size_t k = 1; subtree == nullptr && k < count; ++k) {
+          subtree = workers[(i + k) % count]->takeLast();
+          if (subtree != nullptr) {
+            ++worker.stolen;
+          }
+        }
+        if (subtree == nullptr) {
+          break;
+        }
+        _walker.walk(worker.listener.get(), subtree);
+      }
+    } catch (...) {
+      worker.failure = std::current_exception();
+      failed = true;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(count - 1);
+  for (size_t i = 1; i < count; ++i) {
+    threads.emplace_back(run, i);
+  }
+  run(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto &worker : workers) {
+    if (worker->failure != nullptr) {
+      std::rethrow_exception(worker->failure);
+    }
+    _stolenSubtreeCount += worker->stolen;
+  }
+  for (auto &worker : workers) {
+    reduce(worker->listener.get());
+  }
+}
+
+bool ParallelParseTreeWalker::isSplitPoint(ParseTree *node, size_t depth) const {
+  if (depth == _splitDepth) {
+    return true;
+  }
+  size_t ruleIndex = downCast<ParserRuleContext *>(node)->getRuleIndex();
+  return ruleIndex < _splitRules.size() && _splitRules[ruleIndex];
+}
@@ -0,0 +1,82 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "tree/ParseTreeWalker.h"
+
+namespace antlr4 {
+namespace tree {
+
+  /// Walks the subtrees of a parse tree on several threads, for listeners which only read the tree.
+  ///
+  /// The tree is split at the rule contexts at a given depth, or of the given rules, whichever comes
+  /// first on the way down. Every thread gets a listener of its own from the factory passed to walk(),
+  /// and walks the subtrees assigned to it with a <seealso cref="ParseTreeWalker"/>. A thread which runs
+  /// out of subtrees takes the remaining ones of another thread. So each listener sees complete
+  /// subtrees, but in no particular order, and the listeners are combined afterwards by the caller's
+  /// reduce step.
+  ///
+  /// The part of the tree above the split is walked first by the listener of the calling thread,
+  /// without the subtrees. Its rule contexts are entered and exited as usual.
+  ///
+  /// <code>
+  ///   ParallelParseTreeWalker walker;
+  ///   walker.setSplitRules({ MyParser::RuleFunction });
+  ///   size_t total = 0;
+  ///   walker.walk(tree, [] { return std::make_unique<CountingListener>(); },
+  ///     [&total](ParseTreeListener *listener) { total += static_cast<CountingListener *>(listener)->count; });
+  /// </code>
+  class ANTLR4CPP_PUBLIC ParallelParseTreeWalker {
+  public:
+    /// Creates the listener of a thread. Called on the calling thread.
+    using ListenerFactory = std::function<std::unique_ptr<ParseTreeListener>()>;
+
+    /// Combines the results of a listener. Called on the calling thread, after all subtrees are
+    /// walked, once for every listener in the order in which they were created.
+    using Reduce = std::function<void (ParseTreeListener *listener)>;
+
+    static constexpr size_t DEFAULT_SPLIT_DEPTH = 1;
+
+    /// Use up to {@code threads} threads, including the calling one. 0 means one per hardware thread.
+    /// Subtrees are walked with {@code walker}.
+    explicit ParallelParseTreeWalker(size_t threads = 0, const ParseTreeWalker &walker = ParseTreeWalker::DEFAULT);
+
+    /// Split the tree at the rule contexts {@code depth} levels below the root. The default is 1, the
+    /// children of the root.
+    void setSplitDepth(size_t depth);
+    size_t getSplitDepth() const;
+
+    /// Also split the tree at every context of one of {@code ruleIndexes}.
+    void setSplitRules(const std::vector<size_t> &ruleIndexes);
+
+    /// Walk {@code t} as described above. If a listener throws, the remaining subtrees are not walked,
+    /// and the exception is rethrown here without calling {@code reduce}.
+    void walk(ParseTree *t, const ListenerFactory &createListener, const Reduce &reduce);
+
+    /// The number of subtrees the tree was split into by the last walk.
+    size_t getSubtreeCount() const;
+
+    /// The number of subtrees which were walked by another thread than the one they were assigned
+    /// to in the last walk.
+    size_t getStolenSubtreeCount() const;
+
+  private:
+    class Worker;
+
+    size_t _threads;
+    const ParseTreeWalker &_walker;
+    size_t _splitDepth;
+    std::vector<bool> _splitRules;
+    size_t _subtreeCount;
+    size_t _stolenSubtreeCount;
+
+    bool isSplitPoint(ParseTree *node, size_t depth) const;
+  };
+
+} // namespace tree
+} // namespace antlr4
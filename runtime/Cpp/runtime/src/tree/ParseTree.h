@@ -5,12 +5,19 @@
 
 #pragma once
 
+#include "Exceptions.h"
 #include "support/Any.h"
+#include "tree/ParseTreeArena.h"
 #include "tree/ParseTreeType.h"
 
 namespace antlr4 {
 namespace tree {
 
+  /// The child list of a parse tree node. Its storage comes from the ParseTreeArena of the tracker
+  /// which created the node, if there is one. Use {@code children.begin()} and {@code children.end()}
+  /// where a std::vector<ParseTree *> is needed.
+  using ParseTreeChildren = std::vector<ParseTree *, ParseTreeAllocator<ParseTree *>>;
+
   /// An interface to access the tree of <seealso cref="RuleContext"/> objects created
   /// during a parse that makes the data structure look like a simple parse tree.
   /// This node represents both internal nodes, rule invocations,
@@ -36,7 +43,7 @@ namespace tree {
     /// operation because we don't the need to track the details about
     /// how we parse this rule.
     // ml: memory is not managed here, but by the owning class. This is just for the structure.
-    std::vector<ParseTree *> children;
+    ParseTreeChildren children;
 
     /// Print out a whole tree, not just a node, in LISP format
     /// {@code (root child1 .. childN)}. Print just a node if this is a leaf.
@@ -78,11 +85,19 @@ namespace tree {
 
     ParseTreeType getTreeType() const { return _treeType; }
 
+    /// A number assigned by the <seealso cref="ParseTreeTracker"/> which created this node, counting up
+    /// from 0 for the nodes of a tracker. INVALID_INDEX for nodes not created by a tracker. Used by
+    /// <seealso cref="DenseParseTreeProperty"/>.
+    size_t getNodeId() const { return _nodeId; }
+
   protected:
     explicit ParseTree(ParseTreeType treeType) : _treeType(treeType) {}
 
   private:
+    friend class ParseTreeTracker;
+
     const ParseTreeType _treeType;
+    size_t _nodeId = INVALID_INDEX;
   };
 
   // A class to help managing ParseTree instances without the need of a shared_ptr.
@@ -91,19 +106,102 @@ namespace tree {
     template<typename T, typename ... Args>
     T* createInstance(Args&& ... args) {
       static_assert(std::is_base_of<ParseTree, T>::value, "Argument must be a parse tree type");
-      T* result = new T(args...);
-      _allocated.push_back(result);
+      if (_arena == nullptr) {
+        T* result = new T(args...);
+        result->_nodeId = _nextNodeId++;
+        _allocated.push_back(result);
+        return result;
+      }
+
+      T* result = new (_arena->allocate(sizeof(T), alignof(T))) T(args...);
+      result->_nodeId = _nextNodeId++;
+      ParseTreeChildren children{ ParseTreeAllocator<ParseTree *>(_arena) };
+      children.assign(result->children.begin(), result->children.end()); // Only copied error nodes, if any.
+      result->children = std::move(children);
+
+      // Terminal nodes own nothing outside of the arena, so they need not be destroyed.
+      if constexpr (!std::is_same<T, TerminalNodeImpl>::value && !std::is_same<T, ErrorNodeImpl>::value) {
+        _allocated.push_back(result);
+      }
       return result;
     }
 
     void reset() {
-      for (auto * entry : _allocated)
-        delete entry;
+      if (_arena == nullptr) {
+        for (auto * entry : _allocated)
+          delete entry;
+      } else {
+        for (auto * entry : _allocated)
+          entry->~ParseTree();
+        _arena->reset();
+      }
       _allocated.clear();
+      _nextNodeId = 0;
+    }
+
+    /// Create all instances in {@code arena} from now on, or on the heap if it is null. The instances
+    /// created so far are deleted first.
+    void setArena(ParseTreeArena *arena) {
+      reset();
+      _arena = arena;
+    }
+
+    ParseTreeArena* getArena() const {
+      return _arena;
+    }
+
+    /// Give up the ownership of all instances created so far, and return them. Not possible with an
+    /// arena, since its memory cannot be given away.
+    std::vector<ParseTree *> release() {
+      if (_arena != nullptr) {
+        throw IllegalStateException("parse trees in an arena cannot be released");
+      }
+      std::vector<ParseTree *> result;
+      result.swap(_allocated);
+      return result;
+    }
+
+    /// Take over the ownership of {@code tree}, e.g. one returned by release(). It gets a new node id,
+    /// since its old one may have been handed out again after a reset().
+    void adopt(ParseTree *tree) {
+      tree->_nodeId = _nextNodeId++;
+      _allocated.push_back(tree);
+    }
+
+    /// The number of instances owned, which are numbered in the order of their creation.
+    size_t size() const {
+      return _allocated.size();
+    }
+
+    ParseTree* get(size_t index) const {
+      return _allocated[index];
+    }
+
+    /// All nodes created or adopted since the last reset() have a node id below this one. Released
+    /// nodes keep their ids until they are adopted, and the ids of destroyed nodes are not handed out
+    /// again.
+    size_t getNodeIdLimit() const {
+      return _nextNodeId;
+    }
+
+    /// Delete the instances from {@code begin} up to {@code end}. The instances behind them move
+    /// forward. With an arena their memory is only reused after reset().
+    void destroy(size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (_arena == nullptr) {
+          delete _allocated[i];
+        } else {
+          _allocated[i]->~ParseTree();
+        }
+      }
+      _allocated.erase(_allocated.begin() + static_cast<ptrdiff_t>(begin),
+                       _allocated.begin() + static_cast<ptrdiff_t>(end));
     }
 
   private:
     std::vector<ParseTree *> _allocated;
+    ParseTreeArena *_arena = nullptr;
+    size_t _nextNodeId = 0;
   };
 
 
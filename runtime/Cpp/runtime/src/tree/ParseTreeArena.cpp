@@ -0,0 +1,43 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "tree/ParseTreeArena.h"
+
+using namespace antlr4::tree;
+
+ParseTreeArena::ParseTreeArena(size_t blockSize) : _blockSize(blockSize), _next(nullptr), _end(nullptr) {
+}
+
+ParseTreeArena::~ParseTreeArena() {
+}
+
+void ParseTreeArena::reset() {
+  _largeBlocks.clear();
+  if (_blocks.empty()) {
+    return;
+  }
+  _blocks.resize(1);
+  _next = _blocks[0].data.get();
+  _end = _next + _blocks[0].size;
+}
+
+size_t ParseTreeArena::getBlockCount() const {
+  return _blocks.size() + _largeBlocks.size();
+}
+
+void* ParseTreeArena::allocateSlow(size_t size, size_t alignment) {
+  size_t needed = size + alignment;
+  if (needed > _blockSize / 4) {
+    // Large requests get a block of their own, so the rest of the current block is not wasted.
+    _largeBlocks.push_back({ std::unique_ptr<char[]>(new char[needed]), needed });
+    uintptr_t result = (reinterpret_cast<uintptr_t>(_largeBlocks.back().data.get()) + alignment - 1) & ~(alignment - 1);
+    return reinterpret_cast<void *>(result);
+  }
+
+  _blocks.push_back({ std::unique_ptr<char[]>(new char[_blockSize]), _blockSize });
+  _next = _blocks.back().data.get();
+  _end = _next + _blockSize;
+  return allocate(size, alignment);
+}
@@ -0,0 +1,113 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+namespace tree {
+
+  /// A bump allocator for parse tree nodes and their child lists.
+  ///
+  /// Memory is taken from large blocks and is only given back all at once by reset(), which takes
+  /// time proportional to the number of blocks instead of the number of nodes. Set it on a parser with
+  /// {@code parser.getTreeTracker().setArena(&arena)}; all nodes created by the parser from then on,
+  /// including the contexts of generated parsers, live in the arena until the parser is reset.
+  /// Child lists which grow leave their old storage behind until the next reset.
+  ///
+  /// An arena must only be used by one tracker at a time, and is not thread safe.
+  class ANTLR4CPP_PUBLIC ParseTreeArena {
+  public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+    explicit ParseTreeArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+    ParseTreeArena(const ParseTreeArena &other) = delete;
+    ~ParseTreeArena();
+
+    ParseTreeArena& operator = (const ParseTreeArena &other) = delete;
+
+    void* allocate(size_t size, size_t alignment) {
+      uintptr_t result = (reinterpret_cast<uintptr_t>(_next) + alignment - 1) & ~(alignment - 1);
+      if (_next == nullptr || result + size > reinterpret_cast<uintptr_t>(_end)) {
+        return allocateSlow(size, alignment);
+      }
+      _next = reinterpret_cast<char *>(result + size);
+      return reinterpret_cast<void *>(result);
+    }
+
+    /// Give back all memory allocated so far. The first block is kept for the next use.
+    void reset();
+
+    size_t getBlockCount() const;
+
+  private:
+    struct Block {
+      std::unique_ptr<char[]> data;
+      size_t size;
+    };
+
+    size_t _blockSize;
+    std::vector<Block> _blocks;
+    std::vector<Block> _largeBlocks;
+    char *_next;
+    char *_end;
+
+    void* allocateSlow(size_t size, size_t alignment);
+  };
+
+  /// Allocates from a ParseTreeArena, or from the heap without one. Used for the child lists of
+  /// parse tree nodes.
+  template<typename T>
+  class ParseTreeAllocator {
+  public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    ParseTreeAllocator() noexcept : _arena(nullptr) {
+    }
+
+    explicit ParseTreeAllocator(ParseTreeArena *arena) noexcept : _arena(arena) {
+    }
+
+    template<typename U>
+    ParseTreeAllocator(const ParseTreeAllocator<U> &other) noexcept : _arena(other.getArena()) {
+    }
+
+    T* allocate(size_t n) {
+      if (_arena == nullptr) {
+        return std::allocator<T>().allocate(n);
+      }
+      return static_cast<T *>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+      if (_arena == nullptr) {
+        std::allocator<T>().deallocate(p, n);
+      }
+    }
+
+    ParseTreeArena* getArena() const noexcept {
+      return _arena;
+    }
+
+    template<typename U>
+    bool operator == (const ParseTreeAllocator<U> &other) const noexcept {
+      return _arena == other.getArena();
+    }
+
+    template<typename U>
+    bool operator != (const ParseTreeAllocator<U> &other) const noexcept {
+      return _arena != other.getArena();
+    }
+
+  private:
+    ParseTreeArena *_arena;
+  };
+
+} // namespace tree
+} // namespace antlr4
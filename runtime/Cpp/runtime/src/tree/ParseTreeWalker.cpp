@@ -35,6 +35,31 @@ void ParseTreeWalker::walk(ParseTreeListener *listener, ParseTree *t) const {
   exitRule(listener, t);
 }
 
+void ParseTreeWalker::walkAll(const std::vector<ParseTreeListener *> &listeners, ParseTree *t) const {
+  if (ErrorNode::is(*t)) {
+    for (ParseTreeListener *listener : listeners) {
+      listener->visitErrorNode(downCast<ErrorNode*>(t));
+    }
+    return;
+  }
+  if (TerminalNode::is(*t)) {
+    for (ParseTreeListener *listener : listeners) {
+      listener->visitTerminal(downCast<TerminalNode*>(t));
+    }
+    return;
+  }
+
+  for (ParseTreeListener *listener : listeners) {
+    enterRule(listener, t);
+  }
+  for (auto &child : t->children) {
+    walkAll(listeners, child);
+  }
+  for (ParseTreeListener *listener : listeners) {
+    exitRule(listener, t);
+  }
+}
+
 void ParseTreeWalker::enterRule(ParseTreeListener *listener, ParseTree *r) const {
   auto *ctx = downCast<ParserRuleContext*>(r);
   listener->enterEveryRule(ctx);
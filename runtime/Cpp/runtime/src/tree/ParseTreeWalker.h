@@ -5,7 +5,11 @@
 
 #pragma once
 
-#include "antlr4-common.h"
+#include "ParserRuleContext.h"
+#include "support/Casts.h"
+#include "tree/ErrorNode.h"
+#include "tree/ParseTreeListener.h"
+#include "tree/TerminalNode.h"
 
 namespace antlr4 {
 namespace tree {
@@ -28,7 +32,84 @@ namespace tree {
     */
     virtual void walk(ParseTreeListener *listener, ParseTree *t) const;
 
+    /// Walks {@code t} once for all {@code listeners}. Every event goes to the listeners in the order
+    /// in which they are given, before the walk moves on to the next node. Listeners which do not
+    /// change the tree get the same events as if the tree was walked for each of them in turn.
+    virtual void walkAll(const std::vector<ParseTreeListener *> &listeners, ParseTree *t) const;
+
+    /// Walks {@code t} like <seealso cref="IterativeParseTreeWalker"/>, with the listener type known at
+    /// compile time, e.g. {@code ParseTreeWalker::walkTyped(&listener, tree)}. The rule
+    /// specific events are dispatched by the static {@code enterContext} and {@code exitContext} of
+    /// the generated listener interface, which switch over the type tags of the contexts (see
+    /// <seealso cref="RuleContext#getContextType"/>). There is no dynamic_cast and no virtual
+    /// enterRule/exitRule call per node, and if {@code Listener} is final, the listener methods are
+    /// called directly. Contexts without type tags get their enterRule/exitRule called as usual.
+    /// The virtual methods of the walker are not used.
+    template<typename Listener>
+    static void walkTyped(Listener *listener, ParseTree *t) {
+      iterate(t, [listener](ParseTree *node) {
+        if (ErrorNode::is(*node)) {
+          listener->visitErrorNode(antlrcpp::downCast<ErrorNode *>(node));
+        } else if (TerminalNode::is(*node)) {
+          listener->visitTerminal(antlrcpp::downCast<TerminalNode *>(node));
+        } else {
+          ParserRuleContext *ctx = antlrcpp::downCast<ParserRuleContext *>(node);
+          listener->enterEveryRule(ctx);
+          Listener::enterContext(listener, ctx);
+        }
+      }, [listener](ParseTree *node) {
+        ParserRuleContext *ctx = antlrcpp::downCast<ParserRuleContext *>(node);
+        Listener::exitContext(listener, ctx);
+        listener->exitEveryRule(ctx);
+      });
+    }
+
   protected:
+    /// Calls {@code preVisit} for every node of {@code t} in pre-order and {@code postVisit} for every
+    /// rule node in post-order, without recursion. Used by the iterative walks.
+    template<typename PreVisit, typename PostVisit>
+    static void iterate(ParseTree *t, PreVisit &&preVisit, PostVisit &&postVisit) {
+      std::vector<std::pair<ParseTree *, size_t>> stack;
+      ParseTree *currentNode = t;
+      size_t currentIndex = 0;
+
+      while (currentNode != nullptr) {
+        // pre-order visit
+        preVisit(currentNode);
+
+        // Move down to first child, if it exists.
+        if (!currentNode->children.empty()) {
+          stack.push_back({ currentNode, currentIndex });
+          currentIndex = 0;
+          currentNode = currentNode->children[0];
+          continue;
+        }
+
+        // No child nodes, so walk tree.
+        do {
+          // post-order visit
+          if (!TerminalNode::is(*currentNode)) {
+            postVisit(currentNode);
+          }
+
+          // No parent, so no siblings.
+          if (stack.empty()) {
+            currentNode = nullptr;
+            break;
+          }
+
+          // Move to next sibling if possible.
+          if (stack.back().first->children.size() > ++currentIndex) {
+            currentNode = stack.back().first->children[currentIndex];
+            break;
+          }
+
+          // No next sibling, so move up.
+          std::tie(currentNode, currentIndex) = stack.back();
+          stack.pop_back();
+        } while (currentNode != nullptr);
+      }
+    }
 
     /**
     * <summary>
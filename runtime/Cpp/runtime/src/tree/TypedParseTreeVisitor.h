@@ -0,0 +1,98 @@
+﻿/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "ParserRuleContext.h"
+#include "support/Casts.h"
+#include "tree/ErrorNode.h"
+#include "tree/TerminalNode.h"
+
+namespace antlr4 {
+namespace tree {
+
+  /// A parse tree visitor returning {@code Result} by value, without std::any. Generated visitors
+  /// derive from it when the grammar option {@code visitorResult} names the result type, e.g.
+  /// {@code -DvisitorResult=double}. They implement <seealso cref="#visitContext"/> with a switch over
+  /// the type tags of the contexts (see <seealso cref="RuleContext#getContextType"/>), so
+  /// <seealso cref="ParseTree#accept"/> is not used. Contexts without type tags, like those of
+  /// ParserInterpreter, are visited with <seealso cref="#visitChildren"/>.
+  ///
+  /// {@code Result} must be default constructible unless <seealso cref="#defaultResult"/> is
+  /// overridden, and it is moved, never copied, when aggregating.
+  template<typename Result>
+  class TypedParseTreeVisitor {
+  public:
+    virtual ~TypedParseTreeVisitor() = default;
+
+    /// Visit a parse tree, and return a user-defined result of the operation.
+    virtual Result visit(ParseTree *tree) {
+      switch (tree->getTreeType()) {
+        case ParseTreeType::TERMINAL:
+          return visitTerminal(antlrcpp::downCast<TerminalNode *>(tree));
+        case ParseTreeType::ERROR:
+          return visitErrorNode(antlrcpp::downCast<ErrorNode *>(tree));
+        default:
+          return visitContext(antlrcpp::downCast<ParserRuleContext *>(tree));
+      }
+    }
+
+    /// Visits the children of {@code node} like <seealso cref="AbstractParseTreeVisitor#visitChildren"/>.
+    virtual Result visitChildren(ParseTree *node) {
+      Result result = defaultResult();
+      size_t n = node->children.size();
+      for (size_t i = 0; i < n; i++) {
+        if (!shouldVisitNextChild(node, result)) {
+          break;
+        }
+
+        Result childResult = visit(node->children[i]);
+        result = aggregateResult(std::move(result), std::move(childResult));
+      }
+
+      return result;
+    }
+
+    /// The default implementation returns the result of
+    /// <seealso cref="#defaultResult defaultResult"/>.
+    virtual Result visitTerminal(TerminalNode * /*node*/) {
+      return defaultResult();
+    }
+
+    /// The default implementation returns the result of
+    /// <seealso cref="#defaultResult defaultResult"/>.
+    virtual Result visitErrorNode(ErrorNode * /*node*/) {
+      return defaultResult();
+    }
+
+  protected:
+    /// Calls the visit method for the class of {@code ctx}. Implemented by the generated visitor
+    /// interface, the default implementation visits the children.
+    virtual Result visitContext(ParserRuleContext *ctx) {
+      return visitChildren(ctx);
+    }
+
+    /// The value returned by visitTerminal() and visitErrorNode(), and the initial aggregate result
+    /// of visitChildren(). The default implementation returns {@code Result()}.
+    virtual Result defaultResult() {
+      return Result();
+    }
+
+    /// Aggregates the results of visiting multiple children of a node. The default implementation
+    /// returns {@code nextResult}, the result of the last child visited.
+    virtual Result aggregateResult(Result /*aggregate*/, Result nextResult) {
+      return nextResult;
+    }
+
+    /// Called before visiting each child in visitChildren(). Return {@code false} to stop visiting
+    /// children and return {@code currentResult}.
+    virtual bool shouldVisitNextChild(ParseTree * /*node*/, const Result &/*currentResult*/) {
+      return true;
+    }
+
+  };
+
+} // namespace tree
+} // namespace antlr4
@@ -20,5 +20,5 @@ std::vector<ParseTree *> XPathWildcardElement::evaluate(ParseTree *t) {
     return {}; // !* is weird but valid (empty)
   }
 
-  return t->children;
+  return { t->children.begin(), t->children.end() };
 }
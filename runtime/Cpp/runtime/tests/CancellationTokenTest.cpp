@@ -0,0 +1,260 @@
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "BaseErrorListener.h"
+#include "CancellationToken.h"
+#include "CommonToken.h"
+#include "CommonTokenStream.h"
+#include "Exceptions.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "ListTokenSource.h"
+#include "ParserInterpreter.h"
+#include "ParserRuleContext.h"
+#include "atn/ATNDeserializer.h"
+#include "atn/LexerATNSimulator.h"
+#include "atn/SerializedATNView.h"
+#include "dfa/LexerDFATable.h"
+#include "tree/ParseTreeListener.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  class CancellationTokenTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> lexerATN = ExprGrammar::deserializeLexerATN();
+    std::unique_ptr<atn::ATN> parserATN = ExprGrammar::deserializeParserATN();
+
+    std::unique_ptr<LexerInterpreter> createLexer(CharStream *input) {
+      return ExprGrammar::createLexer(*lexerATN, input);
+    }
+
+    static std::string createText(size_t functions) {
+      std::string text;
+      for (size_t i = 0; i < functions; ++i) {
+        text += "def f(a, b) {\n  x = a*(b+" + std::to_string(i) + ");\n  return x-1;\n}\n";
+      }
+      return text;
+    }
+  };
+
+  /// Cancels a token when the parser enters its n-th rule.
+  class CancelAtRule : public tree::ParseTreeListener {
+  public:
+    CancelAtRule(CancellationToken &token, size_t rules) : _token(token), _rules(rules) {
+    }
+
+    void enterEveryRule(ParserRuleContext * /*ctx*/) override {
+      if (--_rules == 0) {
+        _token.cancel();
+      }
+    }
+
+    void exitEveryRule(ParserRuleContext * /*ctx*/) override {
+    }
+
+    void visitTerminal(tree::TerminalNode * /*node*/) override {
+    }
+
+    void visitErrorNode(tree::ErrorNode * /*node*/) override {
+    }
+
+  private:
+    CancellationToken &_token;
+    size_t _rules;
+  };
+
+  /// Not read directly by the lexer simulator, since it is not an ANTLRInputStream itself.
+  class DerivedInputStream : public ANTLRInputStream {
+  public:
+    using ANTLRInputStream::ANTLRInputStream;
+  };
+
+  /// Cancels a token when the parser falls back to a full-context prediction.
+  class CancelAtFullContext : public BaseErrorListener {
+  public:
+    explicit CancelAtFullContext(CancellationToken &token) : _token(token) {
+    }
+
+    void reportAttemptingFullContext(Parser * /*recognizer*/, const dfa::DFA & /*dfa*/, size_t /*startIndex*/,
+                                     size_t /*stopIndex*/, const antlrcpp::BitSet & /*conflictingAlts*/,
+                                     atn::ATNConfigSet * /*configs*/) override {
+      _token.cancel();
+    }
+
+  private:
+    CancellationToken &_token;
+  };
+
+  TEST_F(CancellationTokenTest, HasNoDeadlineByDefault) {
+    CancellationToken token;
+    EXPECT_FALSE(token.isCancelled());
+    EXPECT_FALSE(token.isDeadlineExceeded());
+    EXPECT_EQ(token.getDeadline(), CancellationToken::Clock::time_point::max());
+    EXPECT_NO_THROW(token.throwIfCancelled());
+
+    token.setDeadline(CancellationToken::Clock::now() - std::chrono::seconds(1));
+    EXPECT_TRUE(token.isDeadlineExceeded());
+    EXPECT_THROW(token.throwIfCancelled(), DeadlineExceededException);
+
+    token.cancel();
+    EXPECT_TRUE(token.isCancelled());
+    EXPECT_THROW(token.throwIfCancelled(), OperationCancelledException);
+
+    CancellationToken later(std::chrono::hours(1));
+    EXPECT_FALSE(later.isDeadlineExceeded());
+  }
+
+  TEST_F(CancellationTokenTest, StopsTheLexer) {
+    ANTLRInputStream input(createText(10));
+    auto lexer = createLexer(&input);
+    CancellationToken token;
+    lexer->setCancellationToken(&token);
+    EXPECT_EQ(lexer->nextToken()->getText(), "def");
+
+    token.cancel();
+    EXPECT_THROW(lexer->nextToken(), OperationCancelledException);
+
+    // Without the token the lexer works again after a reset.
+    lexer->setCancellationToken(nullptr);
+    lexer->reset();
+    EXPECT_EQ(lexer->nextToken()->getText(), "def");
+  }
+
+  TEST_F(CancellationTokenTest, StopsTheLexerAtTheDeadline) {
+    ANTLRInputStream input(createText(100));
+    auto lexer = createLexer(&input);
+    CancellationToken token(std::chrono::nanoseconds(0));
+    lexer->setCancellationToken(&token);
+
+    // The clock is only read every few tokens.
+    size_t count = 0;
+    EXPECT_THROW({
+      while (lexer->nextToken()->getType() != Token::EOF) {
+        ++count;
+      }
+    }, DeadlineExceededException);
+    EXPECT_LT(count, Recognizer::CANCELLATION_CLOCK_INTERVAL);
+  }
+
+  TEST_F(CancellationTokenTest, StopsTheLexerInsideALongToken) {
+    // The whitespace is a single skipped token, so the lexer does not finish a token in between.
+    std::string text = "x" + std::string(100 * atn::LexerATNSimulator::CANCELLATION_CHECK_INTERVAL, ' ') + "y";
+    dfa::LexerDFATable table = dfa::LexerDFATable::build(*lexerATN);
+
+    auto check = [&](CharStream *input, const dfa::LexerDFATable *dfaTable) {
+      auto lexer = createLexer(input);
+      lexer->getInterpreter<atn::LexerATNSimulator>()->setDFATable(dfaTable);
+      CancellationToken token(std::chrono::nanoseconds(0));
+      lexer->setCancellationToken(&token);
+      EXPECT_EQ(lexer->nextToken()->getText(), "x");
+      EXPECT_THROW(lexer->nextToken(), DeadlineExceededException);
+    };
+
+    // Read directly from the buffer, with and without the self-loop scan of the simulator.
+    ANTLRInputStream direct(text);
+    check(&direct, nullptr);
+    ANTLRInputStream directTable(text);
+    check(&directTable, &table);
+
+    // Read through the CharStream interface, which the simulator uses for streams it does not know.
+    DerivedInputStream derived(text);
+    check(&derived, nullptr);
+    DerivedInputStream derivedTable(text);
+    check(&derivedTable, &table);
+  }
+
+  TEST_F(CancellationTokenTest, StopsAFullContextPredictionAndKeepsTheDFAUsable) {
+    // s : 'p' e 'x' | 'q' e ;  e : 'i' | 'i' 'x' ;  with 'p' 1, 'q' 2, 'x' 3 and 'i' 4. After "i x"
+    // both alternatives of e reach the end of s in SLL mode, so e is predicted with full context.
+    const int32_t serialized[] = {
+      4, 1, 4,
+      20, 2, 0, 7, 0, 2, 1, 7, 1, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 3, 0, 12, 8, 0,
+      1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 1, 19, 8, 1,
+      0,
+      0,
+      2, 0, 2,
+      0,
+      0,
+      20,
+      0, 11, 1, 0, 0, 0, 11, 4, 1, 0, 0, 0, 11, 8, 1, 0, 0, 0, 4, 5, 5, 1, 0, 0, 5, 6, 3, 2, 1, 0,
+      6, 7, 5, 3, 0, 0, 7, 12, 1, 0, 0, 0, 8, 9, 5, 2, 0, 0, 9, 10, 3, 2, 1, 0, 10, 12, 1, 0, 0, 0,
+      12, 1, 1, 0, 0, 0, 2, 18, 1, 0, 0, 0, 18, 13, 1, 0, 0, 0, 18, 15, 1, 0, 0, 0, 13, 14, 5, 4, 0, 0,
+      14, 19, 1, 0, 0, 0, 15, 16, 5, 4, 0, 0, 16, 17, 5, 3, 0, 0, 17, 19, 1, 0, 0, 0, 19, 3, 1, 0, 0, 0,
+      2, 11, 18
+    };
+    std::unique_ptr<atn::ATN> atn = atn::ATNDeserializer().deserialize(
+      atn::SerializedATNView(serialized, std::size(serialized)));
+    const dfa::Vocabulary vocabulary;
+    const std::vector<std::string> ruleNames = { "s", "e" };
+
+    auto createTokens = [](std::vector<size_t> types) {
+      std::vector<std::unique_ptr<Token>> tokens;
+      for (size_t type : types) {
+        tokens.push_back(std::make_unique<CommonToken>(type, std::string(1, " pqxi"[type])));
+      }
+      return std::make_unique<ListTokenSource>(std::move(tokens));
+    };
+    auto source = createTokens({ 2, 4, 3 });
+    CommonTokenStream tokens(source.get());
+    tokens.fill();
+
+    ParserInterpreter parser("Full.g4", vocabulary, ruleNames, *atn, &tokens);
+    parser.removeErrorListeners();
+    CancellationToken token;
+    CancelAtFullContext listener(token);
+    parser.addErrorListener(&listener);
+    parser.setCancellationToken(&token);
+    EXPECT_THROW(parser.parse(0), OperationCancelledException);
+    EXPECT_TRUE(token.isCancelled());
+
+    // The DFA state which requires full context is kept, and both of its resolutions still work.
+    parser.removeErrorListeners();
+    parser.setCancellationToken(nullptr);
+    parser.reset();
+    EXPECT_EQ(parser.parse(0)->toStringTree(&parser), "(s q (e i x))");
+    EXPECT_EQ(parser.getNumberOfSyntaxErrors(), 0u);
+
+    auto otherSource = createTokens({ 1, 4, 3 });
+    CommonTokenStream otherTokens(otherSource.get());
+    parser.setTokenStream(&otherTokens);
+    EXPECT_EQ(parser.parse(0)->toStringTree(&parser), "(s p (e i) x)");
+    EXPECT_EQ(parser.getNumberOfSyntaxErrors(), 0u);
+  }
+
+  TEST_F(CancellationTokenTest, StopsThePredictionAndKeepsTheDFAUsable) {
+    ANTLRInputStream input(createText(50));
+    auto lexer = createLexer(&input);
+    CommonTokenStream tokens(lexer.get());
+    tokens.fill();
+
+    auto parser = ExprGrammar::createParser(*parserATN, &tokens);
+    CancellationToken token;
+    CancelAtRule listener(token, 100);
+    parser->setCancellationToken(&token);
+    parser->addParseListener(&listener);
+    EXPECT_THROW(parser->parse(0), OperationCancelledException);
+    EXPECT_GT(tokens.index(), 0u);
+    EXPECT_LT(tokens.index(), tokens.size() - 1);
+
+    // The same parser, with the DFA built so far, gives the result of a parser that was not stopped.
+    parser->removeParseListener(&listener);
+    parser->setCancellationToken(nullptr);
+    parser->reset();
+    std::string result = parser->parse(0)->toStringTree(parser.get());
+    EXPECT_EQ(parser->getNumberOfSyntaxErrors(), 0u);
+
+    tokens.seek(0);
+    auto fresh = ExprGrammar::createParser(*parserATN, &tokens);
+    EXPECT_EQ(fresh->parse(0)->toStringTree(fresh.get()), result);
+  }
+
+}
+}
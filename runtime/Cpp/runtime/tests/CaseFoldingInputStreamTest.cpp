@@ -0,0 +1,81 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "CaseFoldingInputStream.h"
+#include "IntStream.h"
+#include "misc/Interval.h"
+#include "support/Unicode.h"
+
+namespace antlr4 {
+namespace {
+
+  using antlrcpp::Unicode;
+
+  TEST(CaseFoldingInputStreamTest, FoldsSimpleCases) {
+    EXPECT_EQ(Unicode::foldCase(U'A'), U'a');
+    EXPECT_EQ(Unicode::foldCase(U'a'), U'a');
+    EXPECT_EQ(Unicode::foldCase(U'_'), U'_');
+    EXPECT_EQ(Unicode::foldCase(U'É'), U'é');
+    EXPECT_EQ(Unicode::foldCase(U'µ'), U'μ');
+    EXPECT_EQ(Unicode::foldCase(U'ß'), U'ß');
+    EXPECT_EQ(Unicode::foldCase(U'Ā'), U'ā');
+    EXPECT_EQ(Unicode::foldCase(U'ā'), U'ā');
+    EXPECT_EQ(Unicode::foldCase(U'ſ'), U's');
+    EXPECT_EQ(Unicode::foldCase(U'Σ'), U'σ');
+    EXPECT_EQ(Unicode::foldCase(U'ς'), U'σ');
+    EXPECT_EQ(Unicode::foldCase(U'Ж'), U'ж');
+    EXPECT_EQ(Unicode::foldCase(U'ẞ'), U'ß');
+    EXPECT_EQ(Unicode::foldCase(U'K'), U'k');
+    EXPECT_EQ(Unicode::foldCase(U'Ａ'), U'ａ');
+    EXPECT_EQ(Unicode::foldCase(U'\U00010400'), U'\U00010428');
+    EXPECT_EQ(Unicode::foldCase(U'\U0001e900'), U'\U0001e922');
+    EXPECT_EQ(Unicode::foldCase(U'\U0010ffff'), U'\U0010ffff');
+  }
+
+  TEST(CaseFoldingInputStreamTest, UppercasesSimpleCases) {
+    EXPECT_EQ(Unicode::toUpper(U'a'), U'A');
+    EXPECT_EQ(Unicode::toUpper(U'Z'), U'Z');
+    EXPECT_EQ(Unicode::toUpper(U'é'), U'É');
+    EXPECT_EQ(Unicode::toUpper(U'ÿ'), U'Ÿ');
+    EXPECT_EQ(Unicode::toUpper(U'ß'), U'ß');
+    EXPECT_EQ(Unicode::toUpper(U'ı'), U'I');
+    EXPECT_EQ(Unicode::toUpper(U'ς'), U'Σ');
+    EXPECT_EQ(Unicode::toUpper(U'ж'), U'Ж');
+    EXPECT_EQ(Unicode::toUpper(U'\U00010428'), U'\U00010400');
+  }
+
+  TEST(CaseFoldingInputStreamTest, LexerSeesFoldedText) {
+    CaseFoldingInputStream input("SeLeCt ÄΣ");
+    ASSERT_EQ(input.size(), 9u);
+    std::u32string seen;
+    while (input.LA(1) != IntStream::EOF) {
+      seen += static_cast<char32_t>(input.LA(1));
+      input.consume();
+    }
+    EXPECT_EQ(seen, U"select äσ");
+    EXPECT_EQ(input.LA(-1), U'σ');
+  }
+
+  TEST(CaseFoldingInputStreamTest, TextKeepsOriginalCase) {
+    CaseFoldingInputStream input(U"SeLeCt ÄΣ", CaseFoldingInputStream::Case::UPPER);
+    EXPECT_EQ(input.LA(1), U'S');
+    EXPECT_EQ(input.LA(2), U'E');
+    EXPECT_EQ(input.LA(8), U'Ä');
+    EXPECT_EQ(input.getText(misc::Interval(size_t(0), size_t(5))), "SeLeCt");
+    EXPECT_EQ(input.getText(misc::Interval(size_t(7), size_t(20))), "ÄΣ");
+    EXPECT_EQ(input.getText(misc::Interval(size_t(20), size_t(30))), "");
+    EXPECT_EQ(input.toString(), "SeLeCt ÄΣ");
+  }
+
+  TEST(CaseFoldingInputStreamTest, ReloadFoldsAgain) {
+    CaseFoldingInputStream input("ABC");
+    input.consume();
+    input.load(std::string("XyZ"));
+    EXPECT_EQ(input.index(), 0u);
+    EXPECT_EQ(input.LA(1), U'x');
+    EXPECT_EQ(input.LA(3), U'z');
+    EXPECT_EQ(input.toString(), "XyZ");
+  }
+
+}
+}
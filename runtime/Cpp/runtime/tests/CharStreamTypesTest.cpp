@@ -0,0 +1,92 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "CaseFoldingInputStream.h"
+#include "CodePointStream.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "atn/LexerATNSimulator.h"
+#include "dfa/LexerDFATable.h"
+#include "misc/Interval.h"
+#include "support/Utf8.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  /// Forwards to another stream. The lexer does not know this type, so it takes the generic path.
+  class ForwardingStream final : public CharStream {
+  public:
+    explicit ForwardingStream(CharStream &stream) : _stream(stream) {}
+
+    void consume() override { _stream.consume(); }
+    size_t LA(ssize_t i) override { return _stream.LA(i); }
+    ssize_t mark() override { return _stream.mark(); }
+    void release(ssize_t marker) override { _stream.release(marker); }
+    size_t index() override { return _stream.index(); }
+    void seek(size_t index) override { _stream.seek(index); }
+    size_t size() override { return _stream.size(); }
+    std::string getSourceName() const override { return _stream.getSourceName(); }
+    std::string getText(const misc::Interval &interval) override { return _stream.getText(interval); }
+    std::string toString() const override { return _stream.toString(); }
+
+  private:
+    CharStream &_stream;
+  };
+
+  class CharStreamTypesTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> atn = ExprGrammar::deserializeLexerATN();
+    dfa::LexerDFATable table = dfa::LexerDFATable::build(*atn);
+
+    std::string lex(CharStream &input, const dfa::LexerDFATable *dfaTable) {
+      auto lexer = ExprGrammar::createLexer(*atn, &input);
+      lexer->getInterpreter<atn::LexerATNSimulator>()->setDFATable(dfaTable);
+      std::string result;
+      for (const auto &token : lexer->getAllTokens()) {
+        result += token->toString() + "\n";
+      }
+      return result + "errors: " + std::to_string(lexer->getNumberOfSyntaxErrors());
+    }
+  };
+
+  TEST_F(CharStreamTypesTest, SameTokensForAllStreams) {
+    // Long runs exercise the bulk scan of self-looping states, and the uppercase identifiers the case
+    // folding, which must not turn them into keywords.
+    std::vector<std::string> texts = {
+      "",
+      "def f(a, b) {\n  return a*b+12;\r\n}\n",
+      "def DEFx(ALPHA) { x = Beta #\xc3\xa9 7; }",
+      std::string(300, 'a') + "  " + std::string(200, ' ') + std::string(100, '9') + "\t\t" + std::string(50, 'Z'),
+      "x\xf0\x9d\x84\x9ey \xe2\x82\xac returned ret retur 0x12 \r\n\r\n",
+    };
+
+    const std::vector<const dfa::LexerDFATable *> tables = { nullptr, &table };
+    for (const std::string &text : texts) {
+      for (const dfa::LexerDFATable *dfaTable : tables) {
+        ANTLRInputStream reference(text);
+        ForwardingStream generic(reference);
+        std::string expected = lex(generic, dfaTable);
+
+        ANTLRInputStream input(text);
+        EXPECT_EQ(lex(input, dfaTable), expected) << text;
+
+        CaseFoldingInputStream folding(text);
+        EXPECT_EQ(lex(folding, dfaTable), expected) << text;
+        CaseFoldingInputStream forwardedFolding(text);
+        ForwardingStream genericFolding(forwardedFolding);
+        EXPECT_EQ(lex(genericFolding, dfaTable), expected) << text;
+
+        std::u32string codePoints = antlrcpp::Utf8::lenientDecode(text);
+        CodePointStream codePointStream(codePoints);
+        EXPECT_EQ(lex(codePointStream, dfaTable), expected) << text;
+      }
+    }
+  }
+
+}
+}
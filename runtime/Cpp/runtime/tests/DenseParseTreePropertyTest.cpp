@@ -0,0 +1,77 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "CommonToken.h"
+#include "InterpreterRuleContext.h"
+#include "tree/DenseParseTreeProperty.h"
+#include "tree/ParseTreeArena.h"
+#include "tree/TerminalNodeImpl.h"
+
+namespace antlr4 {
+namespace {
+
+  class DenseParseTreePropertyTest : public ::testing::Test {
+  protected:
+    tree::ParseTreeTracker tracker;
+    CommonToken token{ 5, "x" };
+
+    void TearDown() override {
+      tracker.reset();
+    }
+  };
+
+  TEST_F(DenseParseTreePropertyTest, TrackersNumberTheirNodes) {
+    for (tree::ParseTreeArena *arena : { static_cast<tree::ParseTreeArena *>(nullptr), new tree::ParseTreeArena() }) {
+      tracker.setArena(arena);
+      EXPECT_EQ(tracker.getNodeIdLimit(), 0u);
+      ParserRuleContext *root = tracker.createInstance<InterpreterRuleContext>(nullptr, 0, 1);
+      tree::TerminalNodeImpl *leaf = tracker.createInstance<tree::TerminalNodeImpl>(&token);
+      EXPECT_EQ(root->getNodeId(), 0u);
+      EXPECT_EQ(leaf->getNodeId(), 1u);
+      EXPECT_EQ(tracker.getNodeIdLimit(), 2u);
+
+      // Ids of destroyed nodes are not used again.
+      tracker.destroy(0, 1);
+      EXPECT_EQ(tracker.createInstance<InterpreterRuleContext>(nullptr, 0, 1)->getNodeId(), 2u);
+
+      tracker.reset();
+      EXPECT_EQ(tracker.getNodeIdLimit(), 0u);
+      EXPECT_EQ(tracker.createInstance<tree::TerminalNodeImpl>(&token)->getNodeId(), 0u);
+
+      tracker.setArena(nullptr);
+      delete arena;
+    }
+
+    tree::TerminalNodeImpl untracked(&token);
+    EXPECT_EQ(untracked.getNodeId(), INVALID_INDEX);
+  }
+
+  TEST_F(DenseParseTreePropertyTest, BehavesLikeParseTreeProperty) {
+    std::vector<tree::ParseTree *> nodes;
+    for (size_t i = 0; i < 100; ++i) {
+      nodes.push_back(tracker.createInstance<InterpreterRuleContext>(nullptr, 0, i));
+    }
+    tree::TerminalNodeImpl untracked(&token);
+    nodes.push_back(&untracked);
+
+    tree::ParseTreeProperty<std::string> expected;
+    tree::DenseParseTreeProperty<std::string> dense(tracker);
+    for (size_t i = 0; i < nodes.size(); i += 3) {
+      expected.put(nodes[i], std::to_string(i));
+      dense.put(nodes[i], std::to_string(i));
+    }
+    dense.put(nodes.back(), "untracked");
+    expected.put(nodes.back(), "untracked");
+    for (size_t i = 0; i < nodes.size(); i += 6) {
+      EXPECT_EQ(dense.removeFrom(nodes[i]), expected.removeFrom(nodes[i]));
+    }
+
+    tree::ParseTreeProperty<std::string> &property = dense;
+    for (tree::ParseTree *node : nodes) {
+      EXPECT_EQ(property.get(node), expected.get(node));
+    }
+    EXPECT_EQ(dense.get(tracker.createInstance<tree::TerminalNodeImpl>(&token)), "");
+  }
+
+}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ANTLRInputStream.h"
+#include "CommonTokenStream.h"
+#include "LexerInterpreter.h"
+#include "ParserInterpreter.h"
+#include "Vocabulary.h"
+#include "atn/ATN.h"
+#include "atn/ATNDeserializer.h"
+#include "atn/LexerActionType.h"
+#include "atn/SerializedATNView.h"
+
+namespace antlr4 {
+namespace test {
+
+  // A small expression grammar for tests which need a real lexer and parser, run through
+  // LexerInterpreter and ParserInterpreter.
+  //
+  // Lexer: keywords, punctuation, ID : [a-zA-Z]+, INT : [0-9]+, NEWLINE : '\r'? '\n' -> skip and
+  // WS : [ \t]+ -> skip. The token types are 'def' 1, '(' 2, ',' 3, ')' 4, '{' 5, '}' 6, ';' 7, '=' 8,
+  // '*' 9, '/' 10, '+' 11, '-' 12, 'return' 13, ID 14, INT 15, NEWLINE 16 and WS 17.
+  //
+  // Parser:
+  //   prog : func+ ;
+  //   func : 'def' ID '(' arg (',' arg)* ')' body ;
+  //   body : '{' stat+ '}' ;
+  //   arg : ID ;
+  //   stat : expr ';' | ID '=' expr ';' | 'return' expr ';' | ';' ;
+  //   expr : expr ('*'|'/') expr | expr ('+'|'-') expr | primary ;
+  //   primary : INT | ID | '(' expr ')' ;
+  struct ExprGrammar {
+    static constexpr int32_t lexerATN[] = {
+      4,0,17,92,6,-1,2,0,7,0,2,1,7,1,2,2,7,2,2,3,7,3,2,4,7,4,2,5,7,5,2,6,7,6,2,7,7,7,2,8,7,8,2,9,7,9,2,10,7,10,
+      2,11,7,11,2,12,7,12,2,13,7,13,2,14,7,14,2,15,7,15,2,16,7,16,1,0,1,0,1,0,1,0,1,1,1,1,1,2,1,2,1,3,1,3,1,4,1,
+      4,1,5,1,5,1,6,1,6,1,7,1,7,1,8,1,8,1,9,1,9,1,10,1,10,1,11,1,11,1,12,1,12,1,12,1,12,1,12,1,12,1,12,1,13,4,
+      13,70,8,13,11,13,12,13,71,1,14,4,14,75,8,14,11,14,12,14,76,1,15,3,15,80,8,15,1,15,1,15,1,15,1,15,1,16,4,
+      16,87,8,16,11,16,12,16,88,1,16,1,16,0,0,17,1,1,3,2,5,3,7,4,9,5,11,6,13,7,15,8,17,9,19,10,21,11,23,12,25,
+      13,27,14,29,15,31,16,33,17,1,0,3,2,0,65,90,97,122,1,0,48,57,2,0,9,9,32,32,95,0,1,1,0,0,0,0,3,1,0,0,0,0,5,
+      1,0,0,0,0,7,1,0,0,0,0,9,1,0,0,0,0,11,1,0,0,0,0,13,1,0,0,0,0,15,1,0,0,0,0,17,1,0,0,0,0,19,1,0,0,0,0,21,1,0,
+      0,0,0,23,1,0,0,0,0,25,1,0,0,0,0,27,1,0,0,0,0,29,1,0,0,0,0,31,1,0,0,0,0,33,1,0,0,0,1,35,1,0,0,0,3,39,1,0,0,
+      0,5,41,1,0,0,0,7,43,1,0,0,0,9,45,1,0,0,0,11,47,1,0,0,0,13,49,1,0,0,0,15,51,1,0,0,0,17,53,1,0,0,0,19,55,1,
+      0,0,0,21,57,1,0,0,0,23,59,1,0,0,0,25,61,1,0,0,0,27,69,1,0,0,0,29,74,1,0,0,0,31,79,1,0,0,0,33,86,1,0,0,0,
+      35,36,5,100,0,0,36,37,5,101,0,0,37,38,5,102,0,0,38,2,1,0,0,0,39,40,5,40,0,0,40,4,1,0,0,0,41,42,5,44,0,0,
+      42,6,1,0,0,0,43,44,5,41,0,0,44,8,1,0,0,0,45,46,5,123,0,0,46,10,1,0,0,0,47,48,5,125,0,0,48,12,1,0,0,0,49,
+      50,5,59,0,0,50,14,1,0,0,0,51,52,5,61,0,0,52,16,1,0,0,0,53,54,5,42,0,0,54,18,1,0,0,0,55,56,5,47,0,0,56,20,
+      1,0,0,0,57,58,5,43,0,0,58,22,1,0,0,0,59,60,5,45,0,0,60,24,1,0,0,0,61,62,5,114,0,0,62,63,5,101,0,0,63,64,5,
+      116,0,0,64,65,5,117,0,0,65,66,5,114,0,0,66,67,5,110,0,0,67,26,1,0,0,0,68,70,7,0,0,0,69,68,1,0,0,0,70,71,1,
+      0,0,0,71,69,1,0,0,0,71,72,1,0,0,0,72,28,1,0,0,0,73,75,7,1,0,0,74,73,1,0,0,0,75,76,1,0,0,0,76,74,1,0,0,0,
+      76,77,1,0,0,0,77,30,1,0,0,0,78,80,5,13,0,0,79,78,1,0,0,0,79,80,1,0,0,0,80,81,1,0,0,0,81,82,5,10,0,0,82,83,
+      1,0,0,0,83,84,6,15,0,0,84,32,1,0,0,0,85,87,7,2,0,0,86,85,1,0,0,0,87,88,1,0,0,0,88,86,1,0,0,0,88,89,1,0,0,
+      0,89,90,1,0,0,0,90,91,6,16,0,0,91,34,1,0,0,0,5,0,71,76,79,88,1,6,0,0
+    };
+
+    static constexpr int32_t parserATN[] = {
+      4,1,17,81,2,0,7,0,2,1,7,1,2,2,7,2,2,3,7,3,2,4,7,4,2,5,7,5,2,6,7,6,1,0,4,0,16,8,0,11,0,12,0,17,1,1,1,1,1,1,1,
+      1,1,1,1,1,5,1,26,8,1,10,1,12,1,29,9,1,1,1,1,1,1,1,1,2,1,2,4,2,36,8,2,11,2,12,2,37,1,2,1,2,1,3,1,3,1,4,1,4,1,
+      4,1,4,1,4,1,4,1,4,1,4,1,4,1,4,1,4,1,4,1,4,3,4,57,8,4,1,5,1,5,1,5,1,5,1,5,1,5,1,5,1,5,1,5,5,5,68,8,5,10,5,12,
+      5,71,9,5,1,6,1,6,1,6,1,6,1,6,1,6,3,6,79,8,6,1,6,0,1,10,7,0,2,4,6,8,10,12,0,2,1,0,9,10,1,0,11,12,83,0,15,1,0,
+      0,0,2,19,1,0,0,0,4,33,1,0,0,0,6,41,1,0,0,0,8,56,1,0,0,0,10,58,1,0,0,0,12,78,1,0,0,0,14,16,3,2,1,0,15,14,1,0,
+      0,0,16,17,1,0,0,0,17,15,1,0,0,0,17,18,1,0,0,0,18,1,1,0,0,0,19,20,5,1,0,0,20,21,5,14,0,0,21,22,5,2,0,0,22,27,
+      3,6,3,0,23,24,5,3,0,0,24,26,3,6,3,0,25,23,1,0,0,0,26,29,1,0,0,0,27,25,1,0,0,0,27,28,1,0,0,0,28,30,1,0,0,0,
+      29,27,1,0,0,0,30,31,5,4,0,0,31,32,3,4,2,0,32,3,1,0,0,0,33,35,5,5,0,0,34,36,3,8,4,0,35,34,1,0,0,0,36,37,1,0,
+      0,0,37,35,1,0,0,0,37,38,1,0,0,0,38,39,1,0,0,0,39,40,5,6,0,0,40,5,1,0,0,0,41,42,5,14,0,0,42,7,1,0,0,0,43,44,
+      3,10,5,0,44,45,5,7,0,0,45,57,1,0,0,0,46,47,5,14,0,0,47,48,5,8,0,0,48,49,3,10,5,0,49,50,5,7,0,0,50,57,1,0,0,
+      0,51,52,5,13,0,0,52,53,3,10,5,0,53,54,5,7,0,0,54,57,1,0,0,0,55,57,5,7,0,0,56,43,1,0,0,0,56,46,1,0,0,0,56,51,
+      1,0,0,0,56,55,1,0,0,0,57,9,1,0,0,0,58,59,6,5,-1,0,59,60,3,12,6,0,60,69,1,0,0,0,61,62,10,3,0,0,62,63,7,0,0,0,
+      63,68,3,10,5,4,64,65,10,2,0,0,65,66,7,1,0,0,66,68,3,10,5,3,67,61,1,0,0,0,67,64,1,0,0,0,68,71,1,0,0,0,69,67,
+      1,0,0,0,69,70,1,0,0,0,70,11,1,0,0,0,71,69,1,0,0,0,72,79,5,15,0,0,73,79,5,14,0,0,74,75,5,2,0,0,75,76,3,10,5,
+      0,76,77,5,4,0,0,77,79,1,0,0,0,78,72,1,0,0,0,78,73,1,0,0,0,78,74,1,0,0,0,79,13,1,0,0,0,7,17,27,37,56,67,69,
+      78
+    };
+
+    inline static const dfa::Vocabulary vocabulary;
+    inline static const std::vector<std::string> lexerRuleNames = std::vector<std::string>(17, "rule");
+    inline static const std::vector<std::string> parserRuleNames = {
+      "prog", "func", "body", "arg", "stat", "expr", "primary"
+    };
+    inline static const std::vector<std::string> channelNames = { "DEFAULT_TOKEN_CHANNEL", "HIDDEN" };
+    inline static const std::vector<std::string> modeNames = { "DEFAULT_MODE" };
+
+    static atn::SerializedATNView getLexerATN() {
+      return atn::SerializedATNView(lexerATN, std::size(lexerATN));
+    }
+
+    static atn::SerializedATNView getParserATN() {
+      return atn::SerializedATNView(parserATN, std::size(parserATN));
+    }
+
+    static std::unique_ptr<atn::ATN> deserializeLexerATN() {
+      return atn::ATNDeserializer().deserialize(getLexerATN());
+    }
+
+    static std::unique_ptr<atn::ATN> deserializeParserATN() {
+      return atn::ATNDeserializer().deserialize(getParserATN());
+    }
+
+    /// The lexer ATN with NEWLINE and WS on the hidden channel instead of skipped.
+    static std::unique_ptr<atn::ATN> deserializeHiddenLexerATN() {
+      // The only lexer action is the last entry: skip becomes channel(HIDDEN).
+      std::vector<int32_t> data(std::begin(lexerATN), std::end(lexerATN));
+      data[data.size() - 3] = static_cast<int32_t>(atn::LexerActionType::CHANNEL);
+      data[data.size() - 2] = static_cast<int32_t>(Token::HIDDEN_CHANNEL);
+      return atn::ATNDeserializer().deserialize(data);
+    }
+
+    /// A lexer without error listeners.
+    static std::unique_ptr<LexerInterpreter> createLexer(const atn::ATN &atn, CharStream *input) {
+      auto lexer = std::make_unique<LexerInterpreter>("Expr.g4", vocabulary, lexerRuleNames, channelNames, modeNames,
+                                                      atn, input);
+      lexer->removeErrorListeners();
+      return lexer;
+    }
+
+    /// A parser without error listeners.
+    static std::unique_ptr<ParserInterpreter> createParser(const atn::ATN &atn, TokenStream *tokens) {
+      auto parser = std::make_unique<ParserInterpreter>("Expr.g4", vocabulary, parserRuleNames, atn, tokens);
+      parser->removeErrorListeners();
+      return parser;
+    }
+
+    /// A parser and the tokens of a text, without error listeners.
+    template<typename Tokens = CommonTokenStream>
+    struct Parse {
+      ANTLRInputStream input;
+      LexerInterpreter lexer;
+      Tokens tokens;
+      ParserInterpreter parser;
+
+      Parse(const atn::ATN &lexerATN, const atn::ATN &parserATN, const std::string &text)
+        : input(text), lexer("Expr.g4", vocabulary, lexerRuleNames, channelNames, modeNames, lexerATN, &input),
+          tokens(&lexer), parser("Expr.g4", vocabulary, parserRuleNames, parserATN, &tokens) {
+        lexer.removeErrorListeners();
+        parser.removeErrorListeners();
+      }
+    };
+  };
+
+}
+}
@@ -0,0 +1,158 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "CommonTokenStream.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "ParserInterpreter.h"
+#include "ParserRuleContext.h"
+#include "tree/ErrorNode.h"
+#include "tree/FlatParseTree.h"
+#include "tree/TerminalNode.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+  using tree::FlatParseTree;
+
+  class FlatParseTreeTest : public ::testing::Test {
+  protected:
+    using Parse = ExprGrammar::Parse<>;
+
+    std::unique_ptr<atn::ATN> lexerATN = ExprGrammar::deserializeLexerATN();
+    std::unique_ptr<atn::ATN> parserATN = ExprGrammar::deserializeParserATN();
+
+    static std::string createText(size_t functions) {
+      std::string text;
+      for (size_t i = 0; i < functions; ++i) {
+        // The missing ';' and the extra ')' make the parser add error nodes.
+        text += "def f(a, b) {\n  x = a*(b+" + std::to_string(i) + ")" + (i % 7 == 3 ? "" : ";") + "\n  return " +
+          (i % 5 == 2 ? "x-1);" : "x-1-a*b;") + "\n}\n";
+      }
+      return text;
+    }
+
+    /// The structure of a parse tree, with the source interval of every rule context.
+    static std::string dump(tree::ParseTree *node) {
+      if (tree::ErrorNode::is(node)) {
+        // The interpreter keeps only the last token it conjured up for an error node.
+        Token *token = static_cast<tree::TerminalNode *>(node)->getSymbol();
+        return token->getTokenIndex() == INVALID_INDEX ? "!" : "!" + std::to_string(token->getTokenIndex());
+      }
+      if (tree::TerminalNode::is(node)) {
+        return std::to_string(static_cast<tree::TerminalNode *>(node)->getSymbol()->getTokenIndex());
+      }
+      ParserRuleContext *ctx = static_cast<ParserRuleContext *>(node);
+      std::string result = "(" + ExprGrammar::parserRuleNames[ctx->getRuleIndex()] + "/" + std::to_string(ctx->getAltNumber()) +
+        " " + ctx->getSourceInterval().toString();
+      for (tree::ParseTree *child : ctx->children) {
+        result += " " + (child->parent == node ? dump(child) : "<wrong parent>");
+      }
+      return result + ")";
+    }
+  };
+
+  TEST_F(FlatParseTreeTest, BuildsTheSameTree) {
+    Parse parse(*lexerATN, *parserATN, createText(50));
+    FlatParseTree flat;
+    parse.parser.setFlatParseTree(&flat);
+    EXPECT_EQ(parse.parser.getFlatParseTree(), &flat);
+    std::string expected = dump(parse.parser.parse(0));
+    EXPECT_NE(expected.find("!"), std::string::npos);
+    EXPECT_EQ(dump(flat.toParseTree(parse.parser)), expected);
+
+    // The next parse replaces the tree.
+    size_t size = flat.size();
+    parse.parser.reset();
+    parse.parser.setBuildParseTree(false);
+    parse.parser.parse(0);
+    EXPECT_EQ(flat.size(), size);
+    EXPECT_EQ(dump(flat.toParseTree(parse.parser)), expected);
+    EXPECT_GE(flat.getMemoryUsage(), flat.size() * sizeof(FlatParseTree::Node));
+  }
+
+  TEST_F(FlatParseTreeTest, StartsWithALeftRecursiveRule) {
+    Parse parse(*lexerATN, *parserATN, "a+1*a-(b-c)*2");
+    FlatParseTree flat;
+    parse.parser.setFlatParseTree(&flat);
+    std::string expected = dump(parse.parser.parse(5));
+    EXPECT_EQ(flat.getNode(0).value, 5u);
+    EXPECT_EQ(dump(flat.toParseTree(parse.parser)), expected);
+  }
+
+  TEST_F(FlatParseTreeTest, Navigates) {
+    Parse parse(*lexerATN, *parserATN, "def f(a) {\n  return a+1*a;\n}\n");
+    FlatParseTree flat;
+    parse.parser.setFlatParseTree(&flat);
+    parse.parser.setBuildParseTree(false);
+    parse.parser.parse(0);
+    ASSERT_FALSE(flat.empty());
+
+    EXPECT_EQ(flat.getNode(0).kind, FlatParseTree::Kind::RULE);
+    EXPECT_EQ(flat.getNode(0).value, 0u);
+    EXPECT_EQ(flat.getNode(0).size, flat.size());
+    EXPECT_EQ(flat.getParent(0), FlatParseTree::NO_NODE);
+    EXPECT_EQ(flat.getChildCount(0), 1u);
+
+    // Every node lies in the range of its parent, and siblings follow each other.
+    for (size_t i = 1; i < flat.size(); ++i) {
+      size_t parent = flat.getParent(i);
+      ASSERT_LT(parent, i);
+      EXPECT_LE(i + flat.getNode(i).size, parent + flat.getNode(parent).size);
+      size_t next = flat.getNextSibling(i);
+      if (next != FlatParseTree::NO_NODE) {
+        EXPECT_EQ(flat.getParent(next), parent);
+        EXPECT_EQ(next, i + flat.getNode(i).size);
+      }
+    }
+
+    // The expression a+1*a is two nested binary expressions.
+    std::vector<std::string> leaves;
+    FlatParseTree::Cursor cursor(flat);
+    size_t visited = 1;
+    size_t maxDepth = 0;
+    while (cursor.gotoNext()) {
+      ++visited;
+      size_t depth = 0;
+      for (size_t node = cursor.getIndex(); flat.getParent(node) != FlatParseTree::NO_NODE; node = flat.getParent(node)) {
+        ++depth;
+      }
+      EXPECT_EQ(cursor.getDepth(), depth);
+      maxDepth = std::max(maxDepth, depth);
+      if (cursor.getNode().kind == FlatParseTree::Kind::TOKEN) {
+        leaves.push_back(parse.tokens.get(cursor.getNode().value)->getText());
+      }
+    }
+    EXPECT_EQ(visited, flat.size());
+    EXPECT_EQ(maxDepth, 8u); // prog func body stat expr expr expr primary token
+    std::string text;
+    for (const std::string &leaf : leaves) {
+      text += leaf;
+    }
+    EXPECT_EQ(text, "deff(a){returna+1*a;}");
+
+    FlatParseTree::Cursor child(flat);
+    ASSERT_TRUE(child.gotoFirstChild());
+    EXPECT_EQ(child.getNode().value, 1u); // func
+    EXPECT_FALSE(child.gotoNextSibling());
+    ASSERT_TRUE(child.gotoFirstChild());
+    EXPECT_EQ(child.getNode().kind, FlatParseTree::Kind::TOKEN);
+    size_t siblings = 1;
+    while (child.gotoNextSibling()) {
+      ++siblings;
+    }
+    EXPECT_EQ(siblings, flat.getChildCount(1));
+    EXPECT_EQ(child.getNode().value, 2u); // body
+    EXPECT_EQ(child.getDepth(), 2u);
+    EXPECT_TRUE(child.gotoParent());
+    EXPECT_TRUE(child.gotoParent());
+    EXPECT_EQ(child.getIndex(), 0u);
+    EXPECT_FALSE(child.gotoParent());
+  }
+
+}
+}
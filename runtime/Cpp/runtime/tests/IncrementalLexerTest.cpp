@@ -0,0 +1,102 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "CodePointStream.h"
+#include "ExprGrammar.h"
+#include "IncrementalLexer.h"
+#include "LexerInterpreter.h"
+#include "TokenBuffer.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  class IncrementalLexerTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> atn = ExprGrammar::deserializeLexerATN();
+
+    std::unique_ptr<LexerInterpreter> createLexer(CharStream *input) {
+      return ExprGrammar::createLexer(*atn, input);
+    }
+
+    static std::string dump(const TokenBuffer &buffer) {
+      std::string result;
+      for (size_t i = 0; i < buffer.size(); ++i) {
+        result += std::to_string(buffer.getType(i)) + " " + std::to_string(buffer.getStartIndex(i)) + "-" +
+          std::to_string(buffer.getStopIndex(i)) + " " + std::to_string(buffer.getLine(i)) + ":" +
+          std::to_string(buffer.getCharPositionInLine(i)) + " " + buffer.getText(i) + "\n";
+      }
+      return result;
+    }
+
+    /// The tokens of lexing {@code text} from scratch.
+    std::string lex(const std::u32string &text) {
+      CodePointStream input(text);
+      auto lexer = createLexer(&input);
+      TokenBuffer buffer;
+      buffer.setTokenSource(lexer.get());
+      lexer->tokenizeAll(buffer);
+      return dump(buffer);
+    }
+  };
+
+  TEST_F(IncrementalLexerTest, RelexesOnlyAroundTheEdit) {
+    std::u32string text;
+    for (size_t i = 0; i < 100; ++i) {
+      text += U"def f(a, b) {\n  return a*b+12;\n}\n";
+    }
+    auto lexer = createLexer(nullptr);
+    IncrementalLexer incremental(*lexer, text);
+    ASSERT_EQ(dump(incremental.getTokens()), lex(text));
+
+    // "return a*b+12;" becomes "return a*bc+12;" in the second function.
+    IncrementalLexer::Change change = incremental.edit(text.find(U"b+") + 34, 0, "c");
+    EXPECT_EQ(change.removedTokens, 1u);
+    EXPECT_EQ(change.insertedTokens, 1u);
+    EXPECT_EQ(incremental.getTokens().getText(change.begin), "bc");
+    EXPECT_EQ(dump(incremental.getTokens()), lex(incremental.getText()));
+
+    // Join two lines.
+    change = incremental.edit(text.find(U"{\n"), 2, " ");
+    EXPECT_LE(change.insertedTokens, 3u);
+    EXPECT_EQ(dump(incremental.getTokens()), lex(incremental.getText()));
+  }
+
+  TEST_F(IncrementalLexerTest, MatchesLexingFromScratch) {
+    std::u32string text = U"def f(a, b) {\n  return a*b+12;\n}\n";
+    auto lexer = createLexer(nullptr);
+    IncrementalLexer incremental(*lexer, text);
+
+    std::mt19937 random(42);
+    const std::u32string pieces[] = { U"", U"a", U"12", U" ", U"\n", U"return", U"(", U"#", U"de", U"f x\n" };
+    for (size_t i = 0; i < 500; ++i) {
+      size_t size = incremental.getText().size();
+      size_t offset = random() % (size + 1);
+      size_t removed = std::min<size_t>(random() % 4, size - offset);
+      incremental.edit(offset, removed, pieces[random() % (sizeof(pieces) / sizeof(pieces[0]))]);
+      ASSERT_EQ(dump(incremental.getTokens()), lex(incremental.getText())) << "edit " << i;
+    }
+  }
+
+  TEST_F(IncrementalLexerTest, EditsAtTheEnds) {
+    auto lexer = createLexer(nullptr);
+    IncrementalLexer incremental(*lexer, "");
+    EXPECT_EQ(incremental.getTokens().size(), 1u);
+
+    incremental.edit(0, 0, "x = 1");
+    EXPECT_EQ(dump(incremental.getTokens()), lex(U"x = 1"));
+    incremental.edit(5, 0, "2\n");
+    EXPECT_EQ(dump(incremental.getTokens()), lex(U"x = 12\n"));
+    incremental.edit(0, 1, "yz");
+    EXPECT_EQ(dump(incremental.getTokens()), lex(U"yz = 12\n"));
+    incremental.edit(0, 8, "");
+    EXPECT_EQ(dump(incremental.getTokens()), lex(U""));
+
+    EXPECT_THROW(incremental.edit(1, 0, "x"), IndexOutOfBoundsException);
+  }
+
+}
+}
@@ -0,0 +1,286 @@
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "CommonTokenStream.h"
+#include "ExprGrammar.h"
+#include "IncrementalParse.h"
+#include "InterpreterRuleContext.h"
+#include "LexerInterpreter.h"
+#include "ParserInterpreter.h"
+#include "ParserRuleContext.h"
+#include "tree/DenseParseTreeProperty.h"
+#include "tree/ErrorNode.h"
+#include "tree/TerminalNode.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  /// A context with token labels, switched over to new tokens like the generated contexts do.
+  class LabeledContext : public InterpreterRuleContext {
+  public:
+    Token *name = nullptr;
+    std::vector<Token *> commas;
+
+    using InterpreterRuleContext::InterpreterRuleContext;
+
+    void rebindTokens(const std::function<Token *(Token *)> &map) override {
+      InterpreterRuleContext::rebindTokens(map);
+      name = map(name);
+      for (auto &token : commas) token = map(token);
+    }
+  };
+
+  /// Parses with labels as in {@code func : 'def' name=ID '(' arg (commas+=',' arg)* ')' body ;}.
+  class LabelingParser : public ParserInterpreter {
+  public:
+    explicit LabelingParser(const atn::ATN &atn)
+      : ParserInterpreter("Expr.g4", ExprGrammar::vocabulary, ExprGrammar::parserRuleNames, atn, nullptr) {
+      removeErrorListeners();
+    }
+
+  protected:
+    InterpreterRuleContext* createInterpreterRuleContext(ParserRuleContext *parent, size_t invokingStateNumber,
+                                                         size_t ruleIndex) override {
+      return getTreeTracker().createInstance<LabeledContext>(parent, invokingStateNumber, ruleIndex);
+    }
+
+    void visitRuleStopState(atn::ATNState *p) override {
+      LabeledContext *ctx = static_cast<LabeledContext *>(_ctx);
+      if (ctx->getRuleIndex() == 1) {
+        ctx->name = ctx->getToken(14, 0)->getSymbol();
+        for (tree::TerminalNode *comma : ctx->getTokens(3)) {
+          ctx->commas.push_back(comma->getSymbol());
+        }
+      }
+      ParserInterpreter::visitRuleStopState(p);
+    }
+  };
+
+  class IncrementalParseTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> lexerATN = ExprGrammar::deserializeLexerATN();
+    std::unique_ptr<atn::ATN> parserATN = ExprGrammar::deserializeParserATN();
+
+    /// The tokens of a text.
+    struct Tokens {
+      ANTLRInputStream input;
+      LexerInterpreter lexer;
+      CommonTokenStream stream;
+
+      Tokens(const atn::ATN &atn, const std::string &text)
+        : input(text), lexer("Expr.g4", ExprGrammar::vocabulary, ExprGrammar::lexerRuleNames, ExprGrammar::channelNames,
+                             ExprGrammar::modeNames, atn, &input),
+          stream(&lexer) {
+        lexer.removeErrorListeners();
+        stream.fill();
+      }
+    };
+
+    std::unique_ptr<ParserInterpreter> createParser() {
+      return ExprGrammar::createParser(*parserATN, nullptr);
+    }
+
+    /// The tokens replaced between {@code before} and {@code after}.
+    static IncrementalLexer::Change diff(CommonTokenStream &before, CommonTokenStream &after) {
+      auto same = [&](size_t i, size_t j) {
+        return before.get(i)->getType() == after.get(j)->getType() && before.get(i)->getText() == after.get(j)->getText();
+      };
+      size_t prefix = 0;
+      while (prefix < before.size() && prefix < after.size() && same(prefix, prefix)) {
+        ++prefix;
+      }
+      size_t suffix = 0;
+      while (suffix < before.size() - prefix && suffix < after.size() - prefix &&
+             same(before.size() - suffix - 1, after.size() - suffix - 1)) {
+        ++suffix;
+      }
+      return { prefix, before.size() - prefix - suffix, after.size() - prefix - suffix };
+    }
+
+    /// Everything a parse tree node holds, and a check of the parent links.
+    static std::string dump(tree::ParseTree *node) {
+      if (tree::ErrorNode::is(node)) {
+        // The interpreter keeps only the last token it conjured up for an error node.
+        return "!";
+      }
+      if (tree::TerminalNode::is(node)) {
+        Token *token = static_cast<tree::TerminalNode *>(node)->getSymbol();
+        return std::to_string(token->getTokenIndex()) + ":" + token->getText();
+      }
+      ParserRuleContext *ctx = static_cast<ParserRuleContext *>(node);
+      std::string result = "(" + ExprGrammar::parserRuleNames[ctx->getRuleIndex()] + " " + std::to_string(ctx->invokingState) + " " +
+        ctx->getSourceInterval().toString() + (ctx->exception != nullptr ? " !" : "");
+      for (tree::ParseTree *child : ctx->children) {
+        result += " " + (child->parent == node ? dump(child) : "<wrong parent>");
+      }
+      return result + ")";
+    }
+
+    std::string parseFromScratch(CommonTokenStream &tokens) {
+      auto parser = createParser();
+      parser->setTokenStream(&tokens);
+      tokens.seek(0);
+      std::string result = dump(parser->parse(0));
+      return result + " errors: " + std::to_string(parser->getNumberOfSyntaxErrors());
+    }
+
+    static size_t countNodes(tree::ParseTree *node) {
+      size_t count = 1;
+      for (tree::ParseTree *child : node->children) {
+        count += countNodes(child);
+      }
+      return count;
+    }
+
+    static std::string createText(size_t functions) {
+      std::string text;
+      for (size_t i = 0; i < functions; ++i) {
+        std::string name = "f";
+        for (size_t n = i; n > 0; n /= 26) {
+          name += static_cast<char>('a' + n % 26);
+        }
+        text += "def " + name + "(a, b) {\n  x = a*(b+" + std::to_string(i) + ");\n  return x-1;\n}\n";
+      }
+      return text;
+    }
+  };
+
+  TEST_F(IncrementalParseTest, ReusesTheUnchangedFunctions) {
+    std::string text = createText(100);
+    auto tokens = std::make_unique<Tokens>(*lexerATN, text);
+    auto parser = createParser();
+    IncrementalParse parse(*parser, [&parser] { return parser->parse(0); });
+    parse.parse(&tokens->stream);
+    EXPECT_EQ(parse.getReusedNodeCount(), 0u);
+
+    text.replace(text.find("b+42"), 1, "c*d");
+    auto edited = std::make_unique<Tokens>(*lexerATN, text);
+    IncrementalLexer::Change change = diff(tokens->stream, edited->stream);
+    EXPECT_EQ(change.removedTokens, 1u);
+    EXPECT_EQ(change.insertedTokens, 3u);
+
+    ParserRuleContext *tree = parse.reparse(&edited->stream, change);
+    tokens = std::move(edited);
+    EXPECT_EQ(dump(tree) + " errors: 0", parseFromScratch(tokens->stream));
+    size_t nodes = countNodes(tree);
+    EXPECT_GT(parse.getReusedNodeCount(), nodes * 9 / 10);
+    EXPECT_LT(parse.getReusedNodeCount(), nodes);
+  }
+
+  TEST_F(IncrementalParseTest, ReusedNodesGetNewIds) {
+    std::string text = createText(20);
+    auto tokens = std::make_unique<Tokens>(*lexerATN, text);
+    auto parser = createParser();
+    IncrementalParse parse(*parser, [&parser] { return parser->parse(0); });
+    parse.parse(&tokens->stream);
+
+    text.replace(text.find("b+7"), 1, "c");
+    auto edited = std::make_unique<Tokens>(*lexerATN, text);
+    ParserRuleContext *tree = parse.reparse(&edited->stream, diff(tokens->stream, edited->stream));
+    ASSERT_GT(parse.getReusedNodeCount(), 0u);
+
+    std::vector<tree::ParseTree *> nodes;
+    std::vector<tree::ParseTree *> pending = { tree };
+    while (!pending.empty()) {
+      tree::ParseTree *node = pending.back();
+      pending.pop_back();
+      nodes.push_back(node);
+      pending.insert(pending.end(), node->children.begin(), node->children.end());
+    }
+
+    std::set<size_t> ids;
+    for (tree::ParseTree *node : nodes) {
+      EXPECT_LT(node->getNodeId(), parser->getTreeTracker().getNodeIdLimit());
+      ids.insert(node->getNodeId());
+    }
+    EXPECT_EQ(ids.size(), nodes.size());
+
+    tree::DenseParseTreeProperty<size_t> property(parser->getTreeTracker());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      property.put(nodes[i], i);
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      EXPECT_EQ(property.get(nodes[i]), i);
+    }
+  }
+
+  TEST_F(IncrementalParseTest, RebindsTokenLabels) {
+    std::string text = createText(20);
+    auto tokens = std::make_unique<Tokens>(*lexerATN, text);
+    LabelingParser parser(*parserATN);
+    IncrementalParse parse(parser, [&parser] { return parser.parse(0); });
+    parse.parse(&tokens->stream);
+
+    text.replace(text.find("b+7"), 1, "c*d");
+    auto edited = std::make_unique<Tokens>(*lexerATN, text);
+    ParserRuleContext *tree = parse.reparse(&edited->stream, diff(tokens->stream, edited->stream));
+    ASSERT_GT(parse.getReusedNodeCount(), 0u);
+
+    // The labels of the reused functions must not point into the deleted token stream.
+    tokens = std::move(edited);
+    ASSERT_EQ(tree->children.size(), 20u);
+    for (tree::ParseTree *child : tree->children) {
+      LabeledContext *func = static_cast<LabeledContext *>(child);
+      EXPECT_EQ(func->name, func->getToken(14, 0)->getSymbol());
+      ASSERT_EQ(func->commas.size(), 1u);
+      EXPECT_EQ(func->commas[0], func->getToken(3, 0)->getSymbol());
+      EXPECT_EQ(func->commas[0], tokens->stream.get(func->commas[0]->getTokenIndex()));
+    }
+  }
+
+  TEST_F(IncrementalParseTest, MatchesParsingFromScratch) {
+    std::string text = createText(20);
+    auto tokens = std::make_unique<Tokens>(*lexerATN, text);
+    auto parser = createParser();
+    IncrementalParse parse(*parser, [&parser] { return parser->parse(0); });
+    parse.parse(&tokens->stream);
+
+    // Random edits, many of which break the syntax for a while.
+    const std::vector<std::string> snippets = { "x", "1", " ", "+", "*", ";", "(", ")", "{", "}", "\n", "=",
+      "return ", "def g(a) { ", "a+b;", "};" };
+    std::mt19937 random(42);
+    size_t reused = 0;
+    for (size_t i = 0; i < 400; ++i) {
+      size_t offset = random() % (text.size() + 1);
+      size_t removed = std::min<size_t>(random() % 4, text.size() - offset);
+      if (random() % 3 == 0 && text.size() > 200) {
+        text.erase(offset, removed);
+      } else {
+        text.replace(offset, random() % 2 == 0 ? 0 : removed, snippets[random() % snippets.size()]);
+      }
+
+      auto edited = std::make_unique<Tokens>(*lexerATN, text);
+      ParserRuleContext *tree = parse.reparse(&edited->stream, diff(tokens->stream, edited->stream));
+      tokens = std::move(edited);
+      ASSERT_EQ(dump(tree) + " errors: " + std::to_string(parser->getNumberOfSyntaxErrors()),
+                parseFromScratch(tokens->stream)) << text;
+      reused += parse.getReusedNodeCount();
+    }
+    EXPECT_GT(reused, 0u);
+  }
+
+  TEST_F(IncrementalParseTest, ParsesFromScratchWithoutChange) {
+    std::string text = createText(3);
+    Tokens tokens(*lexerATN, text);
+    auto parser = createParser();
+    IncrementalParse parse(*parser, [&parser] { return parser->parse(0); });
+    std::string expected = parseFromScratch(tokens.stream);
+    EXPECT_EQ(dump(parse.parse(&tokens.stream)) + " errors: 0", expected);
+
+    // The same tokens again: everything but the start rule is taken over.
+    Tokens again(*lexerATN, text);
+    ParserRuleContext *tree = parse.reparse(&again.stream, { again.stream.size(), 0, 0 });
+    EXPECT_EQ(dump(tree) + " errors: 0", expected);
+    EXPECT_EQ(parse.getReusedNodeCount(), countNodes(tree) - 1);
+    EXPECT_EQ(tree->children[0]->getText(), "deff(a,b){x=a*(b+0);returnx-1;}");
+  }
+
+}
+}
@@ -0,0 +1,48 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Exceptions.h"
+#include "KeywordTable.h"
+#include "Vocabulary.h"
+
+namespace antlr4 {
+namespace {
+
+  TEST(KeywordTableTest, FindsEveryKeyword) {
+    std::vector<std::pair<std::string, size_t>> keywords;
+    for (size_t i = 0; i < 1000; ++i) {
+      keywords.emplace_back("KEYWORD_" + std::to_string(i), i + 1);
+    }
+    KeywordTable table(keywords, false);
+    EXPECT_EQ(table.size(), 1000u);
+
+    for (const auto &[keyword, tokenType] : keywords) {
+      EXPECT_EQ(table.lookup(keyword), tokenType);
+      EXPECT_EQ(table.lookup(std::u32string(keyword.begin(), keyword.end())), tokenType);
+    }
+    EXPECT_EQ(table.lookup("KEYWORD_1000"), Token::INVALID_TYPE);
+    EXPECT_EQ(table.lookup("keyword_1"), Token::INVALID_TYPE);
+    EXPECT_EQ(table.lookup(""), Token::INVALID_TYPE);
+  }
+
+  TEST(KeywordTableTest, CaseInsensitive) {
+    KeywordTable table({ { "SELECT", 3 }, { "from", 4 } }, true);
+    EXPECT_EQ(table.lookup("select"), 3u);
+    EXPECT_EQ(table.lookup("SeLeCt"), 3u);
+    EXPECT_EQ(table.lookup(U"FROM"), 4u);
+    EXPECT_EQ(table.lookup(U"fröm"), Token::INVALID_TYPE);
+
+    EXPECT_THROW(KeywordTable({ { "from", 4 }, { "FROM", 5 } }, true), IllegalArgumentException);
+    EXPECT_NO_THROW(KeywordTable({ { "from", 4 }, { "FROM", 5 } }, false));
+  }
+
+  TEST(KeywordTableTest, FromVocabulary) {
+    dfa::Vocabulary vocabulary({ "", "'where'", "" }, { "", "WHERE", "ORDER" });
+    KeywordTable table = KeywordTable::fromVocabulary(vocabulary, { 1, 2 }, true);
+    EXPECT_EQ(table.lookup("Where"), 1u);
+    EXPECT_EQ(table.lookup("order"), 2u);
+  }
+
+}
+}
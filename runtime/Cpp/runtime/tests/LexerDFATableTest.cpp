@@ -0,0 +1,93 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "Exceptions.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "atn/ATNDeserializationOptions.h"
+#include "atn/ATNDeserializer.h"
+#include "atn/LexerATNSimulator.h"
+#include "atn/SerializedATNView.h"
+#include "dfa/LexerDFATable.h"
+
+namespace antlr4 {
+namespace dfa {
+namespace {
+
+  using test::ExprGrammar;
+
+  class LexerDFATableTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> atn = ExprGrammar::deserializeLexerATN();
+
+    std::string lex(const std::string &text, const LexerDFATable *table) {
+      ANTLRInputStream input(text);
+      auto lexer = ExprGrammar::createLexer(*atn, &input);
+      lexer->getInterpreter<atn::LexerATNSimulator>()->setDFATable(table);
+
+      std::string result;
+      for (const auto &token : lexer->getAllTokens()) {
+        result += token->toString() + "\n";
+      }
+      return result + "errors: " + std::to_string(lexer->getNumberOfSyntaxErrors());
+    }
+  };
+
+  TEST_F(LexerDFATableTest, MatchesLikeTheSimulator) {
+    LexerDFATable table = LexerDFATable::build(*atn);
+    EXPECT_GT(table.getStateCount(), 1u);
+
+    for (const char *text : { "def f(a, b) {\n  return a*b+12;\r\n}\n", "x = y #\u00e9 z\n", "returned ret", "" }) {
+      EXPECT_EQ(lex(text, &table), lex(text, nullptr)) << text;
+    }
+  }
+
+  TEST_F(LexerDFATableTest, SerializationRoundTrip) {
+    LexerDFATable table = LexerDFATable::build(*atn);
+    std::vector<uint32_t> data = table.serialize(*atn);
+    LexerDFATable loaded = LexerDFATable::deserialize(data, *atn);
+    EXPECT_EQ(loaded.serialize(*atn), data);
+    EXPECT_EQ(lex("def g() { 1 }", &loaded), lex("def g() { 1 }", nullptr));
+
+    data.pop_back();
+    EXPECT_THROW(LexerDFATable::deserialize(data, *atn), IllegalArgumentException);
+  }
+
+  TEST_F(LexerDFATableTest, LoadOrBuildRebuildsStaleTables) {
+    std::vector<uint32_t> data = LexerDFATable::build(*atn).serialize(*atn);
+    EXPECT_EQ(LexerDFATable::loadOrBuild(data, *atn).serialize(*atn), data);
+
+    // A table exported for another version of the grammar is rejected by the ATN fingerprint.
+    std::vector<uint32_t> stale = data;
+    stale[1] ^= 1;
+    EXPECT_THROW(LexerDFATable::deserialize(stale, *atn), IllegalArgumentException);
+    EXPECT_EQ(LexerDFATable::loadOrBuild(stale, *atn).serialize(*atn), data);
+  }
+
+  TEST_F(LexerDFATableTest, RejectsActionsInsideLoops) {
+    // A : ('a' {act();})+ ; with the loop as a plain epsilon cycle, which needs the verification off.
+    const int32_t serialized[] = {
+      4, 0, 1,
+      6, 6, -1, 2, 0, 7, 0, 1, 0, 1, 0, 1, 0,
+      0, 0,
+      1, 1, 1,
+      1, 0,
+      0,
+      6, 0, 1, 1, 0, 0, 0, 1, 3, 1, 0, 0, 0, 3, 4, 5, 'a', 0, 0, 4, 5, 6, 0, 0, 0, 5, 3, 1, 0, 0, 0,
+      5, 2, 1, 0, 0, 0,
+      1, 0,
+      1, 1, 0, 0
+    };
+    atn::ATNDeserializationOptions options;
+    options.setVerifyATN(false);
+    std::unique_ptr<atn::ATN> loop = atn::ATNDeserializer(options).deserialize(
+      atn::SerializedATNView(serialized, std::size(serialized)));
+    EXPECT_THROW(LexerDFATable::build(*loop), UnsupportedOperationException);
+    EXPECT_THROW(LexerDFATable::deserialize(LexerDFATable::build(*atn).serialize(*atn), *loop), IllegalArgumentException);
+  }
+
+}
+}
+}
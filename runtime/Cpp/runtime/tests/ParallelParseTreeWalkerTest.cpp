@@ -0,0 +1,161 @@
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "CommonToken.h"
+#include "InterpreterRuleContext.h"
+#include "tree/ErrorNodeImpl.h"
+#include "tree/ParallelParseTreeWalker.h"
+#include "tree/ParseTreeListener.h"
+#include "tree/TerminalNodeImpl.h"
+
+namespace antlr4 {
+namespace {
+
+  constexpr size_t RULE_FILE = 0;
+  constexpr size_t RULE_FUNCTION = 1;
+  constexpr size_t RULE_BLOCK = 2;
+  constexpr size_t RULE_STATEMENT = 3;
+
+  // Counts the events by kind, and checks that rules are entered and exited in a nested order.
+  class CountingListener final : public tree::ParseTreeListener {
+  public:
+    std::map<std::string, size_t> counts;
+    size_t depth = 0;
+    bool nested = true;
+    std::string failAt;
+
+    void visitTerminal(tree::TerminalNode *node) override {
+      if (node->getText() == failAt) {
+        throw std::runtime_error("failed at " + failAt);
+      }
+      ++counts["terminal " + node->getText()];
+    }
+
+    void visitErrorNode(tree::ErrorNode *node) override {
+      ++counts["error " + node->getText()];
+    }
+
+    void enterEveryRule(ParserRuleContext *ctx) override {
+      ++counts["enter " + std::to_string(ctx->getRuleIndex())];
+      ++depth;
+    }
+
+    void exitEveryRule(ParserRuleContext *ctx) override {
+      ++counts["exit " + std::to_string(ctx->getRuleIndex())];
+      nested = nested && depth > 0;
+      --depth;
+    }
+
+    void add(const CountingListener &other) {
+      for (const auto &[event, count] : other.counts) {
+        counts[event] += count;
+      }
+      nested = nested && other.nested && other.depth == 0;
+    }
+  };
+
+  class ParallelParseTreeWalkerTest : public ::testing::Test {
+  protected:
+    tree::ParseTreeTracker tracker;
+    CommonToken name{ 5, "f" };
+    CommonToken semicolon{ 6, ";" };
+    CommonToken value{ 7, "1" };
+    CommonToken bad{ 8, "?" };
+    ParserRuleContext *root = nullptr;
+
+    void TearDown() override {
+      tracker.reset();
+    }
+
+    template<typename T, typename ... Args>
+    T* add(ParserRuleContext *parent, Args&& ... args) {
+      T *child = tracker.createInstance<T>(args...);
+      parent->addChild(child);
+      return child;
+    }
+
+    // file: (function: f block: (statement: 1 ;)*)* ;
+    void buildTree(size_t functions) {
+      root = tracker.createInstance<InterpreterRuleContext>(nullptr, 0, RULE_FILE);
+      for (size_t i = 0; i < functions; ++i) {
+        ParserRuleContext *function = add<InterpreterRuleContext>(root, root, 1, RULE_FUNCTION);
+        add<tree::TerminalNodeImpl>(function, &name);
+        ParserRuleContext *block = add<InterpreterRuleContext>(function, function, 2, RULE_BLOCK);
+        for (size_t k = 0; k < i % 7; ++k) {
+          ParserRuleContext *statement = add<InterpreterRuleContext>(block, block, 3, RULE_STATEMENT);
+          add<tree::TerminalNodeImpl>(statement, &value);
+          add<tree::TerminalNodeImpl>(statement, &semicolon);
+        }
+        if (i % 10 == 3) {
+          add<tree::ErrorNodeImpl>(block, &bad);
+        }
+      }
+      add<tree::TerminalNodeImpl>(root, &semicolon);
+    }
+
+    CountingListener walkSequentially() {
+      CountingListener listener;
+      tree::ParseTreeWalker::DEFAULT.walk(&listener, root);
+      return listener;
+    }
+
+    CountingListener walkInParallel(tree::ParallelParseTreeWalker &walker) {
+      CountingListener result;
+      size_t listeners = 0;
+      walker.walk(root, [] { return std::make_unique<CountingListener>(); },
+        [&](tree::ParseTreeListener *listener) {
+          result.add(*static_cast<CountingListener *>(listener));
+          ++listeners;
+        });
+      EXPECT_GE(listeners, 1u);
+      return result;
+    }
+  };
+
+  TEST_F(ParallelParseTreeWalkerTest, SendsTheSameEventsAsASequentialWalk) {
+    buildTree(100);
+    CountingListener expected = walkSequentially();
+    for (size_t threads : { 1, 2, 4, 16 }) {
+      tree::ParallelParseTreeWalker walker(threads);
+      CountingListener result = walkInParallel(walker);
+      EXPECT_EQ(result.counts, expected.counts) << threads << " threads";
+      EXPECT_TRUE(result.nested);
+      EXPECT_EQ(walker.getSubtreeCount(), 100u);
+    }
+  }
+
+  TEST_F(ParallelParseTreeWalkerTest, SplitsAtTheGivenDepthOrRules) {
+    buildTree(50);
+    CountingListener expected = walkSequentially();
+
+    tree::ParallelParseTreeWalker walker(4);
+    walker.setSplitDepth(3);
+    EXPECT_EQ(walkInParallel(walker).counts, expected.counts);
+    EXPECT_EQ(walker.getSubtreeCount(), 147u); // The statements, 0 to 6 in every function.
+
+    walker.setSplitRules({ RULE_BLOCK });
+    EXPECT_EQ(walkInParallel(walker).counts, expected.counts);
+    EXPECT_EQ(walker.getSubtreeCount(), 50u);
+
+    walker.setSplitDepth(0);
+    EXPECT_EQ(walkInParallel(walker).counts, expected.counts);
+    EXPECT_EQ(walker.getSubtreeCount(), 1u);
+  }
+
+  TEST_F(ParallelParseTreeWalkerTest, RethrowsExceptionsOfListeners) {
+    buildTree(20);
+    tree::ParallelParseTreeWalker walker(4);
+    bool reduced = false;
+    EXPECT_THROW(walker.walk(root, [] {
+      auto listener = std::make_unique<CountingListener>();
+      listener->failAt = "1";
+      return listener;
+    }, [&reduced](tree::ParseTreeListener *) { reduced = true; }), std::runtime_error);
+    EXPECT_FALSE(reduced);
+  }
+
+}
+}
@@ -0,0 +1,161 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "BaseErrorListener.h"
+#include "CaseFoldingInputStream.h"
+#include "CodePointStream.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "ParallelTokenizer.h"
+#include "TokenBuffer.h"
+#include "misc/IntervalSet.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  class ErrorLog final : public BaseErrorListener {
+  public:
+    std::string text;
+
+    void syntaxError(Recognizer * /*recognizer*/, Token * /*offendingSymbol*/, size_t line,
+                     size_t charPositionInLine, const std::string &msg, std::exception_ptr /*e*/) override {
+      text += std::to_string(line) + ":" + std::to_string(charPositionInLine) + " " + msg + "\n";
+    }
+  };
+
+  class ExprLexer final : public LexerInterpreter {
+  public:
+    misc::IntervalSet restartCharacters = misc::IntervalSet::of('\n');
+
+    ExprLexer(const atn::ATN &atn, CharStream *input)
+      : LexerInterpreter("Expr.g4", ExprGrammar::vocabulary, ExprGrammar::lexerRuleNames, ExprGrammar::channelNames,
+                         ExprGrammar::modeNames, atn, input) {
+    }
+
+    const misc::IntervalSet& getRestartCharacters() const override {
+      return restartCharacters;
+    }
+  };
+
+  class ParallelTokenizerTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> atn = ExprGrammar::deserializeLexerATN();
+    std::string text;
+
+    void SetUp() override {
+      for (size_t i = 0; i < 500; ++i) {
+        text += "def f" + std::to_string(i) + "(a, b) {\n  return a*b+" + std::to_string(i) + ";\n}\n";
+        if (i % 97 == 0) {
+          text += "  x = # y\n";
+        }
+      }
+    }
+
+    ParallelTokenizer createTokenizer() {
+      ParallelTokenizer tokenizer([this](CharStream *input) { return std::make_unique<ExprLexer>(*atn, input); }, 4);
+      tokenizer.setMinChunkSize(100);
+      return tokenizer;
+    }
+
+    /// Dump all tokens and errors.
+    static std::string dump(const TokenBuffer &buffer, const ErrorLog &errors) {
+      std::string result;
+      for (size_t i = 0; i < buffer.size(); ++i) {
+        result += std::to_string(buffer.getType(i)) + " " + std::to_string(buffer.getStartIndex(i)) + "-" +
+          std::to_string(buffer.getStopIndex(i)) + " " + std::to_string(buffer.getLine(i)) + ":" +
+          std::to_string(buffer.getCharPositionInLine(i)) + " " + buffer.getText(i) + "\n";
+      }
+      return result + errors.text;
+    }
+
+    std::string lex(CharStream &input, ParallelTokenizer *tokenizer, const misc::IntervalSet &restart) {
+      ExprLexer lexer(*atn, &input);
+      lexer.restartCharacters = restart;
+      ErrorLog errors;
+      lexer.removeErrorListeners();
+      lexer.addErrorListener(&errors);
+
+      TokenBuffer buffer;
+      buffer.setTokenSource(&lexer);
+      size_t count = tokenizer != nullptr ? tokenizer->tokenize(lexer, buffer) : lexer.tokenizeAll(buffer);
+      EXPECT_EQ(count, buffer.size());
+      EXPECT_EQ(buffer.getType(buffer.size() - 1), Token::EOF);
+      return dump(buffer, errors) + "errors: " + std::to_string(lexer.getNumberOfSyntaxErrors());
+    }
+  };
+
+  TEST_F(ParallelTokenizerTest, ChunksStartAfterNewlines) {
+    ANTLRInputStream input(text);
+    std::string expected = lex(input, nullptr, misc::IntervalSet::of('\n'));
+
+    ParallelTokenizer tokenizer = createTokenizer();
+    input.reset();
+    EXPECT_EQ(lex(input, &tokenizer, misc::IntervalSet::of('\n')), expected);
+    EXPECT_EQ(tokenizer.getChunkCount(), 4u);
+    EXPECT_EQ(tokenizer.getRelexedTokenCount(), 0u);
+  }
+
+  TEST_F(ParallelTokenizerTest, ResynchronizesAfterWrongRestartPoints) {
+    ANTLRInputStream input(text);
+    std::string expected = lex(input, nullptr, misc::IntervalSet::of('\n'));
+
+    // Chunks start in the middle of "def", "return" and numbers, so the first tokens of the chunks must be dropped.
+    misc::IntervalSet restart;
+    restart.add('e');
+    restart.add('1');
+    ParallelTokenizer tokenizer = createTokenizer();
+    input.reset();
+    EXPECT_EQ(lex(input, &tokenizer, restart), expected);
+    EXPECT_EQ(tokenizer.getChunkCount(), 4u);
+  }
+
+  TEST_F(ParallelTokenizerTest, StartsAtTheCurrentPosition) {
+    std::u32string data = U"x = 1\n" + std::u32string(text.begin(), text.end());
+    CodePointStream input(data);
+    std::string expected = lex(input, nullptr, misc::IntervalSet::of('\n'));
+
+    ParallelTokenizer tokenizer = createTokenizer();
+    input.seek(4);
+    CodePointStream tail(data, 4);
+    EXPECT_EQ(lex(input, &tokenizer, misc::IntervalSet::of('\n')), lex(tail, nullptr, misc::IntervalSet::of('\n')));
+  }
+
+  TEST_F(ParallelTokenizerTest, ErrorsAcrossChunkBoundaries) {
+    // Chunks start right before the bad characters, so the lexer of the preceding chunk lexes past its
+    // end and hits the same errors as the next chunk's lexer. Each error must be reported once, with
+    // the text in its original case.
+    std::string upper;
+    for (size_t i = 0; i < 300; ++i) {
+      upper += "DEF F" + std::to_string(i) + "(A) {\n  X = \xC3\x89#" + std::to_string(i) + ";\n}\n";
+    }
+    misc::IntervalSet restart;
+    restart.add('\n');
+    restart.add(0xE9); // 'é', the folded 'É'.
+
+    CaseFoldingInputStream input(upper);
+    std::string expected = lex(input, nullptr, restart);
+    EXPECT_NE(expected.find("token recognition error at: '\xC3\x89'"), std::string::npos);
+    EXPECT_EQ(expected.find("\xC3\xA9"), std::string::npos);
+
+    ParallelTokenizer tokenizer = createTokenizer();
+    input.reset();
+    EXPECT_EQ(lex(input, &tokenizer, restart), expected);
+    EXPECT_EQ(tokenizer.getChunkCount(), 4u);
+  }
+
+  TEST_F(ParallelTokenizerTest, SmallInputIsNotSplit) {
+    ANTLRInputStream input("def f() { 1 }");
+    ParallelTokenizer tokenizer = createTokenizer();
+    std::string result = lex(input, &tokenizer, misc::IntervalSet::of('\n'));
+    EXPECT_EQ(tokenizer.getChunkCount(), 1u);
+    input.reset();
+    EXPECT_EQ(result, lex(input, nullptr, misc::IntervalSet::of('\n')));
+  }
+
+}
+}
@@ -0,0 +1,103 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "CommonTokenStream.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "ParserInterpreter.h"
+#include "ParserRuleContext.h"
+#include "tree/ParseTreeArena.h"
+
+namespace antlr4 {
+namespace {
+
+  using tree::ParseTreeArena;
+  using test::ExprGrammar;
+
+  class ParseTreeArenaTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> lexerATN = ExprGrammar::deserializeLexerATN();
+    std::unique_ptr<atn::ATN> parserATN = ExprGrammar::deserializeParserATN();
+
+    static std::string createText(size_t functions) {
+      std::string text;
+      for (size_t i = 0; i < functions; ++i) {
+        // The missing ';' makes the parser add error nodes.
+        text += "def f(a, b) {\n  x = a*(b+" + std::to_string(i) + ")" + (i % 7 == 3 ? "" : ";") + "\n  return x-1;\n}\n";
+      }
+      return text;
+    }
+
+    std::string parse(const std::string &text, ParseTreeArena *arena, size_t times) {
+      ExprGrammar::Parse<> run(*lexerATN, *parserATN, text);
+      run.parser.getTreeTracker().setArena(arena);
+      std::string result;
+      for (size_t i = 0; i < times; ++i) {
+        run.parser.reset();
+        result = run.parser.parse(0)->toStringTree(&run.parser);
+      }
+      return result;
+    }
+  };
+
+  TEST_F(ParseTreeArenaTest, AllocatesAlignedMemory) {
+    ParseTreeArena arena(1024);
+    EXPECT_EQ(arena.getBlockCount(), 0u);
+    char *first = static_cast<char *>(arena.allocate(3, 1));
+    void *second = arena.allocate(8, 8);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 8, 0u);
+    EXPECT_GE(static_cast<char *>(second), first + 3);
+    void *aligned = arena.allocate(16, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+    EXPECT_EQ(arena.getBlockCount(), 1u);
+
+    for (size_t i = 0; i < 100; ++i) {
+      arena.allocate(100, 8);
+    }
+    EXPECT_GT(arena.getBlockCount(), 5u);
+
+    // Large requests do not use up the current block.
+    size_t blocks = arena.getBlockCount();
+    char *before = static_cast<char *>(arena.allocate(1, 1));
+    arena.allocate(4096, 16);
+    EXPECT_EQ(static_cast<char *>(arena.allocate(1, 1)), before + 1);
+    EXPECT_EQ(arena.getBlockCount(), blocks + 1);
+
+    arena.reset();
+    EXPECT_EQ(arena.getBlockCount(), 1u);
+    EXPECT_EQ(arena.allocate(3, 1), first);
+  }
+
+  TEST_F(ParseTreeArenaTest, BuildsTheSameTree) {
+    std::string text = createText(200);
+    ParseTreeArena arena(4096);
+    std::string expected = parse(text, nullptr, 1);
+    EXPECT_NE(expected.find("<missing"), std::string::npos);
+    EXPECT_EQ(parse(text, &arena, 3), expected);
+  }
+
+  TEST_F(ParseTreeArenaTest, ChildListsComeFromTheArena) {
+    ExprGrammar::Parse<> run(*lexerATN, *parserATN, createText(20));
+    ParserInterpreter &parser = run.parser;
+    ParseTreeArena arena;
+    parser.getTreeTracker().setArena(&arena);
+    EXPECT_EQ(parser.getTreeTracker().getArena(), &arena);
+
+    ParserRuleContext *tree = parser.parse(0);
+    EXPECT_EQ(tree->children.get_allocator().getArena(), &arena);
+    EXPECT_EQ(tree->children[0]->children.get_allocator().getArena(), &arena);
+    EXPECT_EQ(arena.getBlockCount(), 1u);
+    EXPECT_THROW(parser.getTreeTracker().release(), IllegalStateException);
+
+    // Switching back to the heap deletes the tree.
+    parser.getTreeTracker().setArena(nullptr);
+    parser.reset();
+    tree = parser.parse(0);
+    EXPECT_EQ(tree->children.get_allocator().getArena(), nullptr);
+  }
+
+}
+}
@@ -0,0 +1,366 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "CommonToken.h"
+#include "InterpreterRuleContext.h"
+#include "ParserRuleContext.h"
+#include "tree/ErrorNodeImpl.h"
+#include "tree/ParseTreeListener.h"
+#include "tree/ParseTreeWalker.h"
+#include "tree/TerminalNodeImpl.h"
+
+namespace antlr4 {
+namespace {
+
+  class StatContext;
+  class ExprContext;
+  class AddContext;
+
+  // A listener interface as the code generator writes it.
+  class TestListener : public tree::ParseTreeListener {
+  public:
+    virtual void enterStat(StatContext *ctx) = 0;
+    virtual void exitStat(StatContext *ctx) = 0;
+
+    virtual void enterExpr(ExprContext *ctx) = 0;
+    virtual void exitExpr(ExprContext *ctx) = 0;
+
+    virtual void enterAdd(AddContext *ctx) = 0;
+    virtual void exitAdd(AddContext *ctx) = 0;
+
+    template<typename Listener>
+    static void enterContext(Listener *listener, ParserRuleContext *ctx);
+
+    template<typename Listener>
+    static void exitContext(Listener *listener, ParserRuleContext *ctx);
+  };
+
+  // Context classes as the code generator writes them.
+  class StatContext : public ParserRuleContext {
+  public:
+    using ContextClass = StatContext;
+    static constexpr size_t CONTEXT_RULE_INDEX = 0;
+    static constexpr size_t CONTEXT_ALT_LABEL = 0;
+
+    StatContext(ParserRuleContext *parent, size_t invokingState) : ParserRuleContext(parent, invokingState) {
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+
+    size_t getRuleIndex() const override {
+      return 0;
+    }
+
+    void enterRule(tree::ParseTreeListener *listener) override {
+      if (auto *l = dynamic_cast<TestListener *>(listener)) {
+        l->enterStat(this);
+      }
+    }
+
+    void exitRule(tree::ParseTreeListener *listener) override {
+      if (auto *l = dynamic_cast<TestListener *>(listener)) {
+        l->exitStat(this);
+      }
+    }
+  };
+
+  class ExprContext : public ParserRuleContext {
+  public:
+    using ContextClass = ExprContext;
+    static constexpr size_t CONTEXT_RULE_INDEX = 1;
+    static constexpr size_t CONTEXT_ALT_LABEL = 0;
+
+    ExprContext(ParserRuleContext *parent, size_t invokingState) : ParserRuleContext(parent, invokingState) {
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+
+    ExprContext() = default;
+
+    size_t getRuleIndex() const override {
+      return 1;
+    }
+
+    void enterRule(tree::ParseTreeListener *listener) override {
+      if (auto *l = dynamic_cast<TestListener *>(listener)) {
+        l->enterExpr(this);
+      }
+    }
+
+    void exitRule(tree::ParseTreeListener *listener) override {
+      if (auto *l = dynamic_cast<TestListener *>(listener)) {
+        l->exitExpr(this);
+      }
+    }
+  };
+
+  class AddContext : public ExprContext {
+  public:
+    using ContextClass = AddContext;
+    static constexpr size_t CONTEXT_ALT_LABEL = 2;
+
+    explicit AddContext(ExprContext *ctx) {
+      copyFrom(ctx);
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+
+    void enterRule(tree::ParseTreeListener *listener) override {
+      if (auto *l = dynamic_cast<TestListener *>(listener)) {
+        l->enterAdd(this);
+      }
+    }
+
+    void exitRule(tree::ParseTreeListener *listener) override {
+      if (auto *l = dynamic_cast<TestListener *>(listener)) {
+        l->exitAdd(this);
+      }
+    }
+  };
+
+  template<typename Listener>
+  void TestListener::enterContext(Listener *listener, ParserRuleContext *ctx) {
+    switch (ctx->getContextType()) {
+      case RuleContext::contextType(StatContext::CONTEXT_RULE_INDEX, StatContext::CONTEXT_ALT_LABEL):
+        listener->enterStat(static_cast<StatContext *>(ctx));
+        break;
+      case RuleContext::contextType(ExprContext::CONTEXT_RULE_INDEX, ExprContext::CONTEXT_ALT_LABEL):
+        listener->enterExpr(static_cast<ExprContext *>(ctx));
+        break;
+      case RuleContext::contextType(AddContext::CONTEXT_RULE_INDEX, AddContext::CONTEXT_ALT_LABEL):
+        listener->enterAdd(static_cast<AddContext *>(ctx));
+        break;
+      default:
+        ctx->enterRule(listener);
+        break;
+    }
+  }
+
+  template<typename Listener>
+  void TestListener::exitContext(Listener *listener, ParserRuleContext *ctx) {
+    switch (ctx->getContextType()) {
+      case RuleContext::contextType(StatContext::CONTEXT_RULE_INDEX, StatContext::CONTEXT_ALT_LABEL):
+        listener->exitStat(static_cast<StatContext *>(ctx));
+        break;
+      case RuleContext::contextType(ExprContext::CONTEXT_RULE_INDEX, ExprContext::CONTEXT_ALT_LABEL):
+        listener->exitExpr(static_cast<ExprContext *>(ctx));
+        break;
+      case RuleContext::contextType(AddContext::CONTEXT_RULE_INDEX, AddContext::CONTEXT_ALT_LABEL):
+        listener->exitAdd(static_cast<AddContext *>(ctx));
+        break;
+      default:
+        ctx->exitRule(listener);
+        break;
+    }
+  }
+
+  // Records every event. Untagged contexts have their enterRule/exitRule called, which are observed by
+  // a context class of the test.
+  class RecordingListener final : public TestListener {
+  public:
+    std::vector<std::string> events;
+
+    void enterStat(StatContext *) override { events.push_back("enterStat"); }
+    void exitStat(StatContext *) override { events.push_back("exitStat"); }
+    void enterExpr(ExprContext *) override { events.push_back("enterExpr"); }
+    void exitExpr(ExprContext *) override { events.push_back("exitExpr"); }
+    void enterAdd(AddContext *) override { events.push_back("enterAdd"); }
+    void exitAdd(AddContext *) override { events.push_back("exitAdd"); }
+
+    void visitTerminal(tree::TerminalNode *node) override {
+      events.push_back("terminal " + node->getText());
+    }
+
+    void visitErrorNode(tree::ErrorNode *node) override {
+      events.push_back("error " + node->getText());
+    }
+
+    void enterEveryRule(ParserRuleContext *ctx) override {
+      events.push_back("enterEveryRule " + std::to_string(ctx->getRuleIndex()));
+    }
+
+    void exitEveryRule(ParserRuleContext *ctx) override {
+      events.push_back("exitEveryRule " + std::to_string(ctx->getRuleIndex()));
+    }
+  };
+
+  // Logs the generic events into a log shared with other listeners.
+  class LoggingListener final : public tree::ParseTreeListener {
+  public:
+    LoggingListener(std::string name, std::vector<std::string> &log) : _name(std::move(name)), _log(log) {
+    }
+
+    void visitTerminal(tree::TerminalNode *node) override {
+      _log.push_back(_name + " terminal " + node->getText());
+    }
+
+    void visitErrorNode(tree::ErrorNode *node) override {
+      _log.push_back(_name + " error " + node->getText());
+    }
+
+    void enterEveryRule(ParserRuleContext *ctx) override {
+      _log.push_back(_name + " enter " + std::to_string(ctx->getRuleIndex()));
+    }
+
+    void exitEveryRule(ParserRuleContext *ctx) override {
+      _log.push_back(_name + " exit " + std::to_string(ctx->getRuleIndex()));
+    }
+
+  private:
+    std::string _name;
+    std::vector<std::string> &_log;
+  };
+
+  // Not generated, so it has no type tags.
+  class UntaggedContext : public InterpreterRuleContext {
+  public:
+    UntaggedContext(ParserRuleContext *parent, size_t invokingState, size_t ruleIndex)
+      : InterpreterRuleContext(parent, invokingState, ruleIndex) {
+    }
+
+    void enterRule(tree::ParseTreeListener *listener) override {
+      static_cast<RecordingListener *>(listener)->events.push_back("enterRule");
+    }
+
+    void exitRule(tree::ParseTreeListener *listener) override {
+      static_cast<RecordingListener *>(listener)->events.push_back("exitRule");
+    }
+  };
+
+  class ParseTreeWalkerTest : public ::testing::Test {
+  protected:
+    tree::ParseTreeTracker tracker;
+    CommonToken a{ 5, "a" };
+    CommonToken plus{ 6, "+" };
+    CommonToken bad{ 7, "?" };
+
+    void TearDown() override {
+      tracker.reset();
+    }
+
+    template<typename T, typename ... Args>
+    T* add(ParserRuleContext *parent, Args&& ... args) {
+      T *child = tracker.createInstance<T>(args...);
+      parent->addChild(child);
+      return child;
+    }
+
+    // stat(add(expr(a) + expr(a ?)) untagged(a)) with an InterpreterRuleContext around.
+    ParserRuleContext* buildTree() {
+      ParserRuleContext *root = tracker.createInstance<InterpreterRuleContext>(nullptr, 0, 3);
+      StatContext *stat = add<StatContext>(root, root, 1);
+      ExprContext *expr = tracker.createInstance<ExprContext>(stat, 2);
+      AddContext *sum = add<AddContext>(stat, expr);
+      ExprContext *left = add<ExprContext>(sum, sum, 3);
+      add<tree::TerminalNodeImpl>(left, &a);
+      add<tree::TerminalNodeImpl>(sum, &plus);
+      ExprContext *right = add<ExprContext>(sum, sum, 4);
+      add<tree::TerminalNodeImpl>(right, &a);
+      add<tree::ErrorNodeImpl>(right, &bad);
+      UntaggedContext *untagged = add<UntaggedContext>(stat, stat, 5, 2);
+      add<tree::TerminalNodeImpl>(untagged, &a);
+      add<ExprContext>(untagged, untagged, 6);
+      return root;
+    }
+  };
+
+  TEST_F(ParseTreeWalkerTest, ContextTypeCombinesTheTypeTags) {
+    EXPECT_NE(RuleContext::contextType(1, 0), RuleContext::contextType(1, 2));
+    EXPECT_NE(RuleContext::contextType(1, 0), RuleContext::contextType(0, 1));
+
+    ExprContext *expr = tracker.createInstance<ExprContext>(nullptr, 0);
+    EXPECT_EQ(expr->getContextType(), RuleContext::contextType(1, 0));
+    EXPECT_EQ(tracker.createInstance<AddContext>(expr)->getContextType(), RuleContext::contextType(1, 2));
+    EXPECT_EQ(tracker.createInstance<InterpreterRuleContext>(nullptr, 0, 1)->getContextType(), INVALID_INDEX);
+  }
+
+  TEST_F(ParseTreeWalkerTest, TypedWalkSendsTheSameEventsAsTheVirtualWalk) {
+    ParserRuleContext *root = buildTree();
+    RecordingListener expected;
+    tree::ParseTreeWalker::DEFAULT.walk(&expected, root);
+    RecordingListener typed;
+    tree::ParseTreeWalker::walkTyped(&typed, root);
+
+    EXPECT_EQ(typed.events, expected.events);
+    EXPECT_EQ(typed.events, (std::vector<std::string>{
+      "enterEveryRule 3",
+      "enterEveryRule 0", "enterStat",
+      "enterEveryRule 1", "enterAdd",
+      "enterEveryRule 1", "enterExpr", "terminal a", "exitExpr", "exitEveryRule 1",
+      "terminal +",
+      "enterEveryRule 1", "enterExpr", "terminal a", "error ?", "exitExpr", "exitEveryRule 1",
+      "exitAdd", "exitEveryRule 1",
+      "enterEveryRule 2", "enterRule", "terminal a",
+      "enterEveryRule 1", "enterExpr", "exitExpr", "exitEveryRule 1",
+      "exitRule", "exitEveryRule 2",
+      "exitStat", "exitEveryRule 0",
+      "exitEveryRule 3",
+    }));
+  }
+
+  TEST_F(ParseTreeWalkerTest, FusedWalkSendsTheSameEventsAsSeparateWalks) {
+    ParserRuleContext *root = buildTree();
+    tree::ParseTreeWalker recursiveWalker;
+    for (const tree::ParseTreeWalker *walker : { &tree::ParseTreeWalker::DEFAULT, &recursiveWalker }) {
+      RecordingListener expected;
+      walker->walk(&expected, root);
+
+      RecordingListener first;
+      RecordingListener second;
+      RecordingListener third;
+      walker->walkAll({ &first, &second, &third }, root);
+      EXPECT_EQ(first.events, expected.events);
+      EXPECT_EQ(second.events, expected.events);
+      EXPECT_EQ(third.events, expected.events);
+    }
+  }
+
+  TEST_F(ParseTreeWalkerTest, FusedWalkCallsTheListenersInOrder) {
+    ParserRuleContext *root = tracker.createInstance<InterpreterRuleContext>(nullptr, 0, 3);
+    add<tree::TerminalNodeImpl>(root, &a);
+    add<tree::ErrorNodeImpl>(root, &bad);
+
+    tree::ParseTreeWalker recursiveWalker;
+    for (const tree::ParseTreeWalker *walker : { &tree::ParseTreeWalker::DEFAULT, &recursiveWalker }) {
+      std::vector<std::string> log;
+      LoggingListener first("1", log);
+      LoggingListener second("2", log);
+      walker->walkAll({ &first, &second }, root);
+      EXPECT_EQ(log, (std::vector<std::string>{
+        "1 enter 3", "2 enter 3",
+        "1 terminal a", "2 terminal a",
+        "1 error ?", "2 error ?",
+        "1 exit 3", "2 exit 3",
+      }));
+    }
+  }
+
+  /// Overrides the single listener walk only, which must not hide the other walks.
+  class SingleWalkOverride final : public tree::ParseTreeWalker {
+  public:
+    void walk(tree::ParseTreeListener *listener, tree::ParseTree *t) const override {
+      tree::ParseTreeWalker::walk(listener, t);
+    }
+  };
+
+  TEST_F(ParseTreeWalkerTest, SubclassesKeepAllWalks) {
+    ParserRuleContext *root = buildTree();
+    SingleWalkOverride walker;
+    RecordingListener expected;
+    walker.walk(&expected, root);
+
+    RecordingListener fused;
+    walker.walkAll({ &fused }, root);
+    RecordingListener typed;
+    SingleWalkOverride::walkTyped(&typed, root);
+    EXPECT_EQ(fused.events, expected.events);
+    EXPECT_EQ(typed.events, expected.events);
+  }
+
+  TEST_F(ParseTreeWalkerTest, TypedWalkOfALeaf) {
+    tree::TerminalNodeImpl *leaf = tracker.createInstance<tree::TerminalNodeImpl>(&a);
+    RecordingListener typed;
+    tree::ParseTreeWalker::walkTyped(&typed, leaf);
+    EXPECT_EQ(typed.events, std::vector<std::string>{ "terminal a" });
+  }
+
+}
+}
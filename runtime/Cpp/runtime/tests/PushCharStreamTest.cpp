@@ -0,0 +1,201 @@
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "BaseErrorListener.h"
+#include "Exceptions.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "PushCharStream.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  class ErrorLog final : public BaseErrorListener {
+  public:
+    std::string text;
+
+    void syntaxError(Recognizer * /*recognizer*/, Token * /*offendingSymbol*/, size_t line,
+                     size_t charPositionInLine, const std::string &msg, std::exception_ptr /*e*/) override {
+      text += std::to_string(line) + ":" + std::to_string(charPositionInLine) + " " + msg + "\n";
+    }
+  };
+
+  /// Lexes input pushed in chunks, with the tokens of the expression grammar.
+  class PushLexer {
+  public:
+    PushCharStream input;
+    std::unique_ptr<LexerInterpreter> lexer = ExprGrammar::createLexer(*atn, &input);
+    ErrorLog errors;
+    std::string tokens;
+
+    PushLexer() {
+      lexer->addErrorListener(&errors);
+    }
+
+    /// Append a chunk, or close the stream if {@code chunk} is null, and take the tokens now available.
+    size_t push(const char *chunk, size_t length) {
+      if (chunk == nullptr) {
+        input.close();
+      } else {
+        input.append(std::string_view(chunk, length));
+      }
+      size_t count = 0;
+      for (const auto &token : lexer->getAvailableTokens()) {
+        tokens += token->toString() + "\n";
+        ++count;
+      }
+      return count;
+    }
+
+    /// The tokens and errors of lexing all of {@code text} from an ANTLRInputStream.
+    static std::string lex(const std::string &text) {
+      ANTLRInputStream input(text);
+      auto lexer = ExprGrammar::createLexer(*atn, &input);
+      ErrorLog errors;
+      lexer->addErrorListener(&errors);
+      std::string result;
+      for (const auto &token : lexer->getAllTokens()) {
+        result += token->toString() + "\n";
+      }
+      return result + errors.text;
+    }
+
+  private:
+    inline static const std::unique_ptr<atn::ATN> atn = ExprGrammar::deserializeLexerATN();
+  };
+
+  TEST(PushCharStreamTest, StarvedUntilClosed) {
+    PushCharStream stream;
+    EXPECT_EQ(stream.LA(1), PushCharStream::STARVED);
+
+    stream.append(std::string_view("ab"));
+    EXPECT_EQ(stream.LA(1), U'a');
+    EXPECT_EQ(stream.LA(2), U'b');
+    EXPECT_EQ(stream.LA(3), PushCharStream::STARVED);
+
+    stream.close();
+    EXPECT_EQ(stream.LA(3), IntStream::EOF);
+    EXPECT_EQ(stream.size(), 2u);
+  }
+
+  TEST(PushCharStreamTest, SplitSequences) {
+    // BOM, U+00E9 and U+1D11E, each split over two chunks.
+    std::string_view input("\xef\xbb\xbf" "a\xc3\xa9" "\xf0\x9d\x84\x9e");
+    for (size_t split = 0; split <= input.size(); ++split) {
+      PushCharStream stream;
+      stream.append(input.substr(0, split));
+      stream.append(input.substr(split));
+      stream.close();
+
+      EXPECT_EQ(stream.LA(1), U'a');
+      EXPECT_EQ(stream.LA(2), 0xe9u);
+      EXPECT_EQ(stream.LA(3), 0x1d11eu);
+      EXPECT_EQ(stream.LA(4), IntStream::EOF);
+    }
+  }
+
+  TEST(PushCharStreamTest, IncompleteSequenceAtClose) {
+    PushCharStream strict;
+    strict.append(std::string_view("a\xc3"));
+    EXPECT_EQ(strict.LA(2), PushCharStream::STARVED);
+    EXPECT_THROW(strict.close(), IllegalArgumentException);
+
+    PushCharStream lenient(true);
+    lenient.append(std::string_view("a\xc3"));
+    lenient.close();
+    EXPECT_EQ(lenient.LA(2), 0xfffdu);
+  }
+
+  TEST(PushCharStreamTest, DropsConsumedInput) {
+    PushCharStream stream;
+    stream.append(std::string_view("abcd"));
+
+    ssize_t marker = stream.mark();
+    stream.consume();
+    stream.consume();
+    stream.consume();
+    EXPECT_EQ(stream.getText(misc::Interval(size_t(0), size_t(2))), "abc");
+    stream.release(marker);
+
+    stream.append(std::string_view("ef"));
+    EXPECT_EQ(stream.index(), 3u);
+    EXPECT_EQ(stream.LA(-1), U'c');
+    EXPECT_EQ(stream.getText(misc::Interval(size_t(3), size_t(5))), "def");
+    EXPECT_THROW(stream.getText(misc::Interval(size_t(0), size_t(2))), UnsupportedOperationException);
+  }
+
+  TEST(PushCharStreamTest, LexerSuspendsInsideTokens) {
+    PushLexer push;
+    EXPECT_EQ(push.push("def ab", 6), 1u);
+    EXPECT_TRUE(push.lexer->isSuspended());
+    EXPECT_EQ(push.push("c 12", 4), 1u);
+    EXPECT_TRUE(push.lexer->isSuspended());
+    EXPECT_FALSE(push.lexer->hitEOF);
+
+    // A token which cannot be longer is complete without more input.
+    EXPECT_EQ(push.push(" (", 2), 2u);
+    EXPECT_EQ(push.push(nullptr, 0), 0u);
+    EXPECT_FALSE(push.lexer->isSuspended());
+    EXPECT_TRUE(push.lexer->hitEOF);
+    EXPECT_EQ(push.tokens, PushLexer::lex("def abc 12 ("));
+  }
+
+  TEST(PushCharStreamTest, SubclassKeepsTokenText) {
+    class LoggingStream : public PushCharStream {
+    public:
+      size_t chunks = 0;
+
+      using PushCharStream::append;
+      void append(std::string_view chunk) override {
+        ++chunks;
+        PushCharStream::append(chunk);
+      }
+    };
+
+    LoggingStream input;
+    auto atn = ExprGrammar::deserializeLexerATN();
+    auto lexer = ExprGrammar::createLexer(*atn, &input);
+    input.append(std::string_view("def abc "));
+    std::vector<std::unique_ptr<Token>> tokens = lexer->getAvailableTokens();
+    input.append(std::string_view("xyz 12 "));
+    input.close();
+    for (auto &token : lexer->getAvailableTokens()) {
+      tokens.push_back(std::move(token));
+    }
+
+    // The first tokens' input was dropped by now.
+    EXPECT_EQ(input.chunks, 2u);
+    ASSERT_EQ(tokens.size(), 4u);
+    EXPECT_EQ(tokens[0]->getText(), "def");
+    EXPECT_EQ(tokens[1]->getText(), "abc");
+    EXPECT_EQ(tokens[2]->getText(), "xyz");
+  }
+
+  TEST(PushCharStreamTest, LexerSplitAtEveryOffset) {
+    // U+00E9 and U+1D11E are no valid input, so both lexers report errors for them.
+    std::string text = "def f(a) {\n  return a*12+b \xc3\xa9;\r\n}\n\xf0\x9d\x84\x9e x = y;\n";
+    std::string expected = PushLexer::lex(text);
+    EXPECT_NE(expected.find("token recognition error"), std::string::npos);
+
+    for (size_t split = 0; split <= text.size(); ++split) {
+      PushLexer push;
+      push.push(text.data(), split);
+      push.push(text.data() + split, text.size() - split);
+      push.push(nullptr, 0);
+      EXPECT_EQ(push.tokens + push.errors.text, expected) << split;
+    }
+
+    PushLexer bytes;
+    for (size_t i = 0; i < text.size(); ++i) {
+      bytes.push(text.data() + i, 1);
+    }
+    bytes.push(nullptr, 0);
+    EXPECT_EQ(bytes.tokens + bytes.errors.text, expected);
+  }
+
+}
+}
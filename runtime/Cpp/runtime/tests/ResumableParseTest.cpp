@@ -0,0 +1,116 @@
+#include <cmath>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "BaseErrorListener.h"
+#include "CommonTokenStream.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "ParserInterpreter.h"
+#include "ParserRuleContext.h"
+#include "PushCharStream.h"
+#include "ResumableParse.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  class ErrorLog final : public BaseErrorListener {
+  public:
+    std::string text;
+
+    void syntaxError(Recognizer * /*recognizer*/, Token * /*offendingSymbol*/, size_t line,
+                     size_t charPositionInLine, const std::string &msg, std::exception_ptr /*e*/) override {
+      text += std::to_string(line) + ":" + std::to_string(charPositionInLine) + " " + msg + "\n";
+    }
+  };
+
+  class ResumableParseTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> lexerATN = ExprGrammar::deserializeLexerATN();
+    std::unique_ptr<atn::ATN> parserATN = ExprGrammar::deserializeParserATN();
+
+    // The missing ';', the extra ')' and the 'é' make the parser and the lexer report errors.
+    std::string text = "def f(a, b) {\n  x = a*(b+1)\n  return x-1);\n}\ndef g() {\n  y = \xc3\xa9 2;\n}\n";
+
+    /// The tree and the errors of a parse of the complete text. The lexer errors come first, as the
+    /// token streams are lexed at different times.
+    std::string parse() {
+      ANTLRInputStream input(text);
+      ErrorLog lexerErrors;
+      ErrorLog errors;
+      auto lexer = ExprGrammar::createLexer(*lexerATN, &input);
+      lexer->addErrorListener(&lexerErrors);
+      CommonTokenStream tokens(lexer.get());
+      auto parser = ExprGrammar::createParser(*parserATN, &tokens);
+      parser->addErrorListener(&errors);
+      std::string tree = parser->parse(0)->toStringTree(parser.get());
+      parser->getTreeTracker().reset();
+      return tree + "\n" + lexerErrors.text + errors.text;
+    }
+
+    /// The tree and the errors of a resumable parse of the text, fed in the given chunks.
+    template<typename Chunks>
+    std::string parse(const Chunks &chunks, size_t *attempts = nullptr) {
+      PushCharStream input;
+      ErrorLog lexerErrors;
+      ErrorLog errors;
+      auto lexer = ExprGrammar::createLexer(*lexerATN, &input);
+      lexer->addErrorListener(&lexerErrors);
+      CommonTokenStream tokens(lexer.get());
+      auto parser = ExprGrammar::createParser(*parserATN, &tokens);
+      parser->addErrorListener(&errors);
+
+      std::string tree;
+      {
+        ResumableParse resumable(*parser, [&parser] { return parser->parse(0); });
+        for (std::string_view chunk : chunks) {
+          resumable.feed(chunk);
+        }
+        EXPECT_EQ(resumable.finish(), ResumableParse::Status::COMPLETED);
+        tree = resumable.getResult()->toStringTree(parser.get());
+        if (attempts != nullptr) {
+          *attempts = resumable.getAttemptCount();
+        }
+      }
+      EXPECT_EQ(parser->getErrorListenerDispatch().getErrorListeners().size(), 1u);
+      parser->getTreeTracker().reset();
+      return tree + "\n" + lexerErrors.text + errors.text;
+    }
+  };
+
+  TEST_F(ResumableParseTest, SplitAtEveryOffset) {
+    std::string expected = parse();
+    EXPECT_NE(expected.find("3:2 missing 7 at 'return'"), std::string::npos);
+    EXPECT_NE(expected.find("token recognition error"), std::string::npos);
+
+    std::string_view view(text);
+    for (size_t split = 0; split <= view.size(); ++split) {
+      std::string_view chunks[] = { view.substr(0, split), view.substr(split) };
+      EXPECT_EQ(parse(chunks), expected) << split;
+    }
+  }
+
+  TEST_F(ResumableParseTest, SingleByteChunks) {
+    for (size_t i = 0; i < 4; ++i) {
+      text += text;
+    }
+    std::string expected = parse();
+
+    std::vector<std::string_view> chunks;
+    for (size_t i = 0; i < text.size(); ++i) {
+      chunks.push_back(std::string_view(text).substr(i, 1));
+    }
+    size_t attempts = 0;
+    EXPECT_EQ(parse(chunks, &attempts), expected);
+
+    // The attempts restart when the buffered tokens have doubled.
+    EXPECT_LE(attempts, static_cast<size_t>(std::log2(text.size())) + 2);
+  }
+
+}
+}
@@ -0,0 +1,189 @@
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "CommonToken.h"
+#include "InterpreterRuleContext.h"
+#include "ParserRuleContext.h"
+#include "tree/ParseTree.h"
+#include "tree/TerminalNodeImpl.h"
+
+namespace antlr4 {
+namespace {
+
+  // Context classes as the code generator writes them.
+  class StatContext : public ParserRuleContext {
+  public:
+    using ContextClass = StatContext;
+    static constexpr size_t CONTEXT_RULE_INDEX = 0;
+    static constexpr size_t CONTEXT_ALT_LABEL = 0;
+
+    StatContext(ParserRuleContext *parent, size_t invokingState) : ParserRuleContext(parent, invokingState) {
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+
+    size_t getRuleIndex() const override {
+      return 0;
+    }
+  };
+
+  class ExprContext : public ParserRuleContext {
+  public:
+    using ContextClass = ExprContext;
+    static constexpr size_t CONTEXT_RULE_INDEX = 1;
+    static constexpr size_t CONTEXT_ALT_LABEL = 0;
+
+    ExprContext(ParserRuleContext *parent, size_t invokingState) : ParserRuleContext(parent, invokingState) {
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+
+    ExprContext() = default;
+
+    size_t getRuleIndex() const override {
+      return 1;
+    }
+  };
+
+  class AddContext : public ExprContext {
+  public:
+    using ContextClass = AddContext;
+    static constexpr size_t CONTEXT_ALT_LABEL = 2;
+
+    explicit AddContext(ExprContext *ctx) {
+      copyFrom(ctx);
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+  };
+
+  // Not generated, so found with dynamic_cast.
+  class OtherExprContext : public ExprContext {
+  public:
+    using ExprContext::ExprContext;
+  };
+
+  class RuleContextTypeTest : public ::testing::Test {
+  protected:
+    tree::ParseTreeTracker tracker;
+    CommonToken token{ 5, "x" };
+    ParserRuleContext *root = tracker.createInstance<ParserRuleContext>(nullptr, 0);
+
+    void TearDown() override {
+      tracker.reset();
+    }
+
+    template<typename T, typename ... Args>
+    T* add(Args&& ... args) {
+      T *child = tracker.createInstance<T>(args...);
+      root->addChild(child);
+      return child;
+    }
+
+    /// What getRuleContext() found before there were type tags.
+    template<typename T>
+    std::vector<T*> findWithDynamicCast() const {
+      std::vector<T*> result;
+      for (tree::ParseTree *child : root->children) {
+        if (RuleContext::is(child)) {
+          if (T *typed = dynamic_cast<T*>(child); typed != nullptr) {
+            result.push_back(typed);
+          }
+        }
+      }
+      return result;
+    }
+
+    template<typename T>
+    void expectSameAsDynamicCast() const {
+      std::vector<T*> expected = findWithDynamicCast<T>();
+      EXPECT_EQ(root->getRuleContexts<T>(), expected);
+      for (size_t i = 0; i <= expected.size(); ++i) {
+        EXPECT_EQ(root->getRuleContext<T>(i), i < expected.size() ? expected[i] : nullptr);
+      }
+    }
+
+    void addChildren(size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        switch (i % 5) {
+          case 0:
+            add<StatContext>(root, 1);
+            break;
+          case 1:
+            add<ExprContext>(root, 2);
+            break;
+          case 2: {
+            ExprContext *expr = tracker.createInstance<ExprContext>(root, 3);
+            add<AddContext>(expr);
+            break;
+          }
+          case 3:
+            add<InterpreterRuleContext>(root, 4, 1); // Same rule, but no generated class.
+            break;
+          default:
+            add<tree::TerminalNodeImpl>(&token);
+            break;
+        }
+      }
+    }
+  };
+
+  TEST_F(RuleContextTypeTest, GeneratedContextsHaveTypeTags) {
+    StatContext *stat = add<StatContext>(root, 1);
+    EXPECT_EQ(stat->getContextRuleIndex(), 0u);
+    EXPECT_EQ(stat->getContextAltLabel(), 0u);
+    ExprContext *expr = tracker.createInstance<ExprContext>(root, 2);
+    AddContext *addContext = add<AddContext>(expr);
+    EXPECT_EQ(addContext->getContextRuleIndex(), 1u);
+    EXPECT_EQ(addContext->getContextAltLabel(), 2u);
+    EXPECT_EQ(root->getContextRuleIndex(), INVALID_INDEX);
+    EXPECT_EQ(tracker.createInstance<InterpreterRuleContext>(root, 4, 1)->getContextRuleIndex(), INVALID_INDEX);
+  }
+
+  TEST_F(RuleContextTypeTest, FindsTheSameChildrenAsDynamicCast) {
+    addChildren(12);
+    add<OtherExprContext>(root, 5);
+    expectSameAsDynamicCast<StatContext>();
+    expectSameAsDynamicCast<ExprContext>();
+    expectSameAsDynamicCast<AddContext>();
+    expectSameAsDynamicCast<OtherExprContext>();
+    expectSameAsDynamicCast<InterpreterRuleContext>();
+  }
+
+  TEST_F(RuleContextTypeTest, UsesTheIndexWhileItIsValid) {
+    addChildren(ParserRuleContext::RULE_CONTEXT_INDEX_THRESHOLD * 4);
+    root->indexRuleContexts();
+    expectSameAsDynamicCast<StatContext>();
+    expectSameAsDynamicCast<ExprContext>();
+    expectSameAsDynamicCast<AddContext>();
+
+    // Children added after indexing are found as well.
+    add<ExprContext>(root, 6);
+    expectSameAsDynamicCast<ExprContext>();
+    root->indexRuleContexts();
+    expectSameAsDynamicCast<ExprContext>();
+
+    // Removing and adding children drops the index, also if the count is the same again.
+    root->indexRuleContexts();
+    root->removeLastChild();
+    add<StatContext>(root, 7);
+    expectSameAsDynamicCast<ExprContext>();
+    expectSameAsDynamicCast<StatContext>();
+  }
+
+  TEST_F(RuleContextTypeTest, ChecksTheChildrenFoundWithTheIndex) {
+    addChildren(ParserRuleContext::RULE_CONTEXT_INDEX_THRESHOLD * 4);
+    root->indexRuleContexts();
+
+    // Replace the expressions in place, so that the index points to children of another type.
+    for (tree::ParseTree *&child : root->children) {
+      if (RuleContext::is(child) && static_cast<RuleContext *>(child)->getContextRuleIndex() == 1) {
+        child = tracker.createInstance<StatContext>(root, 8);
+      }
+    }
+    expectSameAsDynamicCast<ExprContext>();
+    expectSameAsDynamicCast<AddContext>();
+    EXPECT_TRUE(root->getRuleContexts<ExprContext>().empty());
+    EXPECT_EQ(root->getRuleContext<ExprContext>(0), nullptr);
+  }
+
+}
+}
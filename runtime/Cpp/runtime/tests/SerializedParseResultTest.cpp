@@ -0,0 +1,231 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "Exceptions.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "ParserInterpreter.h"
+#include "ParserRuleContext.h"
+#include "SerializedParseResult.h"
+#include "TokenBufferStream.h"
+#include "atn/ATNDeserializer.h"
+#include "tree/ErrorNode.h"
+#include "tree/FlatParseTree.h"
+#include "tree/TerminalNode.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  using tree::FlatParseTree;
+
+  class SerializedParseResultTest : public ::testing::Test {
+  protected:
+    atn::SerializedATNView lexerATNView = ExprGrammar::getLexerATN();
+    atn::SerializedATNView parserATNView = ExprGrammar::getParserATN();
+    std::unique_ptr<atn::ATN> lexerATN = atn::ATNDeserializer().deserialize(lexerATNView);
+    std::unique_ptr<atn::ATN> parserATN = atn::ATNDeserializer().deserialize(parserATNView);
+
+    /// A parse of a text with a token buffer and a flat tree.
+    struct Parse : ExprGrammar::Parse<TokenBufferStream> {
+      FlatParseTree flat;
+      ParserRuleContext *tree;
+
+      Parse(const atn::ATN &lexerATN, const atn::ATN &parserATN, const std::string &text)
+        : ExprGrammar::Parse<TokenBufferStream>(lexerATN, parserATN, text) {
+        parser.setFlatParseTree(&flat);
+        tree = parser.parse(0);
+        tokens.fill();
+      }
+    };
+
+    static std::string createText(size_t functions) {
+      std::string text;
+      for (size_t i = 0; i < functions; ++i) {
+        // The missing ';' and the extra ')' make the parser add error nodes.
+        text += "def f(a, b) {\n  x = a*(b+" + std::to_string(i) + ")" + (i % 7 == 3 ? "" : ";") + "\n  return " +
+          (i % 5 == 2 ? "x-1);" : "x-1-a*b;") + "\n}\n";
+      }
+      return text;
+    }
+
+    /// The structure of a parse tree, with the text of the leaves and the source interval of every rule context.
+    static std::string dump(tree::ParseTree *node) {
+      if (tree::TerminalNode::is(node)) {
+        Token *token = static_cast<tree::TerminalNode *>(node)->getSymbol();
+        return (tree::ErrorNode::is(node) ? "!" : "") + token->getText();
+      }
+      ParserRuleContext *ctx = static_cast<ParserRuleContext *>(node);
+      std::string result = "(" + ExprGrammar::parserRuleNames[ctx->getRuleIndex()] + "/" + std::to_string(ctx->getAltNumber()) +
+        " " + ctx->getSourceInterval().toString();
+      for (tree::ParseTree *child : ctx->children) {
+        result += " " + dump(child);
+      }
+      return result + ")";
+    }
+
+    static std::string dump(const TokenBuffer &tokens) {
+      std::string result;
+      for (size_t i = 0; i < tokens.size(); ++i) {
+        result += std::to_string(tokens.getType(i)) + " " + std::to_string(tokens.getChannel(i)) + " " +
+          std::to_string(tokens.getStartIndex(i)) + " " + std::to_string(tokens.getStopIndex(i)) + " " +
+          std::to_string(tokens.getLine(i)) + ":" + std::to_string(tokens.getCharPositionInLine(i)) + " " +
+          tokens.getText(i) + "\n";
+      }
+      return result;
+    }
+
+    /// Load {@code data} into new tokens, and build the rule contexts again with a new parser.
+    std::string reload(const std::vector<uint32_t> &data, CharStream *input) {
+      SerializedParseResult result(data.data(), data.size(), parserATNView);
+      TokenBuffer buffer;
+      result.loadTokens(buffer, input);
+      TokenBufferStream tokens(std::move(buffer));
+      auto parser = ExprGrammar::createParser(*parserATN, &tokens);
+      FlatParseTree flat;
+      result.loadTree(flat);
+      std::string tree = dump(flat.toParseTree(*parser));
+      parser->getTreeTracker().reset();
+      return tree;
+    }
+  };
+
+  TEST_F(SerializedParseResultTest, RestoresTheTokensAndTheTree) {
+    Parse parse(*lexerATN, *parserATN, createText(20));
+    std::string expected = dump(parse.tree);
+    EXPECT_NE(expected.find("!"), std::string::npos);
+
+    std::vector<uint32_t> data = SerializedParseResult::serialize(parserATNView, parse.tokens.getBuffer(), parse.flat);
+    SerializedParseResult result(data.data(), data.size(), parserATNView);
+    EXPECT_TRUE(result.matchesSource(&parse.input));
+    EXPECT_EQ(result.getSourceChecksum(), SerializedParseResult::checksum(createText(20)));
+    EXPECT_EQ(result.getTokenCount(), parse.tokens.size());
+    ASSERT_EQ(result.getNodeCount(), parse.flat.size());
+    for (size_t i = 0; i < parse.flat.size(); ++i) {
+      const FlatParseTree::Node &node = parse.flat.getNode(i);
+      FlatParseTree::Node copy = result.getNode(i);
+      EXPECT_EQ(copy.value, node.value);
+      EXPECT_EQ(copy.size, node.size);
+      EXPECT_EQ(copy.parent, node.parent);
+      EXPECT_EQ(copy.altNumber, node.altNumber);
+      EXPECT_EQ(copy.kind, node.kind);
+    }
+
+    TokenBuffer buffer;
+    result.loadTokens(buffer, &parse.input);
+    EXPECT_EQ(dump(buffer), dump(parse.tokens.getBuffer()));
+    EXPECT_EQ(reload(data, &parse.input), expected);
+
+    // The rule contexts give the same data as the flat tree.
+    EXPECT_EQ(SerializedParseResult::serialize(parserATNView, parse.tokens.getBuffer(), parse.tree), data);
+
+    ANTLRInputStream changed(createText(20) + " ");
+    EXPECT_FALSE(result.matchesSource(&changed));
+  }
+
+  TEST_F(SerializedParseResultTest, IncludesTheTextOnRequest) {
+    Parse parse(*lexerATN, *parserATN, "def f(a) {\n  return a+1*a;\n}\n");
+    std::string expected = dump(parse.tree);
+
+    std::vector<uint32_t> data = SerializedParseResult::serialize(parserATNView, parse.tokens.getBuffer(),
+                                                                  parse.flat, true);
+    EXPECT_EQ(reload(data, nullptr), expected);
+
+    TokenBuffer buffer;
+    SerializedParseResult(data.data(), data.size(), parserATNView).loadTokens(buffer);
+    TokenBufferStream tokens(std::move(buffer));
+    EXPECT_EQ(tokens.getText(), "deff(a){returna+1*a;}");
+    EXPECT_EQ(tokens.getSourceName(), IntStream::UNKNOWN_SOURCE_NAME);
+
+    // Without the text only the token positions are known.
+    data = SerializedParseResult::serialize(parserATNView, parse.tokens.getBuffer(), parse.flat);
+    EXPECT_NE(reload(data, nullptr), expected);
+  }
+
+  TEST_F(SerializedParseResultTest, RecordsTheAlternativesOfContexts) {
+    /// A context which stores its alternative, like a contextSuperClass would.
+    class AltContext : public ParserRuleContext {
+    public:
+      explicit AltContext(size_t altNumber) : _altNumber(altNumber) {
+      }
+
+      size_t getRuleIndex() const override {
+        return 0;
+      }
+
+      size_t getAltNumber() const override {
+        return _altNumber;
+      }
+
+    private:
+      size_t _altNumber;
+    };
+
+    Parse parse(*lexerATN, *parserATN, "def f(a) {\n}\n");
+    ParserRuleContext plain;
+    AltContext stored(2);
+    AltContext tooLarge(70000);
+
+    // Plain contexts, like generated ones, do not know their alternative.
+    std::vector<uint32_t> data = SerializedParseResult::serialize(parserATNView, parse.tokens.getBuffer(), &plain);
+    EXPECT_EQ(SerializedParseResult(data.data(), data.size(), parserATNView).getNode(0).altNumber, 0u);
+    data = SerializedParseResult::serialize(parserATNView, parse.tokens.getBuffer(), &stored);
+    EXPECT_EQ(SerializedParseResult(data.data(), data.size(), parserATNView).getNode(0).altNumber, 2u);
+    EXPECT_THROW(SerializedParseResult::serialize(parserATNView, parse.tokens.getBuffer(), &tooLarge),
+                 IllegalArgumentException);
+  }
+
+  TEST_F(SerializedParseResultTest, RejectsOtherData) {
+    Parse parse(*lexerATN, *parserATN, "def f(a) {\n  x = (a;\n}\n");
+    std::vector<uint32_t> data = SerializedParseResult::serialize(parserATNView, parse.tokens.getBuffer(), parse.flat);
+    SerializedParseResult result(data.data(), data.size(), parserATNView);
+
+    // The missing ')' is recorded by its token type.
+    bool missing = false;
+    for (size_t i = 0; i < result.getNodeCount(); ++i) {
+      if (result.getNode(i).kind == FlatParseTree::Kind::MISSING) {
+        EXPECT_EQ(result.getNode(i).value, 4u);
+        missing = true;
+      }
+    }
+    EXPECT_TRUE(missing);
+
+    EXPECT_THROW(SerializedParseResult(data.data(), data.size(), lexerATNView), IllegalArgumentException);
+    for (size_t size : { static_cast<size_t>(0), static_cast<size_t>(7), data.size() / 2, data.size() - 1 }) {
+      EXPECT_THROW(SerializedParseResult(data.data(), size, parserATNView), IllegalArgumentException) << size;
+    }
+
+    std::vector<uint32_t> other = data;
+    other[0] = SerializedParseResult::SERIALIZED_VERSION + 1;
+    EXPECT_THROW(SerializedParseResult(other.data(), other.size(), parserATNView), IllegalArgumentException);
+
+    // A node which is not in the range of its parent.
+    other = data;
+    other[other.size() - 3] = 2;
+    EXPECT_THROW(SerializedParseResult(other.data(), other.size(), parserATNView), IllegalArgumentException);
+
+    // A rule node which overlaps its next sibling, while it stays in the range of its parent.
+    size_t nodes = other.size() - result.getNodeCount() * 4;
+    size_t overlapping = 0;
+    for (size_t i = 1; i < result.getNodeCount() && overlapping == 0; ++i) {
+      FlatParseTree::Node node = result.getNode(i);
+      FlatParseTree::Node parent = result.getNode(node.parent);
+      if (node.kind == FlatParseTree::Kind::RULE && i + node.size < node.parent + parent.size) {
+        overlapping = i;
+      }
+    }
+    ASSERT_NE(overlapping, 0u);
+    other = data;
+    ++other[nodes + overlapping * 4 + 1];
+    EXPECT_THROW(SerializedParseResult(other.data(), other.size(), parserATNView), IllegalArgumentException);
+
+    TokenBuffer buffer;
+    EXPECT_THROW(TokenBufferStream(std::move(buffer)), IllegalArgumentException);
+  }
+
+}
+}
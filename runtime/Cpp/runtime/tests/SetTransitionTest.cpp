@@ -0,0 +1,41 @@
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "Token.h"
+#include "atn/BasicState.h"
+#include "atn/NotSetTransition.h"
+#include "misc/IntervalSet.h"
+
+namespace antlr4 {
+namespace atn {
+namespace {
+
+  TEST(SetTransitionTest, TablesMatchSet) {
+    misc::IntervalSet set;
+    set.add('_');
+    set.add('a', 'z');
+    set.add(0xc0, 0x2af);
+    set.add(0x3400, 0x4dbf);
+    set.add(0xfb00);
+    set.add(0x10000, 0x1000b);
+    BasicState target;
+    SetTransition transition(&target, set);
+    NotSetTransition notTransition(&target, set);
+
+    for (size_t c = 0; c <= 0x10010; ++c) {
+      EXPECT_EQ(transition.contains(c), set.contains(c)) << c;
+      EXPECT_NE(transition.matches(c, 0, 0x10ffff), notTransition.matches(c, 0, 0x10ffff)) << c;
+    }
+  }
+
+  TEST(SetTransitionTest, TokenTypes) {
+    BasicState target;
+    SetTransition transition(&target, misc::IntervalSet::of(Token::EOF, 3));
+    EXPECT_TRUE(transition.contains(Token::EOF));
+    EXPECT_TRUE(transition.contains(3));
+    EXPECT_FALSE(transition.contains(4));
+  }
+
+}
+}
+}
@@ -0,0 +1,30 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "CommonToken.h"
+#include "SlabTokenFactory.h"
+
+namespace antlr4 {
+namespace {
+
+  TEST(SlabTokenFactoryTest, AllocatesInBlocks) {
+    SlabTokenFactory factory;
+    std::vector<std::unique_ptr<CommonToken>> tokens;
+    for (size_t i = 0; i <= SlabTokenFactory::BLOCK_SIZE; ++i) {
+      tokens.push_back(factory.create({ nullptr, nullptr }, 1, "t" + std::to_string(i), Token::DEFAULT_CHANNEL,
+                                      i, i, 1, i));
+    }
+    EXPECT_EQ(factory.getBlockCount(), 2u);
+
+    EXPECT_EQ(tokens[0]->getText(), "t0");
+    EXPECT_EQ(tokens[SlabTokenFactory::BLOCK_SIZE]->getCharPositionInLine(), SlabTokenFactory::BLOCK_SIZE);
+    EXPECT_EQ(reinterpret_cast<char *>(tokens[1].get()) - reinterpret_cast<char *>(tokens[0].get()),
+              reinterpret_cast<char *>(tokens[2].get()) - reinterpret_cast<char *>(tokens[1].get()));
+
+    tokens.clear(); // Destroys the tokens, the memory stays with the factory.
+    EXPECT_EQ(factory.create(2, "x")->getType(), 2u);
+  }
+
+}
+}
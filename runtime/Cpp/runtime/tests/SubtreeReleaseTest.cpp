@@ -0,0 +1,142 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "CommonTokenStream.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "ParserInterpreter.h"
+#include "ParserRuleContext.h"
+#include "tree/ParseTreeListener.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  class SubtreeReleaseTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> lexerATN = ExprGrammar::deserializeLexerATN();
+    std::unique_ptr<atn::ATN> parserATN = ExprGrammar::deserializeParserATN();
+
+    using Parse = ExprGrammar::Parse<>;
+
+    static std::string createText(size_t functions) {
+      std::string text;
+      for (size_t i = 0; i < functions; ++i) {
+        // The missing ';' makes the parser add error nodes.
+        text += "def f(a, b) {\n  x = a*(b+" + std::to_string(i) + ")" + (i % 7 == 3 ? "" : ";") +
+          "\n  return x-1-a*b;\n}\n";
+      }
+      return text;
+    }
+
+    /// Records the exit events of all rules.
+    class ExitRecorder : public tree::ParseTreeListener {
+    public:
+      std::vector<std::string> &events;
+
+      explicit ExitRecorder(std::vector<std::string> &events) : events(events) {
+      }
+
+      void enterEveryRule(ParserRuleContext * /*ctx*/) override {
+      }
+
+      void exitEveryRule(ParserRuleContext *ctx) override {
+        events.push_back("exit " + ExprGrammar::parserRuleNames[ctx->getRuleIndex()]);
+      }
+
+      void visitTerminal(tree::TerminalNode * /*node*/) override {
+      }
+
+      void visitErrorNode(tree::ErrorNode * /*node*/) override {
+      }
+    };
+  };
+
+  TEST_F(SubtreeReleaseTest, ReleasesEveryFunction) {
+    std::string text = createText(200);
+    std::vector<std::string> expected;
+    size_t allocated;
+    {
+      Parse parse(*lexerATN, *parserATN, text);
+      ParserRuleContext *tree = parse.parser.parse(0);
+      for (tree::ParseTree *child : tree->children) {
+        expected.push_back(child->toStringTree(&parse.parser));
+      }
+      allocated = parse.parser.getTreeTracker().size();
+    }
+    EXPECT_EQ(expected.size(), 200u);
+
+    Parse parse(*lexerATN, *parserATN, text);
+    std::vector<std::string> released;
+    size_t maxAllocated = 0;
+    parse.parser.setSubtreeHandler({ 1 }, [&](ParserRuleContext *ctx) {
+      released.push_back(ctx->toStringTree(&parse.parser));
+      maxAllocated = std::max(maxAllocated, parse.parser.getTreeTracker().size());
+    });
+    ParserRuleContext *tree = parse.parser.parse(0);
+    EXPECT_EQ(released, expected);
+    EXPECT_TRUE(tree->children.empty());
+    EXPECT_EQ(tree->getRuleIndex(), 0u);
+    EXPECT_LT(maxAllocated * 50, allocated);
+    EXPECT_LT(parse.parser.getTreeTracker().size() * 50, allocated);
+
+    // Again after a reset.
+    released.clear();
+    parse.parser.reset();
+    parse.parser.parse(0);
+    EXPECT_EQ(released, expected);
+  }
+
+  TEST_F(SubtreeReleaseTest, ListenersSeeTheSubtreeFirst) {
+    Parse parse(*lexerATN, *parserATN, "def f(a) {\n  x = a;\n  return x;\n}\n");
+    std::vector<std::string> events;
+    ExitRecorder recorder(events);
+    parse.parser.addParseListener(&recorder);
+    parse.parser.setSubtreeHandler({ 4, 1 }, [&](ParserRuleContext *ctx) {
+      events.push_back("release " + ctx->toStringTree(&parse.parser));
+    });
+    parse.parser.parse(0);
+
+    // Statements are released before the function, which no longer contains them then.
+    std::vector<std::string> released;
+    for (const std::string &event : events) {
+      if (event.rfind("release", 0) == 0) {
+        released.push_back(event);
+      }
+    }
+    ASSERT_EQ(released.size(), 3u);
+    EXPECT_EQ(released[0], "release (stat x = (expr (primary a)) ;)");
+    EXPECT_EQ(released[1], "release (stat return (expr (primary x)) ;)");
+    EXPECT_EQ(released[2], "release (func def f ( (arg a) ) (body { }))");
+    auto position = [&events](const std::string &event) {
+      return std::find(events.begin(), events.end(), event) - events.begin();
+    };
+    EXPECT_LT(position("exit func"), position(released[2]));
+  }
+
+  TEST_F(SubtreeReleaseTest, ReleasesLeftRecursiveRules) {
+    Parse parse(*lexerATN, *parserATN, createText(50));
+    std::vector<std::string> released;
+    parse.parser.setSubtreeHandler({ 5 }, [&](ParserRuleContext *ctx) {
+      released.push_back(ctx->getText());
+    });
+    ParserRuleContext *tree = parse.parser.parse(0);
+    // The right operand of b+0 is released first, its left operand is part of it.
+    ASSERT_GE(released.size(), 2u);
+    EXPECT_EQ(released[0], "0");
+    EXPECT_EQ(released[1], "b+");
+    EXPECT_EQ(tree->getText().find("x-1"), std::string::npos);
+
+    // The start rule is kept.
+    parse.parser.setSubtreeHandler({ 0 }, nullptr);
+    parse.parser.reset();
+    tree = parse.parser.parse(0);
+    EXPECT_EQ(tree->children.size(), 50u);
+  }
+
+}
+}
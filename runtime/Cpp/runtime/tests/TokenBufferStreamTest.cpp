@@ -0,0 +1,141 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "CommonTokenStream.h"
+#include "ExprGrammar.h"
+#include "LexerInterpreter.h"
+#include "ParserInterpreter.h"
+#include "ParserRuleContext.h"
+#include "TokenBufferStream.h"
+
+namespace antlr4 {
+namespace {
+
+  using test::ExprGrammar;
+
+  class TokenBufferStreamTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<atn::ATN> lexerATN = ExprGrammar::deserializeLexerATN();
+    std::unique_ptr<atn::ATN> hiddenLexerATN = ExprGrammar::deserializeHiddenLexerATN();
+    std::unique_ptr<atn::ATN> parserATN = ExprGrammar::deserializeParserATN();
+    std::mt19937 random{ 3 };
+
+    /// Functions with whitespace heavy statements, some of them with lexer errors.
+    std::string createText() {
+      std::string text;
+      for (size_t f = 1 + random() % 6; f > 0; --f) {
+        text += "def f" + std::to_string(f) + "(a, b) {\n";
+        for (size_t s = 1 + random() % 5; s > 0; --s) {
+          switch (random() % 5) {
+            case 0: text += "  x = a + b * (c - 1) / 2;\n"; break;
+            case 1: text += "  return a*b+c;\n"; break;
+            case 2: text += "  ;\r\n"; break;
+            case 3: text += "\t y  =  #  3;\n"; break;
+            default: text += "  y + 42 - z;\n"; break;
+          }
+        }
+        text += "}\n";
+      }
+      return text;
+    }
+
+    static std::string join(const std::vector<Token *> &tokens) {
+      std::string result;
+      for (Token *token : tokens) {
+        result += "[" + token->getText() + "]";
+      }
+      return result;
+    }
+
+    std::string parse(TokenStream &tokens) {
+      auto parser = ExprGrammar::createParser(*parserATN, &tokens);
+      std::string tree = parser->parse(0)->toStringTree(parser.get());
+      parser->getTreeTracker().reset();
+      return tree;
+    }
+  };
+
+  TEST_F(TokenBufferStreamTest, FastSkipMatchesSkip) {
+    for (size_t i = 0; i < 100; ++i) {
+      std::string text = createText();
+      ANTLRInputStream input(text);
+      auto lexer = ExprGrammar::createLexer(*lexerATN, &input);
+      std::string expected;
+      for (const auto &token : lexer->getAllTokens()) {
+        expected += token->toString() + "\n";
+      }
+
+      ANTLRInputStream fastInput(text);
+      auto fast = ExprGrammar::createLexer(*lexerATN, &fastInput);
+      fast->setFastSkip(true);
+      std::string tokens;
+      for (const auto &token : fast->getAllTokens()) {
+        tokens += token->toString() + "\n";
+      }
+      EXPECT_EQ(tokens, expected);
+
+      // The same through the TokenBuffer path of the lexer. Token views know their index.
+      ANTLRInputStream bufferInput(text);
+      auto buffered = ExprGrammar::createLexer(*lexerATN, &bufferInput);
+      buffered->setFastSkip(true);
+      TokenBufferStream stream(buffered.get());
+      stream.fill();
+      tokens.clear();
+      for (size_t j = 0; j + 1 < stream.size(); ++j) {
+        std::string token = stream.get(j)->toString();
+        tokens += "[@-1" + token.substr(token.find(',')) + "\n";
+      }
+      EXPECT_EQ(tokens, expected);
+    }
+  }
+
+  TEST_F(TokenBufferStreamTest, SeparateHiddenTokensMatchCommonTokenStream) {
+    for (size_t i = 0; i < 100; ++i) {
+      std::string text = createText();
+      ANTLRInputStream commonInput(text);
+      auto commonLexer = ExprGrammar::createLexer(*hiddenLexerATN, &commonInput);
+      CommonTokenStream common(commonLexer.get());
+
+      ANTLRInputStream separateInput(text);
+      auto separateLexer = ExprGrammar::createLexer(*hiddenLexerATN, &separateInput);
+      TokenBufferStream separate(separateLexer.get());
+      separate.setSeparateHiddenTokens(true);
+
+      ANTLRInputStream inlineInput(text);
+      auto inlineLexer = ExprGrammar::createLexer(*hiddenLexerATN, &inlineInput);
+      TokenBufferStream inlined(inlineLexer.get());
+
+      EXPECT_EQ(parse(separate), parse(common));
+      EXPECT_EQ(separate.getText(), common.getText());
+      inlined.fill();
+      EXPECT_EQ(inlined.getText(), common.getText());
+
+      size_t j = 0;
+      for (size_t k = 0; k < common.size(); ++k) {
+        EXPECT_EQ(join(inlined.getHiddenTokensToLeft(k)), join(common.getHiddenTokensToLeft(k)));
+        EXPECT_EQ(join(inlined.getHiddenTokensToRight(k)), join(common.getHiddenTokensToRight(k)));
+        if (common.get(k)->getChannel() != Token::DEFAULT_CHANNEL) {
+          continue;
+        }
+        ASSERT_LT(j, separate.size());
+        EXPECT_EQ(separate.get(j)->getText(), common.get(k)->getText());
+        EXPECT_EQ(join(separate.getHiddenTokensToLeft(j)), join(common.getHiddenTokensToLeft(k)));
+        EXPECT_EQ(join(separate.getHiddenTokensToRight(j)), join(common.getHiddenTokensToRight(k)));
+        ++j;
+      }
+      EXPECT_EQ(j, separate.size());
+      EXPECT_GT(separate.getHiddenBuffer().size(), 0u);
+      EXPECT_EQ(separate.size() + separate.getHiddenBuffer().size(), common.size());
+
+      // Hidden tokens are numbered within the hidden buffer.
+      for (Token *token : separate.getHiddenTokensToRight(0)) {
+        EXPECT_EQ(separate.getHiddenBuffer().getStartIndex(token->getTokenIndex()), token->getStartIndex());
+      }
+    }
+  }
+
+}
+}
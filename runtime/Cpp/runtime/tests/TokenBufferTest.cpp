@@ -0,0 +1,140 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "ANTLRInputStream.h"
+#include "CommonToken.h"
+#include "Exceptions.h"
+#include "PushCharStream.h"
+#include "TokenBuffer.h"
+#include "TokenSource.h"
+
+namespace antlr4 {
+namespace {
+
+  class InputSource : public TokenSource {
+  public:
+    explicit InputSource(CharStream *input) : _input(input) {}
+
+    std::unique_ptr<Token> nextToken() override { return nullptr; }
+    size_t getLine() const override { return 0; }
+    size_t getCharPositionInLine() override { return 0; }
+    CharStream* getInputStream() override { return _input; }
+    std::string getSourceName() override { return ""; }
+    TokenFactory<CommonToken>* getTokenFactory() override { return nullptr; }
+
+  private:
+    CharStream *_input;
+  };
+
+  TEST(TokenBufferTest, ColumnsRoundTrip) {
+    TokenBuffer buffer;
+    EXPECT_EQ(buffer.add(5, Token::HIDDEN_CHANNEL, 3, 7, 2, 1), 0u);
+    EXPECT_EQ(buffer.add(Token::EOF, Token::DEFAULT_CHANNEL, 0, INVALID_INDEX, 1, 0), 1u);
+
+    EXPECT_EQ(buffer.size(), 2u);
+    EXPECT_EQ(buffer.getType(0), 5u);
+    EXPECT_EQ(buffer.getChannel(0), Token::HIDDEN_CHANNEL);
+    EXPECT_EQ(buffer.getStartIndex(0), 3u);
+    EXPECT_EQ(buffer.getStopIndex(0), 7u);
+    EXPECT_EQ(buffer.getLine(0), 2u);
+    EXPECT_EQ(buffer.getCharPositionInLine(0), 1u);
+    EXPECT_EQ(buffer.getType(1), Token::EOF);
+    EXPECT_EQ(buffer.getStopIndex(1), INVALID_INDEX);
+
+    EXPECT_THROW(buffer.add(1, 0, size_t(1) << 32, 0, 1, 0), IndexOutOfBoundsException);
+  }
+
+  TEST(TokenBufferTest, TextFromInputOrOverride) {
+    ANTLRInputStream input("ab cd");
+    TokenBuffer buffer;
+    buffer.add(1, Token::DEFAULT_CHANNEL, 0, 1, 1, 0);
+    buffer.add(1, Token::DEFAULT_CHANNEL, 3, 4, 1, 3, "CD");
+    buffer.add(Token::EOF, Token::DEFAULT_CHANNEL, 5, 4, 1, 5);
+
+    EXPECT_EQ(buffer.getText(0), "");
+    EXPECT_EQ(buffer.getText(1), "CD");
+
+    InputSource source(&input);
+    buffer.setTokenSource(&source);
+
+    TokenView first(&buffer, 0);
+    EXPECT_EQ(first.getText(), "ab");
+    EXPECT_EQ(first.toString(), "[@0,0:1='ab',<1>,1:0]");
+    EXPECT_EQ(TokenView(&buffer, 1).getText(), "CD");
+    EXPECT_EQ(TokenView(&buffer, 2).getText(), "<EOF>");
+  }
+
+  TEST(TokenBufferTest, ExplicitEmptyTextIsKept) {
+    ANTLRInputStream input("ab");
+    InputSource source(&input);
+    TokenBuffer buffer;
+    buffer.setTokenSource(&source);
+    buffer.add(1, Token::DEFAULT_CHANNEL, 0, 1, 1, 0, "");
+
+    CommonToken token(1, "");
+    token.setStartIndex(0);
+    token.setStopIndex(1);
+    buffer.add(token);
+
+    EXPECT_EQ(buffer.getText(0), "");
+    EXPECT_EQ(buffer.getText(1), "");
+    EXPECT_EQ(buffer.getTextIndexes(), (std::vector<size_t>{ 0, 1 }));
+  }
+
+  TEST(TokenBufferTest, TextFromUnclosedStream) {
+    PushCharStream input;
+    input.append(std::string_view("ab cd"));
+    TokenBuffer buffer;
+    buffer.setInputStream(&input);
+    buffer.add(1, Token::DEFAULT_CHANNEL, 3, 4, 1, 3);
+
+    EXPECT_EQ(buffer.getText(0), "cd");
+  }
+
+  TEST(TokenBufferTest, ShiftFollowingTokens) {
+    TokenBuffer buffer;
+    buffer.add(1, Token::DEFAULT_CHANNEL, 0, 1, 1, 0);
+    buffer.add(1, Token::DEFAULT_CHANNEL, 3, 4, 1, 3);
+    buffer.add(1, Token::DEFAULT_CHANNEL, 6, 7, 2, 0);
+    buffer.add(Token::EOF, Token::DEFAULT_CHANNEL, 8, 7, 2, 2);
+
+    buffer.shift(1, 2, 1, 1, -1);
+    EXPECT_EQ(buffer.getStartIndex(0), 0u);
+    EXPECT_EQ(buffer.getLine(0), 1u);
+    EXPECT_EQ(buffer.getStartIndex(1), 5u);
+    EXPECT_EQ(buffer.getStopIndex(1), 6u);
+    EXPECT_EQ(buffer.getLine(1), 2u);
+    EXPECT_EQ(buffer.getCharPositionInLine(1), 2u);
+    EXPECT_EQ(buffer.getStartIndex(2), 8u);
+    EXPECT_EQ(buffer.getLine(2), 3u);
+    EXPECT_EQ(buffer.getCharPositionInLine(2), 0u);
+    EXPECT_EQ(buffer.getStopIndex(3), 9u);
+  }
+
+  TEST(TokenBufferTest, ColumnsCopy) {
+    TokenBuffer buffer;
+    buffer.add(5, Token::HIDDEN_CHANNEL, 3, 7, 2, 1);
+    buffer.add(6, Token::DEFAULT_CHANNEL, 8, 9, 2, 6, "X");
+    buffer.add(Token::EOF, Token::DEFAULT_CHANNEL, 10, INVALID_INDEX, 2, 8);
+
+    std::vector<uint32_t> data;
+    buffer.appendColumns(data);
+    ASSERT_EQ(data.size(), 3 * TokenBuffer::COLUMN_COUNT);
+
+    TokenBuffer copy;
+    copy.add(1, Token::DEFAULT_CHANNEL, 0, 0, 1, 0, "old");
+    copy.assignColumns(data.data(), 3);
+    ASSERT_EQ(copy.size(), 3u);
+    EXPECT_TRUE(copy.getTextIndexes().empty());
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(copy.getType(i), buffer.getType(i));
+      EXPECT_EQ(copy.getChannel(i), buffer.getChannel(i));
+      EXPECT_EQ(copy.getStartIndex(i), buffer.getStartIndex(i));
+      EXPECT_EQ(copy.getStopIndex(i), buffer.getStopIndex(i));
+      EXPECT_EQ(copy.getLine(i), buffer.getLine(i));
+      EXPECT_EQ(copy.getCharPositionInLine(i), buffer.getCharPositionInLine(i));
+    }
+  }
+
+}
+}
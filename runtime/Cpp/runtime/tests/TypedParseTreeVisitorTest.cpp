@@ -0,0 +1,229 @@
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "CommonToken.h"
+#include "InterpreterRuleContext.h"
+#include "ParserRuleContext.h"
+#include "tree/ErrorNodeImpl.h"
+#include "tree/TerminalNodeImpl.h"
+#include "tree/TypedParseTreeVisitor.h"
+
+namespace antlr4 {
+namespace {
+
+  // Context classes as the code generator writes them with the visitorResult option, so without accept().
+  class ExprContext : public ParserRuleContext {
+  public:
+    using ContextClass = ExprContext;
+    static constexpr size_t CONTEXT_RULE_INDEX = 1;
+    static constexpr size_t CONTEXT_ALT_LABEL = 0;
+
+    ExprContext(ParserRuleContext *parent, size_t invokingState) : ParserRuleContext(parent, invokingState) {
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+
+    ExprContext() = default;
+
+    size_t getRuleIndex() const override {
+      return 1;
+    }
+  };
+
+  class IntContext : public ExprContext {
+  public:
+    using ContextClass = IntContext;
+    static constexpr size_t CONTEXT_ALT_LABEL = 1;
+
+    explicit IntContext(ExprContext *ctx) {
+      copyFrom(ctx);
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+  };
+
+  class AddContext : public ExprContext {
+  public:
+    using ContextClass = AddContext;
+    static constexpr size_t CONTEXT_ALT_LABEL = 2;
+
+    explicit AddContext(ExprContext *ctx) {
+      copyFrom(ctx);
+      setContextType(CONTEXT_RULE_INDEX, CONTEXT_ALT_LABEL);
+    }
+  };
+
+  // A visitor interface as the code generator writes it with the visitorResult option.
+  template<typename Result>
+  class TestVisitor : public tree::TypedParseTreeVisitor<Result> {
+  public:
+    virtual Result visitInt(IntContext *context) = 0;
+
+    virtual Result visitAdd(AddContext *context) = 0;
+
+  protected:
+    Result visitContext(ParserRuleContext *ctx) override {
+      switch (ctx->getContextType()) {
+        case RuleContext::contextType(IntContext::CONTEXT_RULE_INDEX, IntContext::CONTEXT_ALT_LABEL):
+          return visitInt(static_cast<IntContext *>(ctx));
+        case RuleContext::contextType(AddContext::CONTEXT_RULE_INDEX, AddContext::CONTEXT_ALT_LABEL):
+          return visitAdd(static_cast<AddContext *>(ctx));
+        default:
+          return this->visitChildren(ctx);
+      }
+    }
+  };
+
+  class Evaluator final : public TestVisitor<int> {
+  public:
+    int visitInt(IntContext *context) override {
+      return std::stoi(context->getText());
+    }
+
+    int visitAdd(AddContext *context) override {
+      return visit(context->children[0]) + visit(context->children[2]);
+    }
+  };
+
+  // Concatenates the text of the leaves. Stops visiting the children of a node once their text has limit characters.
+  class Concatenator final : public TestVisitor<std::string> {
+  public:
+    size_t limit = std::string::npos;
+
+    std::string visitInt(IntContext *context) override {
+      return visitChildren(context);
+    }
+
+    std::string visitAdd(AddContext *context) override {
+      return "(" + visitChildren(context) + ")";
+    }
+
+    std::string visitTerminal(tree::TerminalNode *node) override {
+      return node->getText();
+    }
+
+    std::string visitErrorNode(tree::ErrorNode *node) override {
+      return "<" + node->getText() + ">";
+    }
+
+  protected:
+    std::string aggregateResult(std::string aggregate, std::string nextResult) override {
+      return aggregate + nextResult;
+    }
+
+    bool shouldVisitNextChild(tree::ParseTree * /*node*/, const std::string &currentResult) override {
+      return currentResult.size() < limit;
+    }
+  };
+
+  // Counts the rule contexts, with a result that can only be moved.
+  class Counter final : public TestVisitor<std::unique_ptr<size_t>> {
+  public:
+    std::unique_ptr<size_t> visitInt(IntContext *context) override {
+      return countRule(context);
+    }
+
+    std::unique_ptr<size_t> visitAdd(AddContext *context) override {
+      return countRule(context);
+    }
+
+  protected:
+    std::unique_ptr<size_t> visitContext(ParserRuleContext *ctx) override {
+      if (ctx->getContextType() == INVALID_INDEX) {
+        return countRule(ctx);
+      }
+      return TestVisitor::visitContext(ctx);
+    }
+
+    std::unique_ptr<size_t> defaultResult() override {
+      return std::make_unique<size_t>(0);
+    }
+
+    std::unique_ptr<size_t> aggregateResult(std::unique_ptr<size_t> aggregate,
+                                            std::unique_ptr<size_t> nextResult) override {
+      *aggregate += *nextResult;
+      return aggregate;
+    }
+
+  private:
+    std::unique_ptr<size_t> countRule(ParserRuleContext *ctx) {
+      std::unique_ptr<size_t> result = visitChildren(ctx);
+      ++*result;
+      return result;
+    }
+  };
+
+  class TypedParseTreeVisitorTest : public ::testing::Test {
+  protected:
+    tree::ParseTreeTracker tracker;
+    CommonToken one{ 5, "1" };
+    CommonToken two{ 5, "2" };
+    CommonToken forty{ 5, "40" };
+    CommonToken plus{ 6, "+" };
+    CommonToken bad{ 7, "?" };
+
+    void TearDown() override {
+      tracker.reset();
+    }
+
+    template<typename T, typename ... Args>
+    T* add(ParserRuleContext *parent, Args&& ... args) {
+      T *child = tracker.createInstance<T>(args...);
+      parent->addChild(child);
+      return child;
+    }
+
+    IntContext* addInt(ParserRuleContext *parent, Token *token) {
+      IntContext *ctx = add<IntContext>(parent, tracker.createInstance<ExprContext>(parent, 1));
+      add<tree::TerminalNodeImpl>(ctx, token);
+      return ctx;
+    }
+
+    // untagged(add(1 + add(2 + untagged(40 ?))))
+    ParserRuleContext* buildTree() {
+      ParserRuleContext *root = tracker.createInstance<InterpreterRuleContext>(nullptr, 0, 0);
+      AddContext *outer = add<AddContext>(root, tracker.createInstance<ExprContext>(root, 1));
+      addInt(outer, &one);
+      add<tree::TerminalNodeImpl>(outer, &plus);
+      AddContext *inner = add<AddContext>(outer, tracker.createInstance<ExprContext>(outer, 2));
+      addInt(inner, &two);
+      add<tree::TerminalNodeImpl>(inner, &plus);
+      ParserRuleContext *untagged = add<InterpreterRuleContext>(inner, inner, 3, 1);
+      addInt(untagged, &forty);
+      add<tree::ErrorNodeImpl>(untagged, &bad);
+      return root;
+    }
+  };
+
+  TEST_F(TypedParseTreeVisitorTest, DispatchesOnTheContextType) {
+    ParserRuleContext *root = buildTree();
+    Evaluator evaluator;
+
+    // Untagged contexts return the result of their last child, here the error node.
+    EXPECT_EQ(evaluator.visit(root), 3);
+
+    ParserRuleContext *inner = static_cast<ParserRuleContext *>(root->children[0]->children[2]);
+    ParserRuleContext *untagged = static_cast<ParserRuleContext *>(inner->children[2]);
+    EXPECT_EQ(evaluator.visit(untagged->children[0]), 40);
+    untagged->removeLastChild();
+    EXPECT_EQ(evaluator.visit(root), 43);
+  }
+
+  TEST_F(TypedParseTreeVisitorTest, AggregatesTheResultsOfTheChildren) {
+    ParserRuleContext *root = buildTree();
+    Concatenator concatenator;
+    EXPECT_EQ(concatenator.visit(root), "(1+(2+40<?>))");
+
+    concatenator.limit = 2;
+    EXPECT_EQ(concatenator.visit(root), "(1+)");
+  }
+
+  TEST_F(TypedParseTreeVisitorTest, MovesTheResults) {
+    ParserRuleContext *root = buildTree();
+    Counter counter;
+    std::unique_ptr<size_t> count = counter.visit(root);
+    ASSERT_NE(count, nullptr);
+    EXPECT_EQ(*count, 7u);
+  }
+
+}
+}
@@ -162,6 +162,21 @@ public class TestSymbolIssues {
 		testErrors(test, false);
 	}
 
+	@Test public void testLexerDFATableUnsupportedRules() throws Exception {
+		String[] test = {
+			"lexer grammar L;\n" +
+			"options { language=Cpp; lexerDFATable=true; }\n" +
+			"A : [a-z]+ {count++;} '!';\n" +
+			"B : [0-9]+ {count++;};\n" +
+			"C : {ok()}? 'c';",
+
+			"error(" + ErrorType.LEXER_DFA_TABLE_UNSUPPORTED.code + "): L.g4:3:0: lexerDFATable cannot be used with rule A: it runs an action inside or after a loop\n" +
+			"error(" + ErrorType.LEXER_DFA_TABLE_UNSUPPORTED.code + "): L.g4:5:0: lexerDFATable cannot be used with rule C: it contains a semantic predicate\n"
+		};
+
+		testErrors(test, false);
+	}
+
 	@Test public void testTokensModesChannelsDeclarationConflictsWithReserved() throws Exception {
 		String[] test = {
 			"lexer grammar L;\n" +
@@ -54,6 +54,12 @@ public class AnalysisPipeline {
 				g.tool.errMgr.grammarError(ErrorType.EPSILON_TOKEN, g.fileName, ((GrammarAST)rule.ast.getChild(0)).getToken(), rule.name);
 			}
 		}
+
+		// the C++ target would otherwise fail to build the lexer DFA table at run time
+		if ("Cpp".equals(g.getLanguage()) &&
+			("true".equals(g.getOptionString("lexerDFATable")) || g.getOptionString("lexerDFATableData") != null)) {
+			new LexerDFATableChecker(g).check();
+		}
 	}
 
 	protected void processParser() {
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+package org.antlr.v4.analysis;
+
+import org.antlr.v4.runtime.atn.ATNState;
+import org.antlr.v4.runtime.atn.ActionTransition;
+import org.antlr.v4.runtime.atn.LexerAction;
+import org.antlr.v4.runtime.atn.PrecedencePredicateTransition;
+import org.antlr.v4.runtime.atn.PredicateTransition;
+import org.antlr.v4.runtime.atn.RuleStopState;
+import org.antlr.v4.runtime.atn.RuleTransition;
+import org.antlr.v4.runtime.atn.Transition;
+import org.antlr.v4.tool.ErrorType;
+import org.antlr.v4.tool.Grammar;
+import org.antlr.v4.tool.Rule;
+import org.antlr.v4.tool.ast.GrammarAST;
+
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Deque;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+/** Reports the lexer rules which the lexerDFATable option of the C++ target cannot
+ *  tabulate, the same ones LexerDFATable::build rejects at run time. Predicates are
+ *  evaluated while matching. A custom action inside or after a loop, with characters
+ *  matched behind it, runs at an unbounded offset into the token, and the table would
+ *  need a state for every offset.
+ */
+public class LexerDFATableChecker {
+	/** A transition of a rule, with rule invocations leading to their follow state. */
+	protected static class Edge {
+		public final ATNState target;
+		public final boolean consuming;
+		public final boolean unbounded;
+		public final Transition transition;
+
+		public Edge(ATNState target, boolean consuming, boolean unbounded, Transition transition) {
+			this.target = target;
+			this.consuming = consuming;
+			this.unbounded = unbounded;
+			this.transition = transition;
+		}
+	}
+
+	public final Grammar g;
+
+	/** Whether a rule can match characters, and whether it can match any number of them. */
+	protected final Map<Integer, Boolean> consuming = new HashMap<Integer, Boolean>();
+	protected final Map<Integer, Boolean> unbounded = new HashMap<Integer, Boolean>();
+
+	public LexerDFATableChecker(Grammar g) {
+		this.g = g;
+	}
+
+	public void check() {
+		for (Rule rule : g.rules.values()) {
+			Map<ATNState, List<Edge>> edges = getEdges(rule.index);
+			if (hasPredicate(edges)) {
+				report(rule, "it contains a semantic predicate");
+			}
+			else if (!rule.isFragment() && hasActionAfterLoop(edges)) {
+				report(rule, "it runs an action inside or after a loop");
+			}
+		}
+	}
+
+	protected void report(Rule rule, String reason) {
+		g.tool.errMgr.grammarError(ErrorType.LEXER_DFA_TABLE_UNSUPPORTED, g.fileName,
+			((GrammarAST)rule.ast.getChild(0)).getToken(), rule.name, reason);
+	}
+
+	protected boolean hasPredicate(Map<ATNState, List<Edge>> edges) {
+		for (List<Edge> out : edges.values()) {
+			for (Edge e : out) {
+				if (e.transition instanceof PredicateTransition || e.transition instanceof PrecedencePredicateTransition) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	/** Actions in invoked rules are never run, so only the actions of the rule itself count. */
+	protected boolean hasActionAfterLoop(Map<ATNState, List<Edge>> edges) {
+		Set<ATNState> loops = new HashSet<ATNState>();
+		for (Map.Entry<ATNState, List<Edge>> entry : edges.entrySet()) {
+			for (Edge e : entry.getValue()) {
+				if (e.unbounded || (e.consuming && reachable(edges, e.target).contains(entry.getKey()))) {
+					loops.add(e.target);
+				}
+			}
+		}
+		Set<ATNState> afterLoop = reachable(edges, loops.toArray(new ATNState[0]));
+
+		for (ATNState s : afterLoop) {
+			List<Edge> out = edges.get(s);
+			if (out == null) continue;
+			for (Edge e : out) {
+				if (isPositionDependent(e.transition) && matchesMore(edges, e.target)) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	protected boolean isPositionDependent(Transition t) {
+		if (!(t instanceof ActionTransition)) {
+			return false;
+		}
+		int actionIndex = ((ActionTransition)t).actionIndex;
+		LexerAction[] actions = g.atn.lexerActions;
+		return actions != null && actionIndex >= 0 && actionIndex < actions.length &&
+			actions[actionIndex].isPositionDependent();
+	}
+
+	protected boolean matchesMore(Map<ATNState, List<Edge>> edges, ATNState from) {
+		for (ATNState s : reachable(edges, from)) {
+			List<Edge> out = edges.get(s);
+			if (out == null) continue;
+			for (Edge e : out) {
+				if (e.consuming) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	protected Set<ATNState> reachable(Map<ATNState, List<Edge>> edges, ATNState... from) {
+		Set<ATNState> visited = new HashSet<ATNState>();
+		Deque<ATNState> pending = new ArrayDeque<ATNState>();
+		for (ATNState s : from) {
+			if (visited.add(s)) pending.push(s);
+		}
+		while (!pending.isEmpty()) {
+			List<Edge> out = edges.get(pending.pop());
+			if (out == null) continue;
+			for (Edge e : out) {
+				if (visited.add(e.target)) pending.push(e.target);
+			}
+		}
+		return visited;
+	}
+
+	/** The transitions between the states of a rule. The rule stop state has none. */
+	protected Map<ATNState, List<Edge>> getEdges(int ruleIndex) {
+		Map<ATNState, List<Edge>> edges = new HashMap<ATNState, List<Edge>>();
+		for (ATNState s : g.atn.states) {
+			if (s == null || s.ruleIndex != ruleIndex) continue;
+			List<Edge> out = new ArrayList<Edge>();
+			edges.put(s, out);
+			if (s instanceof RuleStopState) continue;
+			for (Transition t : s.getTransitions()) {
+				if (t instanceof RuleTransition) {
+					RuleTransition call = (RuleTransition)t;
+					int callee = call.target.ruleIndex;
+					out.add(new Edge(call.followState, isConsuming(callee), isUnbounded(callee), t));
+				}
+				else {
+					out.add(new Edge(t.target, !t.isEpsilon(), false, t));
+				}
+			}
+		}
+		return edges;
+	}
+
+	protected boolean isConsuming(int ruleIndex) {
+		Boolean result = consuming.get(ruleIndex);
+		if (result == null) {
+			computeRuleProperties(ruleIndex);
+			result = consuming.get(ruleIndex);
+		}
+		return result;
+	}
+
+	protected boolean isUnbounded(int ruleIndex) {
+		Boolean result = unbounded.get(ruleIndex);
+		if (result == null) {
+			computeRuleProperties(ruleIndex);
+			result = unbounded.get(ruleIndex);
+		}
+		return result;
+	}
+
+	protected void computeRuleProperties(int ruleIndex) {
+		// A recursive invocation can match any number of characters.
+		consuming.put(ruleIndex, true);
+		unbounded.put(ruleIndex, true);
+
+		Map<ATNState, List<Edge>> edges = getEdges(ruleIndex);
+		boolean consumes = false;
+		boolean loops = false;
+		for (Map.Entry<ATNState, List<Edge>> entry : edges.entrySet()) {
+			for (Edge e : entry.getValue()) {
+				consumes |= e.consuming;
+				loops |= e.unbounded || (e.consuming && reachable(edges, e.target).contains(entry.getKey()));
+			}
+		}
+		consuming.put(ruleIndex, consumes);
+		unbounded.put(ruleIndex, loops);
+	}
+}
@@ -8,9 +8,12 @@ package org.antlr.v4.codegen.model;
 
 import org.antlr.v4.codegen.OutputModelFactory;
 import org.antlr.v4.codegen.Target;
+import org.antlr.v4.runtime.Token;
+import org.antlr.v4.tool.ErrorType;
 import org.antlr.v4.tool.Grammar;
 import org.antlr.v4.tool.LexerGrammar;
 import org.antlr.v4.tool.Rule;
+import org.antlr.v4.tool.ast.GrammarAST;
 
 import java.util.*;
 
@@ -20,6 +23,13 @@ public class Lexer extends Recognizer {
 	public final LexerFile file;
 	public final Collection<String> modes;
 	public final Collection<String> escapedModeNames;
+	/** From the keywordIdentifier option: the token type to look up in the keyword table. */
+	public final String keywordIdentifier;
+	/** From the keywords option: the token types matched through the keyword table. */
+	public final Collection<String> keywordTokens;
+	public final boolean keywordsCaseInsensitive;
+	/** The code points of the restartCharacters option, where parallel lexing may start a chunk. */
+	public final Collection<Integer> restartCharacters;
 
 	@ModelElement public LinkedHashMap<Rule, RuleActionFunction> actionFuncs =
 		new LinkedHashMap<Rule, RuleActionFunction>();
@@ -44,5 +54,36 @@ public class Lexer extends Recognizer {
 		for (String mode : modes) {
 			escapedModeNames.add(target.escapeIfNeeded(mode));
 		}
+
+		// The tokens section of a combined grammar stays with the parser.
+		Grammar owner = g;
+		if (((LexerGrammar)g).implicitLexerOwner != null) {
+			owner = ((LexerGrammar)g).implicitLexerOwner;
+		}
+		String identifier = owner.getOptionString("keywordIdentifier");
+		keywordIdentifier = identifier != null ? target.escapeIfNeeded(identifier) : null;
+		// The keywords are listed explicitly, since the tokens section also declares imaginary
+		// tokens such as INDENT, which must not be matched by their names.
+		keywordTokens = new ArrayList<>();
+		String keywords = owner.getOptionString("keywords");
+		if (keywordIdentifier != null && keywords != null) {
+			for (String name : keywords.trim().split("[\\s,]+")) {
+				if (name.isEmpty()) continue;
+				if (owner.getTokenType(name) == Token.INVALID_TYPE) {
+					GrammarAST option = owner.ast.getOptionAST("keywords");
+					owner.tool.errMgr.grammarError(ErrorType.CONSTANT_VALUE_IS_NOT_A_RECOGNIZED_TOKEN_NAME, owner.fileName,
+						option != null ? option.getToken() : null, name);
+					continue;
+				}
+				keywordTokens.add(target.escapeIfNeeded(name));
+			}
+		}
+		keywordsCaseInsensitive = "true".equals(owner.getOptionString(Grammar.caseInsensitiveOptionName));
+
+		restartCharacters = new ArrayList<>();
+		String restart = owner.getOptionString("restartCharacters");
+		if (restart != null) {
+			restart.codePoints().forEach(restartCharacters::add);
+		}
 	}
 }
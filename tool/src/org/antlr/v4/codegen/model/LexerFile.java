@@ -13,6 +13,8 @@ import java.util.Map;
 public class LexerFile extends OutputFile {
 	public String genPackage; // from -package cmd-line
 	public String exportMacro; // from -DexportMacro cmd-line
+	public boolean genLexerDFATable; // from -DlexerDFATable cmd-line
+	public String lexerDFATableData; // from -DlexerDFATableData cmd-line
 	public boolean genListener; // from -listener cmd-line
 	public boolean genVisitor; // from -visitor cmd-line
 	@ModelElement public Lexer lexer;
@@ -23,6 +25,8 @@ public class LexerFile extends OutputFile {
 		namedActions = buildNamedActions(factory.getGrammar());
 		genPackage = factory.getGrammar().tool.genPackage;
 		exportMacro = factory.getGrammar().getOptionString("exportMacro");
+		lexerDFATableData = factory.getGrammar().getOptionString("lexerDFATableData");
+		genLexerDFATable = "true".equals(factory.getGrammar().getOptionString("lexerDFATable")) || lexerDFATableData != null;
 		genListener = factory.getGrammar().tool.gen_listener;
 		genVisitor = factory.getGrammar().tool.gen_visitor;
 	}
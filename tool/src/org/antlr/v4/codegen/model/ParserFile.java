@@ -19,6 +19,7 @@ public class ParserFile extends OutputFile {
 	public String exportMacro; // from -DexportMacro cmd-line
 	public boolean genListener; // from -listener cmd-line
 	public boolean genVisitor; // from -visitor cmd-line
+	public String visitorResult; // from -DvisitorResult cmd-line
 	@ModelElement public Parser parser;
 	@ModelElement public Map<String, Action> namedActions;
 	@ModelElement public ActionChunk contextSuperClass;
@@ -33,6 +34,7 @@ public class ParserFile extends OutputFile {
 		// need the below members in the ST for Python, C++
 		genListener = g.tool.gen_listener;
 		genVisitor = g.tool.gen_visitor;
+		visitorResult = g.getOptionString("visitorResult");
 		grammarName = g.name;
 
 		if (g.getOptionString("contextSuperClass") != null) {
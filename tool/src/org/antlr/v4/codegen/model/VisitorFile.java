@@ -18,6 +18,7 @@ public class VisitorFile extends OutputFile {
 	public String genPackage; // from -package cmd-line
 	public String accessLevel; // from -DaccessLevel cmd-line
 	public String exportMacro; // from -DexportMacro cmd-line
+	public String visitorResult; // from -DvisitorResult cmd-line
 	public String grammarName;
 	public String parserName;
 	/**
@@ -59,5 +60,6 @@ public class VisitorFile extends OutputFile {
 		genPackage = g.tool.genPackage;
 		accessLevel = g.getOptionString("accessLevel");
 		exportMacro = g.getOptionString("exportMacro");
+		visitorResult = g.getOptionString("visitorResult");
 	}
 }
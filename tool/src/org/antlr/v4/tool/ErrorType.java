@@ -1137,6 +1137,24 @@ public enum ErrorType {
 			ErrorSeverity.WARNING
 	),
 
+	/**
+	 * Compiler Error 188.
+	 *
+	 * <p>The C++ target's lexerDFATable option cannot be used with a lexer rule
+	 * containing a semantic predicate, or a custom action inside or after a loop
+	 * with characters matched behind it.</p>
+	 *
+	 * <pre>
+	 * options { lexerDFATable=true; }
+	 * ID : [a-z]+ {count++;} '!' ; // error
+	 * </pre>
+	 */
+	LEXER_DFA_TABLE_UNSUPPORTED(
+			188,
+			"lexerDFATable cannot be used with rule <arg>: <arg2>",
+			ErrorSeverity.ERROR
+	),
+
 	/*
 	 * Backward incompatibility errors
 	 */
@@ -82,6 +82,12 @@ public class Grammar implements AttributeResolver {
 		parserOptions.add("language");
 		parserOptions.add("accessLevel");
 		parserOptions.add("exportMacro");
+		parserOptions.add("lexerDFATable");
+		parserOptions.add("lexerDFATableData");
+		parserOptions.add("keywordIdentifier");
+		parserOptions.add("keywords");
+		parserOptions.add("visitorResult");
+		parserOptions.add("restartCharacters");
 		parserOptions.add(caseInsensitiveOptionName);
 	}
 